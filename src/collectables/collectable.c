@@ -56,7 +56,8 @@ void collectable_init(struct collectable* collectable, struct collectable_defini
 
     collision_scene_add(&collectable->physics);
     renderable_single_axis_init(&collectable->renderable, &collectable->transform, type->mesh_filename);
-    render_scene_add_renderable_single_axis(&collectable->renderable, 1.0f);
+    renderable_single_axis_set_physics(&collectable->renderable, &collectable->physics);
+    render_scene_add_renderable_single_axis(&collectable->renderable);
     
     hash_map_set(&collectable_hash_map, collectable->physics.entity_id, collectable);
 }
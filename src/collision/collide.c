@@ -5,6 +5,7 @@
 #include "../util/flags.h"
 #include "../math/matrix.h"
 #include "../math/mathf.h"
+#include "shapes/compound.h"
 #include "../time/time.h"
 #include <stdio.h>
 #include <math.h>
@@ -195,30 +196,40 @@ void collide_correct_velocity(physics_object* b, const struct EpaResult* result,
 }
 
 
-void collide_add_contact(physics_object* object, contact_constraint* constraint, physics_object* other_object) {
-    contact* contact = collision_scene_allocate_contact();
+// ============================================================================
+// NEW: DETECTION-ONLY FUNCTIONS FOR ITERATIVE CONSTRAINT SOLVER
+// ============================================================================
 
-    if (!contact) {
-        return;
-    }
+void collide_contact_point_world(const contact_constraint* constraint, const contact_point* point, Vector3* contact_a, Vector3* contact_b) {
+    physics_object* a = constraint->objectA;
+    physics_object* b = constraint->objectB;
 
-    contact->constraint = constraint;
-    contact->other_object = other_object;
+    if (a) {
+        Vector3 rA = point->localPointA;
+        if (a->rotation) quatMultVector(a->rotation, &rA, &rA);
+        vector3Add(a->position, &rA, contact_a);
+    } else if (constraint->instance) {
+        mesh_instance_anchor_to_world(constraint->instance, &point->localPointA, contact_a);
+    } else {
+        *contact_a = point->localPointA;
+    }
 
-    contact->next = object->active_contacts;
-    object->active_contacts = contact;
+    if (b) {
+        Vector3 rB = point->localPointB;
+        if (b->rotation) quatMultVector(b->rotation, &rB, &rB);
+        vector3Add(b->position, &rB, contact_b);
+    } else {
+        *contact_b = point->localPointB;
+    }
 }
 
-
-// ============================================================================
-// NEW: DETECTION-ONLY FUNCTIONS FOR ITERATIVE CONSTRAINT SOLVER
-// ============================================================================
-
-contact_constraint* collide_cache_contact_constraint(physics_object* a, physics_object* b, const struct EpaResult* result,
-                               float combined_friction, float combined_bounce, bool is_trigger) {
+contact_constraint* collide_cache_contact_constraint(physics_object* a, physics_object* b, const struct mesh_instance* instance,
+                               const struct EpaResult* result, float combined_friction, float combined_bounce) {
     struct collision_scene* scene = collision_scene_get_instance();
 
-    contact_pair_id pid = contact_pair_id_get(a ? a->entity_id : (entity_id)0, b ? b->entity_id : (entity_id)0);
+    // every mesh instance pairs with its own id, the static mesh and the heightfield share id 0
+    entity_id a_id = a ? a->entity_id : (instance ? instance->entity_id : (entity_id)0);
+    contact_pair_id pid = contact_pair_id_get(a_id, b ? b->entity_id : (entity_id)0);
 
     // Find existing constraint for this entity pair with similar normal
     contact_constraint* cont_constraint = NULL;
@@ -255,6 +266,7 @@ contact_constraint* collide_cache_contact_constraint(physics_object* a, physics_
         scene->cached_contact_constraint_count++;
         cont_constraint->pid = pid;
         cont_constraint->point_count = 0;
+        cont_constraint->is_reported = false;
 
         // Add to map/list
         cont_constraint->next_same_pid_index = -1;
@@ -268,10 +280,10 @@ contact_constraint* collide_cache_contact_constraint(physics_object* a, physics_
     // Update shared constraint data
     cont_constraint->objectA = a;
     cont_constraint->objectB = b;
+    cont_constraint->instance = instance;
     cont_constraint->normal = result->normal;
     cont_constraint->combined_friction = combined_friction;
     cont_constraint->combined_bounce = combined_bounce;
-    cont_constraint->is_trigger = is_trigger;
     cont_constraint->is_active = true;
 
     // Calculate local points for the new contact
@@ -287,6 +299,9 @@ contact_constraint* collide_cache_contact_constraint(physics_object* a, physics_
             quatConjugate(a->rotation, &invRotA);
             quatMultVector(&invRotA, &localA, &localA);
         }
+    } else if (instance) {
+        // anchored to the instance, so the contact moves with it between steps
+        mesh_instance_anchor_from_world(instance, &result->contactA, &localA);
     } else {
         localA = result->contactA;
     }
@@ -310,9 +325,10 @@ contact_constraint* collide_cache_contact_constraint(physics_object* a, physics_
     float best_dist_sq = match_distance_sq;
 
 
+    // Compared in local space, the distances are the same as in world space
     for (int i = 0; i < cont_constraint->point_count; i++) {
-        float dist_a = vector3DistSqrd(&cont_constraint->points[i].contactA, &result->contactA);
-        float dist_b = vector3DistSqrd(&cont_constraint->points[i].contactB, &result->contactB);
+        float dist_a = vector3DistSqrd(&cont_constraint->points[i].localPointA, &localA);
+        float dist_b = vector3DistSqrd(&cont_constraint->points[i].localPointB, &localB);
         float min_dist = fminf(dist_a, dist_b);
 
         if (min_dist < best_dist_sq) {
@@ -360,9 +376,6 @@ contact_constraint* collide_cache_contact_constraint(physics_object* a, physics_
     }
 
     // Update contact point data
-    cont_point->point = result->contactA;
-    cont_point->contactA = result->contactA;
-    cont_point->contactB = result->contactB;
     cont_point->localPointA = localA;
     cont_point->localPointB = localB;
     cont_point->penetration = result->penetration;
@@ -379,8 +392,10 @@ validate_others:
         // diff = A - B
         // If overlapping, A is "behind" B relative to normal, so dot(diff, normal) is negative
         // We want penetration to be positive for overlap, so we negate the dot product
+        Vector3 contactA, contactB;
+        collide_contact_point_world(cont_constraint, cp, &contactA, &contactB);
         Vector3 diff;
-        vector3Sub(&cp->contactA, &cp->contactB, &diff);
+        vector3Sub(&contactA, &contactB, &diff);
         float pen = -vector3Dot(&diff, &cont_constraint->normal);
 
         // Keep point if it's still penetrating or very close (allow small separation)
@@ -394,15 +409,40 @@ validate_others:
     return cont_constraint;
 }
 
-bool collide_detect_object_to_triangle(physics_object* object, const struct mesh_collider* mesh, int triangle_index) {
-    struct mesh_triangle triangle;
-    triangle.triangle = mesh->triangles[triangle_index];
-    triangle.normal = mesh->normals[triangle_index];
-    triangle.vertices = mesh->vertices;
+/// @brief Rejects spheres and capsules that are farther from the triangle plane than their extent along the normal
+/// @return true if the object can not touch the triangle
+static bool collide_triangle_plane_reject(const struct mesh_triangle* triangle, const physics_object* object) {
+    float extent;
+
+    switch (object->collision->shape_type) {
+        case COLLISION_SHAPE_SPHERE:
+            extent = object->collision->shape_data.sphere.radius;
+            break;
+        case COLLISION_SHAPE_CAPSULE: {
+            // the capsule axis is the local Y axis
+            float axis_dot = triangle->normal.y;
+            if (object->rotation) {
+                Vector3 axis;
+                quatMultVector(object->rotation, &gUp, &axis);
+                axis_dot = vector3Dot(&axis, &triangle->normal);
+            }
+            extent = object->collision->shape_data.capsule.radius + fabsf(axis_dot) * object->collision->shape_data.capsule.inner_half_height;
+            break;
+        }
+        default:
+            return false;
+    }
+
+    // the GJK support function is centered on the world center of mass as well
+    return fabsf(mesh_triangle_comparePoint(triangle, &object->_world_center_of_mass)) > extent;
+}
 
+/// @brief GJK/EPA between the support function of an object (or one of its compound children) and a precomputed triangle,
+/// caches the contact with the static scene or the mesh instance the triangle belongs to
+static bool collide_detect_support_to_mesh_triangle(physics_object* object, const struct mesh_instance* instance, void* data, gjk_support_function support, struct mesh_triangle* triangle) {
     struct Simplex simplex;
     Vector3 firstDir = gRight;
-    if (!gjkCheckForOverlap(&simplex, &triangle, mesh_triangle_gjk_support_function, object, physics_object_gjk_support_function, &firstDir))
+    if (!gjkCheckForOverlap(&simplex, triangle, mesh_triangle_gjk_support_function, data, support, &firstDir))
     {
         return false;
     }
@@ -410,17 +450,14 @@ bool collide_detect_object_to_triangle(physics_object* object, const struct mesh
     struct EpaResult result;
     if (epaSolve(
             &simplex,
-            &triangle,
+            triangle,
             mesh_triangle_gjk_support_function,
-            object,
-            physics_object_gjk_support_function,
+            data,
+            support,
             &result))
     {
         // Cache the contact (entity_a = 0 for static mesh)
-        contact_constraint* constraint = collide_cache_contact_constraint(NULL, object, &result, object->collision->friction, object->collision->bounce, false);
-
-        // Still add to old contact list for ground detection logic
-        collide_add_contact(object, constraint, NULL);
+        collide_cache_contact_constraint(NULL, object, instance, &result, object->collision->friction, object->collision->bounce);
 
         return true;
     }
@@ -428,16 +465,271 @@ bool collide_detect_object_to_triangle(physics_object* object, const struct mesh
     return false;
 }
 
+/// @brief Runs the triangle narrowphase against the compound children whose bounds overlap the triangle
+static bool collide_detect_compound_to_mesh_triangle(physics_object* object, const struct mesh_instance* instance, struct mesh_triangle* triangle) {
+    Vector3 corner;
+    AABB triangle_box = {triangle->v0, triangle->v0};
+    vector3Add(&triangle->v0, &triangle->edge1, &corner);
+    triangle_box = AABBUnionPoint(&triangle_box, &corner);
+    vector3Add(&triangle->v0, &triangle->edge2, &corner);
+    triangle_box = AABBUnionPoint(&triangle_box, &corner);
+
+    AABB local_box;
+    compound_box_to_local(object, &triangle_box, &local_box);
+    uint8_t children[COMPOUND_MAX_CHILDREN];
+    int child_count = compound_collider_query_bounds(object->collision->shape_data.compound.collider, &local_box, children, COMPOUND_MAX_CHILDREN);
+
+    bool did_hit = false;
+    for (int i = 0; i < child_count; i++) {
+        struct compound_child_proxy proxy;
+        compound_child_proxy_init(&proxy, object, children[i]);
+        if (fabsf(mesh_triangle_comparePoint(triangle, &proxy.center)) > proxy.radius) {
+            continue;
+        }
+
+        did_hit |= collide_detect_support_to_mesh_triangle(object, instance, &proxy, compound_child_support_function, triangle);
+    }
+
+    return did_hit;
+}
+
+/// @brief GJK/EPA between an object and a precomputed triangle, caches the contact with the static scene or a mesh instance
+/// @param instance the mesh instance the triangle was placed from, NULL for the static mesh
+static bool collide_detect_object_to_mesh_triangle(physics_object* object, const struct mesh_instance* instance, struct mesh_triangle* triangle) {
+    if (object->collision->shape_type == COLLISION_SHAPE_COMPOUND) {
+        return collide_detect_compound_to_mesh_triangle(object, instance, triangle);
+    }
+
+    if (collide_triangle_plane_reject(triangle, object)) {
+        return false;
+    }
+
+    return collide_detect_support_to_mesh_triangle(object, instance, object, physics_object_gjk_support_function, triangle);
+}
+
+bool collide_detect_object_to_triangle(physics_object* object, const struct mesh_collider* mesh, int triangle_index) {
+    return collide_detect_object_to_mesh_triangle(object, NULL, mesh_collider_get_triangle(mesh, triangle_index));
+}
+
 void collide_detect_object_to_mesh(physics_object* object, const struct mesh_collider* mesh) {
     int result_count = 0;
     int max_results = 64; // Increased from 20 to handle complex geometry with multiple simultaneous contacts
-    node_proxy results[max_results];
+    uint16_t results[max_results];
 
-    AABB_tree_query_bounds(&mesh->aabbtree, &object->bounding_box, results, &result_count, max_results);
+    mesh_bvh_query_bounds(&mesh->bvh, &object->bounding_box, results, &result_count, max_results);
     for (size_t j = 0; j < result_count; j++)
     {
-        int triangle_index = (int)AABB_tree_get_node_data(&mesh->aabbtree, results[j]);
-        collide_detect_object_to_triangle(object, mesh, triangle_index);
+        collide_detect_object_to_triangle(object, mesh, results[j]);
+    }
+}
+
+void collide_detect_object_to_mesh_instance(physics_object* object, const struct mesh_instance* instance) {
+    int result_count = 0;
+    int max_results = 64;
+    uint16_t results[max_results];
+
+    // query the shared BVH in mesh space, the candidates are moved to world space for the narrowphase
+    AABB local_box;
+    mesh_instance_box_to_local(instance, &object->bounding_box, &local_box);
+    mesh_bvh_query_bounds(&instance->mesh->bvh, &local_box, results, &result_count, max_results);
+    for (size_t j = 0; j < result_count; j++)
+    {
+        struct mesh_triangle triangle;
+        mesh_instance_get_triangle(instance, results[j], &triangle);
+        collide_detect_object_to_mesh_triangle(object, instance, &triangle);
+    }
+}
+
+// ============================================================================
+// HEIGHTFIELD
+// ============================================================================
+
+/// @brief Closest point on a triangle to a point, by Voronoi region of the triangle features
+static void collide_closest_point_on_triangle(const Vector3* point, const Vector3* a, const Vector3* b, const Vector3* c, Vector3* out) {
+    Vector3 ab, ac, ap;
+    vector3Sub(b, a, &ab);
+    vector3Sub(c, a, &ac);
+    vector3Sub(point, a, &ap);
+    float d1 = vector3Dot(&ab, &ap);
+    float d2 = vector3Dot(&ac, &ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+        *out = *a;
+        return;
+    }
+
+    Vector3 bp;
+    vector3Sub(point, b, &bp);
+    float d3 = vector3Dot(&ab, &bp);
+    float d4 = vector3Dot(&ac, &bp);
+    if (d3 >= 0.0f && d4 <= d3) {
+        *out = *b;
+        return;
+    }
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        vector3AddScaled(a, &ab, d1 / (d1 - d3), out);
+        return;
+    }
+
+    Vector3 cp;
+    vector3Sub(point, c, &cp);
+    float d5 = vector3Dot(&ab, &cp);
+    float d6 = vector3Dot(&ac, &cp);
+    if (d6 >= 0.0f && d5 <= d6) {
+        *out = *c;
+        return;
+    }
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        vector3AddScaled(a, &ac, d2 / (d2 - d6), out);
+        return;
+    }
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        Vector3 bc;
+        vector3Sub(c, b, &bc);
+        vector3AddScaled(b, &bc, (d4 - d3) / ((d4 - d3) + (d5 - d6)), out);
+        return;
+    }
+
+    float denominator = 1.0f / (va + vb + vc);
+    vector3AddScaled(a, &ab, vb * denominator, out);
+    vector3AddScaled(out, &ac, vc * denominator, out);
+}
+
+/// @brief Analytic contact between a sphere and a heightfield triangle.
+///
+/// The terrain is solid below its surface, so a center below the face is still pushed out along the face normal.
+/// Below the plane but outside the face the neighboring triangle is responsible, so only one of them reports the contact.
+static bool collide_heightfield_sphere_triangle(const Vector3* center, float radius, const Vector3 corners[3], struct EpaResult* result) {
+    Vector3 edge1, edge2, normal;
+    vector3Sub(&corners[1], &corners[0], &edge1);
+    vector3Sub(&corners[2], &corners[0], &edge2);
+    vector3Cross(&edge1, &edge2, &normal);
+    if (vector3MagSqrd(&normal) < EPSILON * EPSILON) {
+        return false;
+    }
+    vector3NormalizeSelf(&normal);
+
+    Vector3 to_center;
+    vector3Sub(center, &corners[0], &to_center);
+    float distance = vector3Dot(&normal, &to_center);
+    if (distance > radius) {
+        return false;
+    }
+
+    Vector3 closest, offset;
+    collide_closest_point_on_triangle(center, &corners[0], &corners[1], &corners[2], &closest);
+    vector3Sub(center, &closest, &offset);
+    float offset_sq = vector3MagSqrd(&offset);
+
+    // the EPA convention is used, A is the terrain and the normal points from the sphere toward it
+    if (offset_sq - distance * distance < EPSILON) {
+        // the center is directly above or below the face
+        vector3Negate(&normal, &result->normal);
+        result->penetration = radius - distance;
+        result->contactA = closest;
+    } else {
+        // the closest feature is an edge or a corner
+        if (distance < 0.0f || offset_sq >= radius * radius) {
+            return false;
+        }
+
+        float offset_length = sqrtf(offset_sq);
+        vector3Scale(&offset, &result->normal, -1.0f / offset_length);
+        result->penetration = radius - offset_length;
+        result->contactA = closest;
+    }
+
+    vector3AddScaled(center, &result->normal, radius, &result->contactB);
+    return true;
+}
+
+/// @brief Point on a segment closest to a triangle, found by alternating projection from the segment center
+static void collide_closest_segment_point_to_triangle(const Vector3* start, const Vector3* end, const Vector3 corners[3], Vector3* out) {
+    Vector3 segment;
+    vector3Sub(end, start, &segment);
+    float length_sq = vector3MagSqrd(&segment);
+
+    vector3Lerp(start, end, 0.5f, out);
+    if (length_sq < EPSILON) {
+        return;
+    }
+
+    // the segment and the triangle are convex, so two rounds are enough for the contact point
+    for (int i = 0; i < 2; i++) {
+        Vector3 on_triangle, to_triangle;
+        collide_closest_point_on_triangle(out, &corners[0], &corners[1], &corners[2], &on_triangle);
+        vector3Sub(&on_triangle, start, &to_triangle);
+        float t = clampf(vector3Dot(&to_triangle, &segment) / length_sq, 0.0f, 1.0f);
+        vector3AddScaled(start, &segment, t, out);
+    }
+}
+
+/// @brief Detects the contacts of an object with one heightfield triangle, analytic for spheres and capsules
+static void collide_detect_object_to_heightfield_triangle(physics_object* object, const Vector3 corners[3]) {
+    struct EpaResult result;
+
+    switch (object->collision->shape_type) {
+        case COLLISION_SHAPE_SPHERE:
+            if (collide_heightfield_sphere_triangle(&object->_world_center_of_mass, object->collision->shape_data.sphere.radius, corners, &result)) {
+                collide_cache_contact_constraint(NULL, object, NULL, &result, object->collision->friction, object->collision->bounce);
+            }
+            break;
+        case COLLISION_SHAPE_CAPSULE: {
+            // the capsule axis is the local Y axis, test the end spheres and the sphere closest to the triangle
+            Vector3 axis = gUp;
+            if (object->rotation) {
+                quatMultVector(object->rotation, &gUp, &axis);
+            }
+
+            Vector3 points[3];
+            float radius = object->collision->shape_data.capsule.radius;
+            vector3AddScaled(&object->_world_center_of_mass, &axis, object->collision->shape_data.capsule.inner_half_height, &points[0]);
+            vector3AddScaled(&object->_world_center_of_mass, &axis, -object->collision->shape_data.capsule.inner_half_height, &points[1]);
+            collide_closest_segment_point_to_triangle(&points[0], &points[1], corners, &points[2]);
+
+            for (int i = 0; i < 3; i++) {
+                if (collide_heightfield_sphere_triangle(&points[i], radius, corners, &result)) {
+                    collide_cache_contact_constraint(NULL, object, NULL, &result, object->collision->friction, object->collision->bounce);
+                }
+            }
+            break;
+        }
+        default: {
+            struct mesh_triangle triangle;
+            mesh_triangle_init(&triangle, &corners[0], &corners[1], &corners[2], &gUp);
+            collide_detect_object_to_mesh_triangle(object, NULL, &triangle);
+            break;
+        }
+    }
+}
+
+void collide_detect_object_to_heightfield(physics_object* object, const struct heightfield* heightfield) {
+    int min_x, min_z, max_x, max_z;
+    if (!heightfield_get_cell_range(heightfield, &object->bounding_box, &min_x, &min_z, &max_x, &max_z)) {
+        return;
+    }
+
+    for (int z = min_z; z <= max_z; z++) {
+        for (int x = min_x; x <= max_x; x++) {
+            // objects entirely above the cell can't touch it
+            float min_height, max_height;
+            heightfield_get_cell_height_range(heightfield, x, z, &min_height, &max_height);
+            if (object->bounding_box.min.y > max_height) {
+                continue;
+            }
+
+            for (int i = 0; i < HEIGHTFIELD_TRIANGLES_PER_CELL; i++) {
+                Vector3 corners[3];
+                if (heightfield_get_triangle(heightfield, x, z, i, corners)) {
+                    collide_detect_object_to_heightfield_triangle(object, corners);
+                }
+            }
+        }
     }
 }
 
@@ -690,6 +982,125 @@ static bool detect_sphere_capsule(physics_object* sphere, physics_object* capsul
     return true;
 }
 
+/// @brief Wakes the objects of a detected contact if the impact is energetic enough and caches the contact constraint
+static void collide_cache_object_pair(physics_object* a, physics_object* b, const struct EpaResult* result) {
+    // Wake up sleeping objects only if the collision is energetic enough
+    // This allows stacked objects to sleep
+    Vector3 velA = gZeroVec;
+    Vector3 velB = gZeroVec;
+
+    if (a && !a->is_kinematic) {
+        velA = a->velocity;
+        if (a->rotation) {
+            Vector3 centerOfMassA;
+            Vector3 rotatedOffset;
+            matrix3Vec3Mul(&a->_rotation_matrix, &a->center_offset, &rotatedOffset);
+            vector3Add(a->position, &rotatedOffset, &centerOfMassA);
+            
+            Vector3 rA;
+            vector3Sub(&result->contactA, &centerOfMassA, &rA);
+            Vector3 angularPart;
+            vector3Cross(&a->angular_velocity, &rA, &angularPart);
+            vector3Add(&velA, &angularPart, &velA);
+        }
+    }
+
+    if (b && !b->is_kinematic) {
+        velB = b->velocity;
+        if (b->rotation) {
+            Vector3 centerOfMassB;
+            Vector3 rotatedOffset;
+            matrix3Vec3Mul(&b->_rotation_matrix, &b->center_offset, &rotatedOffset);
+            vector3Add(b->position, &rotatedOffset, &centerOfMassB);
+            
+            Vector3 rB;
+            vector3Sub(&result->contactB, &centerOfMassB, &rB);
+            Vector3 angularPart;
+            vector3Cross(&b->angular_velocity, &rB, &angularPart);
+            vector3Add(&velB, &angularPart, &velB);
+        }
+    }
+
+    Vector3 relVel;
+    vector3Sub(&velA, &velB, &relVel);
+    float impactSpeedSq = vector3MagSqrd(&relVel);
+    
+    // Use a threshold slightly higher than the sleep threshold to ensure stability.
+    // If objects are moving slower than the sleep threshold, they shouldn't wake each other up.
+    const float wake_threshold_sq = PHYS_OBJECT_SPEED_SLEEP_THRESHOLD_SQ * 1.2f;
+
+    if (impactSpeedSq > wake_threshold_sq) {
+        if (a && !a->is_kinematic) physics_object_wake(a);
+        if (b && !b->is_kinematic) physics_object_wake(b);
+    } 
+    // The solver will transfer momentum if necessary, and if the resulting velocity
+    // is high enough, the object will wake up in the next update cycle.
+
+    // Combined friction and bounce
+    float combined_friction = minf(a->collision->friction, b->collision->friction);
+    float combined_bounce = a->collision->bounce * b->collision->bounce;//minf(a->collision->bounce, b->collision->bounce);
+
+    // Cache the contact constraint
+    collide_cache_contact_constraint(a, b, NULL, result, combined_friction, combined_bounce);
+}
+
+/// @brief GJK/EPA between two support functions of a pair of objects, which can be the objects or their compound children
+static void collide_detect_support_pair(physics_object* a, void* a_data, gjk_support_function a_support, physics_object* b, void* b_data, gjk_support_function b_support) {
+    struct Simplex simplex;
+    struct EpaResult result;
+    Vector3 firstDir = gRight;
+    if (!gjkCheckForOverlap(&simplex, a_data, a_support, b_data, b_support, &firstDir)) {
+        return;
+    }
+
+    if (!epaSolve(&simplex, a_data, a_support, b_data, b_support, &result)) {
+        return;
+    }
+
+    collide_cache_object_pair(a, b, &result);
+}
+
+/// @brief Runs the narrowphase between the compound children that overlap the other object, or its children
+static void collide_detect_compound_to_object(physics_object* a, physics_object* b) {
+    bool a_is_compound = a->collision->shape_type == COLLISION_SHAPE_COMPOUND;
+    physics_object* compound = a_is_compound ? a : b;
+    physics_object* other = a_is_compound ? b : a;
+
+    AABB local_box;
+    compound_box_to_local(compound, &other->bounding_box, &local_box);
+    uint8_t children[COMPOUND_MAX_CHILDREN];
+    int child_count = compound_collider_query_bounds(compound->collision->shape_data.compound.collider, &local_box, children, COMPOUND_MAX_CHILDREN);
+
+    for (int i = 0; i < child_count; i++) {
+        struct compound_child_proxy proxy;
+        compound_child_proxy_init(&proxy, compound, children[i]);
+
+        if (other->collision->shape_type != COLLISION_SHAPE_COMPOUND) {
+            if (a_is_compound) {
+                collide_detect_support_pair(a, &proxy, compound_child_support_function, b, b, physics_object_gjk_support_function);
+            } else {
+                collide_detect_support_pair(a, a, physics_object_gjk_support_function, b, &proxy, compound_child_support_function);
+            }
+            continue;
+        }
+
+        // both are compounds, a is the compound iterated here
+        AABB child_box;
+        Vector3 radius = {{proxy.radius, proxy.radius, proxy.radius}};
+        vector3Sub(&proxy.center, &radius, &child_box.min);
+        vector3Add(&proxy.center, &radius, &child_box.max);
+        compound_box_to_local(other, &child_box, &local_box);
+
+        uint8_t other_children[COMPOUND_MAX_CHILDREN];
+        int other_child_count = compound_collider_query_bounds(other->collision->shape_data.compound.collider, &local_box, other_children, COMPOUND_MAX_CHILDREN);
+        for (int j = 0; j < other_child_count; j++) {
+            struct compound_child_proxy other_proxy;
+            compound_child_proxy_init(&other_proxy, other, other_children[j]);
+            collide_detect_support_pair(a, &proxy, compound_child_support_function, b, &other_proxy, compound_child_support_function);
+        }
+    }
+}
+
 void collide_detect_object_to_object(physics_object* a, physics_object* b) {
     // If the Objects don't share any collision layers, don't collide
     if (!(a->collision_layers & b->collision_layers)) {
@@ -701,8 +1112,13 @@ void collide_detect_object_to_object(physics_object* a, physics_object* b) {
         return;
     }
 
-    // triggers can't collide with each other
-    if (a->is_trigger && b->is_trigger) {
+    // triggers are handled by the trigger overlap pass and never create contact constraints
+    if (a->is_trigger || b->is_trigger) {
+        return;
+    }
+
+    if (a->collision->shape_type == COLLISION_SHAPE_COMPOUND || b->collision->shape_type == COLLISION_SHAPE_COMPOUND) {
+        collide_detect_compound_to_object(a, b);
         return;
     }
 
@@ -766,27 +1182,6 @@ void collide_detect_object_to_object(physics_object* a, physics_object* b) {
         }
     }
 
-    // Handle trigger contacts
-    if (a->is_trigger || b->is_trigger) {
-        struct EpaResult dummy_result;
-        dummy_result.normal = gZeroVec;
-        dummy_result.contactA = *a->position;
-        dummy_result.contactB = *b->position;
-        dummy_result.penetration = 0.0f;
-
-        contact_constraint* constraint = collide_cache_contact_constraint(a, b, &dummy_result, 0.0f, 0.0f, true);
-
-        if (constraint) {
-            if (a->is_trigger) {
-                collide_add_contact(b, constraint, a);
-            } else {
-                collide_add_contact(a, constraint, b);
-            }
-        }
-
-        return;
-    }
-
     // Compute EPA result
     if (!epa_skip) {
         bool success = epaSolve(
@@ -803,68 +1198,40 @@ void collide_detect_object_to_object(physics_object* a, physics_object* b) {
         }
     }
 
-    // Wake up sleeping objects only if the collision is energetic enough
-    // This allows stacked objects to sleep
-    Vector3 velA = gZeroVec;
-    Vector3 velB = gZeroVec;
+    collide_cache_object_pair(a, b, &result);
+}
 
-    if (a && !a->is_kinematic) {
-        velA = a->velocity;
-        if (a->rotation) {
-            Vector3 centerOfMassA;
-            Vector3 rotatedOffset;
-            matrix3Vec3Mul(&a->_rotation_matrix, &a->center_offset, &rotatedOffset);
-            vector3Add(a->position, &rotatedOffset, &centerOfMassA);
-            
-            Vector3 rA;
-            vector3Sub(&result.contactA, &centerOfMassA, &rA);
-            Vector3 angularPart;
-            vector3Cross(&a->angular_velocity, &rA, &angularPart);
-            vector3Add(&velA, &angularPart, &velA);
-        }
-    }
 
-    if (b && !b->is_kinematic) {
-        velB = b->velocity;
-        if (b->rotation) {
-            Vector3 centerOfMassB;
-            Vector3 rotatedOffset;
-            matrix3Vec3Mul(&b->_rotation_matrix, &b->center_offset, &rotatedOffset);
-            vector3Add(b->position, &rotatedOffset, &centerOfMassB);
-            
-            Vector3 rB;
-            vector3Sub(&result.contactB, &centerOfMassB, &rB);
-            Vector3 angularPart;
-            vector3Cross(&b->angular_velocity, &rB, &angularPart);
-            vector3Add(&velB, &angularPart, &velB);
-        }
-    }
+// ============================================================================
+// TRIGGER OVERLAP TESTS
+// ============================================================================
 
-    Vector3 relVel;
-    vector3Sub(&velA, &velB, &relVel);
-    float impactSpeedSq = vector3MagSqrd(&relVel);
-    
-    // Use a threshold slightly higher than the sleep threshold to ensure stability.
-    // If objects are moving slower than the sleep threshold, they shouldn't wake each other up.
-    const float wake_threshold_sq = PHYS_OBJECT_SPEED_SLEEP_THRESHOLD_SQ * 1.2f;
+/// @brief Squared distance of a point to an AABB (0 if the point is inside)
+static float collide_point_to_aabb_dist_sq(const Vector3* point, const AABB* box) {
+    float dx = fmaxf(box->min.x - point->x, fmaxf(0.0f, point->x - box->max.x));
+    float dy = fmaxf(box->min.y - point->y, fmaxf(0.0f, point->y - box->max.y));
+    float dz = fmaxf(box->min.z - point->z, fmaxf(0.0f, point->z - box->max.z));
+    return dx * dx + dy * dy + dz * dz;
+}
 
-    if (impactSpeedSq > wake_threshold_sq) {
-        if (a && !a->is_kinematic) physics_object_wake(a);
-        if (b && !b->is_kinematic) physics_object_wake(b);
-    } 
-    // The solver will transfer momentum if necessary, and if the resulting velocity
-    // is high enough, the object will wake up in the next update cycle.
+bool collide_trigger_overlap(const physics_object* trigger, const physics_object* other) {
+    bool trigger_is_sphere = trigger->collision->shape_type == COLLISION_SHAPE_SPHERE;
+    bool other_is_sphere = other->collision->shape_type == COLLISION_SHAPE_SPHERE;
 
-    // Combined friction and bounce
-    float combined_friction = minf(a->collision->friction, b->collision->friction);
-    float combined_bounce = a->collision->bounce * b->collision->bounce;//minf(a->collision->bounce, b->collision->bounce);
+    if (trigger_is_sphere && other_is_sphere) {
+        float radii_sum = trigger->collision->shape_data.sphere.radius + other->collision->shape_data.sphere.radius;
+        return vector3DistSqrd(&trigger->collision->collider_world_center, &other->collision->collider_world_center) < radii_sum * radii_sum;
+    }
 
-    // Cache the contact constraint
-    contact_constraint* constraint = collide_cache_contact_constraint(a, b, &result, combined_friction, combined_bounce, false);
+    if (trigger_is_sphere) {
+        float radius = trigger->collision->shape_data.sphere.radius;
+        return collide_point_to_aabb_dist_sq(&trigger->collision->collider_world_center, &other->bounding_box) < radius * radius;
+    }
 
-    // Still add to old contact lists for compatibility
-    if (constraint) {
-        collide_add_contact(a, constraint, b);
-        collide_add_contact(b, constraint, a);
+    if (other_is_sphere) {
+        float radius = other->collision->shape_data.sphere.radius;
+        return collide_point_to_aabb_dist_sq(&other->collision->collider_world_center, &trigger->bounding_box) < radius * radius;
     }
-}
\ No newline at end of file
+
+    return AABBHasOverlap(&trigger->bounding_box, &other->bounding_box);
+}
@@ -2,16 +2,12 @@
 #define __COLLISION_COLLIDE_H__
 
 #include "mesh_collider.h"
+#include "heightfield.h"
+#include "mesh_instance.h"
 #include "raycast.h"
 #include "physics_object.h"
 #include "epa.h"
 
-/// @brief Adds a contact constraint to the physics object's active contact list.
-/// @param object The physics object to add the contact to.
-/// @param constraint The contact constraint to add.
-/// @param other_object The other physics object involved in the collision.
-void collide_add_contact(physics_object* object, contact_constraint* constraint, physics_object* other_object);
-
 /// @brief Applies velocity corrections to an object based on a collision result.
 /// @param object The object to correct.
 /// @param result The EPA result containing collision normal and penetration.
@@ -33,6 +29,11 @@ void collide_detect_object_to_object(physics_object* a, physics_object* b);
 /// @param mesh The static mesh collider.
 void collide_detect_object_to_mesh(physics_object* object, const struct mesh_collider* mesh);
 
+/// @brief Detects collisions between a physics object and a placed instance of a static mesh collider.
+/// @param object The physics object.
+/// @param instance The mesh instance.
+void collide_detect_object_to_mesh_instance(physics_object* object, const struct mesh_instance* instance);
+
 /// @brief Detects collision between a physics object and a single mesh triangle.
 /// @param object The physics object.
 /// @param mesh The mesh collider containing the triangle.
@@ -40,15 +41,42 @@ void collide_detect_object_to_mesh(physics_object* object, const struct mesh_col
 /// @return true if a collision was detected and cached, false otherwise.
 bool collide_detect_object_to_triangle(physics_object* object, const struct mesh_collider* mesh, int triangle_index);
 
+/// @brief Detects collisions between a physics object and a heightfield.
+/// Spheres and capsules use analytic contacts, other shapes run GJK/EPA against the triangles of the overlapped cells.
+/// @param object The physics object.
+/// @param heightfield The static heightfield.
+void collide_detect_object_to_heightfield(physics_object* object, const struct heightfield* heightfield);
+
 /// @brief Caches a detected contact constraint for later solving.
 /// @param object_a The first physics object (or NULL for static mesh).
 /// @param object_b The second physics object.
+/// @param instance The mesh instance on side A if object_a is NULL and the contact is not with the static mesh, NULL otherwise.
 /// @param result The EPA result containing contact information.
 /// @param combined_friction The combined friction coefficient.
 /// @param combined_bounce The combined bounce coefficient.
-/// @param is_trigger Whether this is a trigger interaction.
 /// @return A pointer to the cached contact constraint, or NULL if cache is full.
-contact_constraint *collide_cache_contact_constraint(physics_object *object_a, physics_object *object_b, const struct EpaResult *result,
-                                                     float combined_friction, float combined_bounce, bool is_trigger);
+contact_constraint *collide_cache_contact_constraint(physics_object *object_a, physics_object *object_b, const struct mesh_instance *instance,
+                                                     const struct EpaResult *result, float combined_friction, float combined_bounce);
+
+/// @brief Computes the world space contact points of a cached contact point from its local points.
+/// @param constraint The contact constraint the point belongs to.
+/// @param point The cached contact point.
+/// @param contact_a Output: contact point on surface A in world space.
+/// @param contact_b Output: contact point on surface B in world space.
+void collide_contact_point_world(const contact_constraint* constraint, const contact_point* point, Vector3* contact_a, Vector3* contact_b);
+
+// ============================================================================
+// TRIGGER OVERLAP TESTS
+// ============================================================================
+
+/// @brief Tests if a trigger overlaps another physics object.
+///
+/// Triggers never produce contact constraints, so only a cheap boolean test is performed:
+/// analytic sphere-sphere if both colliders are spheres, sphere-vs-AABB if one of them is a sphere
+/// and AABB-vs-AABB otherwise.
+/// @param trigger The trigger physics object.
+/// @param other The physics object to test against.
+/// @return true if the objects overlap, false otherwise.
+bool collide_trigger_overlap(const physics_object* trigger, const physics_object* other);
 
 #endif
\ No newline at end of file
@@ -59,13 +59,8 @@ static bool collide_swept_triangle_check(void* data, int triangle_index) {
         vector3Scale(&ray.dir, &ray.dir, 1.0f / dist);
         ray.maxDistance = dist;
         
-        struct mesh_triangle triangle;
-        triangle.vertices = collide_data->mesh->vertices;
-        triangle.triangle = collide_data->mesh->triangles[triangle_index];
-        triangle.normal = collide_data->mesh->normals[triangle_index];
-        
         raycast_hit hit;
-        if (ray_triangle_intersection(&ray, &hit, &triangle)) {
+        if (ray_triangle_intersection(&ray, &hit, mesh_collider_get_triangle(collide_data->mesh, triangle_index))) {
             // We hit the triangle with the center ray
             // Construct a result that looks like EPA result
             collide_data->hit_result.normal = hit.normal;
@@ -86,21 +81,18 @@ static bool collide_swept_triangle_check(void* data, int triangle_index) {
     swept.object = collide_data->object;
     vector3Sub(collide_data->prev_pos, collide_data->object->position, &swept.offset);
 
-    struct mesh_triangle triangle;
-    triangle.vertices = collide_data->mesh->vertices;
-    triangle.triangle = collide_data->mesh->triangles[triangle_index];
-    triangle.normal = collide_data->mesh->normals[triangle_index];
+    struct mesh_triangle* triangle = mesh_collider_get_triangle(collide_data->mesh, triangle_index);
 
     struct Simplex simplex;
     Vector3 firstDir = gRight;
-    if (!gjkCheckForOverlap(&simplex, &triangle, mesh_triangle_gjk_support_function, &swept, collide_swept_gjk_support_function, &firstDir)) {
+    if (!gjkCheckForOverlap(&simplex, triangle, mesh_triangle_gjk_support_function, &swept, collide_swept_gjk_support_function, &firstDir)) {
         return false;
     }
 
     struct EpaResult result;
     if (epaSolveSwept(
             &simplex,
-            &triangle,
+            triangle,
             mesh_triangle_gjk_support_function,
             &swept,
             collide_swept_gjk_support_function,
@@ -118,21 +110,13 @@ static bool collide_swept_triangle_check(void* data, int triangle_index) {
 
     if (epaSolve(
             &simplex,
-            &triangle,
+            triangle,
             mesh_triangle_gjk_support_function,
             collide_data->object,
             physics_object_gjk_support_function,
             &result))
     {
-        bool ignore = false;
-        contact* c = collide_data->object->active_contacts;
-        while (c) {
-            if (c->other_object == NULL && vector3Dot(&result.normal, &c->constraint->normal) > 0.9f) {
-                ignore = true;
-                break;
-            }
-            c = c->next;
-        }
+        bool ignore = collision_scene_has_mesh_contact(collide_data->object, &result.normal, 0.9f);
 
         if (!ignore) {
             collide_data->hit_result = result;
@@ -178,12 +162,10 @@ static void collide_swept_resolve_bounce(
     vector3Add(&move_amount, &object->bounding_box.max, &object->bounding_box.max);
 
     //Add new contact to object (object is contact Point B in the case of mesh collision)
-    // Cache the contact (entity_a = 0 for static mesh)
-    contact_constraint *constraint = collide_cache_contact_constraint(NULL, object, &collide_data->hit_result, 0, object->collision->bounce, false);
+    // Cache the contact (entity_a = 0 for static mesh), it is reported as a contact event for ground detection
+    contact_constraint *constraint = collide_cache_contact_constraint(NULL, object, NULL, &collide_data->hit_result, 0, object->collision->bounce);
     if (constraint) {
         constraint->is_active = false;
-        // Still add to old contact list for ground detection logic
-        collide_add_contact(object, constraint, NULL);
     }
 }
 
@@ -219,16 +201,14 @@ bool collide_object_to_mesh_swept(physics_object* object, struct mesh_collider*
 
     int result_count = 0;
     int max_results = 20;
-    node_proxy results[max_results];
+    uint16_t results[max_results];
 
-    AABB_tree_query_bounds(&mesh->aabbtree, &expanded_box, results, &result_count, max_results);
+    mesh_bvh_query_bounds(&mesh->bvh, &expanded_box, results, &result_count, max_results);
     
     bool did_hit = false;
     for (size_t j = 0; j < result_count; j++)
     {
-        int triangle_index = (int)AABB_tree_get_node_data(&mesh->aabbtree, results[j]);
-
-        did_hit = did_hit | collide_swept_triangle_check(&collide_data, triangle_index);
+        did_hit = did_hit | collide_swept_triangle_check(&collide_data, results[j]);
     }
     if (!did_hit)
     {
@@ -238,4 +218,49 @@ bool collide_object_to_mesh_swept(physics_object* object, struct mesh_collider*
     collide_swept_resolve_bounce(object, &collide_data, &start_pos);
 
     return true;
-}
\ No newline at end of file
+}
+
+bool collide_object_to_heightfield_swept(physics_object* object, const struct heightfield* heightfield, Vector3* prev_pos){
+    if (object->is_trigger) {
+        return false;
+    }
+
+    Vector3 dir;
+    vector3FromTo(prev_pos, object->position, &dir);
+    float dist = vector3Mag(&dir);
+    if (dist <= 0.0001f) {
+        return false;
+    }
+
+    // the terrain has no thin walls, the center ray is enough to prevent tunneling
+    raycast ray;
+    ray.origin = *prev_pos;
+    vector3Scale(&dir, &ray.dir, 1.0f / dist);
+    ray._invDir.x = safeInvert(ray.dir.x);
+    ray._invDir.y = safeInvert(ray.dir.y);
+    ray._invDir.z = safeInvert(ray.dir.z);
+    ray.maxDistance = dist;
+
+    raycast_hit hit;
+    if (!heightfield_raycast(heightfield, &ray, &hit)) {
+        return false;
+    }
+
+    struct object_mesh_collide_data collide_data;
+    collide_swept_data_init(&collide_data, prev_pos, NULL, object);
+    collide_data.hit_result.normal = hit.normal;
+    collide_data.hit_result.penetration = 0;
+    collide_data.hit_result.contactA = hit.point;
+    collide_data.hit_result.contactB = hit.point;
+
+    Vector3 start_pos = *object->position;
+
+    // Move object to hit point (minus a small buffer)
+    Vector3 back_off;
+    vector3Scale(&ray.dir, &back_off, 0.01f);
+    vector3Sub(&hit.point, &back_off, object->position);
+
+    collide_swept_resolve_bounce(object, &collide_data, &start_pos);
+
+    return true;
+}
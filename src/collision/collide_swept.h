@@ -3,6 +3,7 @@
 
 #include "physics_object.h"
 #include "mesh_collider.h"
+#include "heightfield.h"
 #include "epa.h"
 
 /// @brief Data structure for swept collision detection against a mesh.
@@ -20,4 +21,11 @@ struct object_mesh_collide_data {
 /// @return true if a collision occurred, false otherwise.
 bool collide_object_to_mesh_swept(physics_object* object, struct mesh_collider* mesh, Vector3* prev_pos);
 
+/// @brief Performs a swept collision check between a physics object and a heightfield using the path of its center.
+/// @param object The physics object to check.
+/// @param heightfield The static heightfield.
+/// @param prev_pos The previous position of the object (start of the sweep).
+/// @return true if a collision occurred, false otherwise.
+bool collide_object_to_heightfield_swept(physics_object* object, const struct heightfield* heightfield, Vector3* prev_pos);
+
 #endif
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "collision_scene.h"
 
 #include <malloc.h>
+#include <string.h>
 #include <stdbool.h>
 #include <assert.h>
 #include <math.h>
@@ -9,6 +10,7 @@
 
 #include "mesh_collider.h"
 #include "../resource/mesh_collider.h"
+#include "../resource/heightfield.h"
 #include "collide.h"
 #include "collide_swept.h"
 #include "../util/hash_map.h"
@@ -24,15 +26,19 @@ struct collision_scene g_scene;
 
 void collision_scene_reset() {
     free(g_scene.elements);
-    free(g_scene.all_contacts);
+    free(g_scene.contact_events);
     free(g_scene.cached_contact_constraints);
+    free(g_scene.trigger_overlaps);
+    free(g_scene._step_scratch);
     AABB_tree_free(&g_scene.object_aabbtree);
+    AABB_tree_free(&g_scene.mesh_instance_tree);
     hash_map_destroy(&g_scene.entity_mapping);
     hash_map_destroy(&g_scene.contact_map);
 
     hash_map_init(&g_scene.entity_mapping, MAX_PHYSICS_OBJECTS);
     hash_map_init(&g_scene.contact_map, MAX_CACHED_CONTACTS);
     AABB_tree_init(&g_scene.object_aabbtree, MAX_PHYSICS_OBJECTS);
+    AABB_tree_init(&g_scene.mesh_instance_tree, MAX_MESH_INSTANCES);
     g_scene.elements = malloc(sizeof(struct collision_scene_element) * MAX_PHYSICS_OBJECTS);
     g_scene.capacity = MAX_PHYSICS_OBJECTS;
     g_scene.objectCount = 0;
@@ -40,20 +46,30 @@ void collision_scene_reset() {
         mesh_collider_release(g_scene.mesh_collider);
         g_scene.mesh_collider = NULL;
     }
-
-    g_scene.all_contacts = malloc(sizeof(contact) * MAX_ACTIVE_CONTACTS);
-    g_scene.next_free_contact = &g_scene.all_contacts[0];
-
-    for (int i = 0; i + 1 < MAX_ACTIVE_CONTACTS; ++i)
-    {
-        g_scene.all_contacts[i].next = &g_scene.all_contacts[i + 1];
+    if(g_scene.heightfield){
+        heightfield_release(g_scene.heightfield);
+        g_scene.heightfield = NULL;
     }
 
-    g_scene.all_contacts[MAX_ACTIVE_CONTACTS - 1].next = NULL;
+    g_scene.contact_events = malloc(sizeof(contact_event) * MAX_CONTACT_EVENTS);
+    g_scene.contact_event_count = 0;
+    g_scene._step_contact_event_count = 0;
+    g_scene.dropped_contact_event_count = 0;
 
     // Initialize constraint cache for iterative solver
     g_scene.cached_contact_constraints = malloc(sizeof(contact_constraint) * MAX_CACHED_CONTACTS);
     g_scene.cached_contact_constraint_count = 0;
+
+    g_scene.trigger_overlaps = malloc(sizeof(struct trigger_overlap) * MAX_TRIGGER_OVERLAPS);
+    g_scene.trigger_overlap_count = 0;
+
+    g_scene._step_scratch = NULL;
+    g_scene._step_scratch_size = 0;
+    g_scene._step_scratch_used = 0;
+    g_scene.contact_solvers = NULL;
+    g_scene.contact_solver_count = 0;
+
+    g_scene.solver_type = COLLISION_SOLVER_PGS;
 }
 
 struct collision_scene* collision_scene_get_instance() {
@@ -88,45 +104,63 @@ physics_object* collision_scene_find_object(entity_id id) {
     return hash_map_get(&g_scene.entity_mapping, id);
 }
 
-/**
- * @brief Returns the active contacts of a physics object to the global scene's free contact list.
- *
- * This function iterates through the active contacts of the given physics object and appends
- * them to the global scene's free contact list. It ensures that the active contacts of the
- * object are properly returned and the object's active contact list is cleared.
- *
- * @param object Pointer to the physics object whose active contacts are to be returned.
- */
-static void collision_scene_release_object_contacts(physics_object* object) {
-    if (!object->_is_sleeping) {
-        contact* last_contact = object->active_contacts;
+/// @brief Appends an event for a contact constraint to the scene's contact event stream
+/// @param constraint the constraint the event is reported for
+/// @param type enum contact_event_type
+static void collision_scene_push_contact_event(contact_constraint* constraint, uint8_t type) {
+    if (g_scene.contact_event_count >= MAX_CONTACT_EVENTS) {
+        g_scene.dropped_contact_event_count++;
+        return;
+    }
 
-        while (last_contact && last_contact->next) {
-            last_contact = last_contact->next;
-        }
+    contact_event* event = &g_scene.contact_events[g_scene.contact_event_count++];
+    physics_object* a = constraint->objectA;
+    physics_object* b = constraint->objectB;
 
-        if (last_contact) {
-            last_contact->next = g_scene.next_free_contact;
-            g_scene.next_free_contact = object->active_contacts;
-            object->active_contacts = NULL;
-        }
-    } else {
-        contact** pp = &object->active_contacts;
-        while (*pp) {
-            contact* c = *pp;
-            physics_object* other = c->other_object;
-            
-            // If other object is awake, it will perform collision detection and re-add the contact.
-            // So we must remove it here to avoid duplicates.
-            // If other object is sleeping (or static), no detection will happen, so we keep the contact.
-            if (other && !other->_is_sleeping) {
-                *pp = c->next;
-                c->next = g_scene.next_free_contact;
-                g_scene.next_free_contact = c;
-            } else {
-                pp = &c->next;
-            }
+    event->normal = constraint->normal;
+    event->point = gZeroVec;
+    if (constraint->point_count > 0) {
+        Vector3 contact_b;
+        collide_contact_point_world(constraint, &constraint->points[0], &event->point, &contact_b);
+    }
+    event->normal_impulse = 0.0f;
+    for (int i = 0; i < constraint->point_count; i++) {
+        event->normal_impulse += constraint->points[i].accumulated_normal_impulse;
+    }
+    event->pid = constraint->pid;
+    // the static mesh and mesh instances only collide with tangible objects
+    event->entity_a = a ? a->entity_id : (constraint->instance ? constraint->instance->entity_id : 0);
+    event->entity_b = b ? b->entity_id : 0;
+    event->layers_a = a ? a->collision_layers : COLLISION_LAYER_TANGIBLE;
+    event->layers_b = b ? b->collision_layers : COLLISION_LAYER_TANGIBLE;
+    event->type = type;
+
+    constraint->is_reported = type != CONTACT_EVENT_END;
+}
+
+/// @brief Drops the events of the previous step, the end events pushed by removals since then start the new stream
+static void collision_scene_begin_contact_events() {
+    int carried_over = g_scene.contact_event_count - g_scene._step_contact_event_count;
+
+    memmove(g_scene.contact_events, &g_scene.contact_events[g_scene._step_contact_event_count], sizeof(contact_event) * carried_over);
+    g_scene.contact_event_count = carried_over;
+    g_scene._step_contact_event_count = 0;
+}
+
+/// @brief Rebuilds the pid chains of the contact map after cached constraints were removed or moved
+static void collision_scene_rebuild_contact_map() {
+    hash_map_clear(&g_scene.contact_map);
+
+    for (int i = 0; i < g_scene.cached_contact_constraint_count; i++) {
+        contact_constraint* c = &g_scene.cached_contact_constraints[i];
+        c->next_same_pid_index = -1;
+        
+        intptr_t existing_idx_plus_1 = (intptr_t)hash_map_get(&g_scene.contact_map, c->pid);
+        
+        if (existing_idx_plus_1 != 0) {
+            c->next_same_pid_index = (int)existing_idx_plus_1 - 1;
         }
+        hash_map_set(&g_scene.contact_map, c->pid, (void*)(intptr_t)(i + 1));
     }
 }
 
@@ -135,20 +169,23 @@ static void collision_scene_release_object_contacts(physics_object* object) {
 static void collision_scene_wake_island(physics_object* obj) {
     if (obj->_is_sleeping) {
         physics_object_wake(obj);
-        // Recurse on ALL contacts
-        contact* c = obj->active_contacts;
-        while (c) {
-            if (c->other_object) collision_scene_wake_island(c->other_object);
-            c = c->next;
+    }
+
+    // Recurse on sleeping neighbors only, woken objects are skipped to avoid cycles.
+    // The tree nodes are fattened, so the broadphase finds every object the cached constraints can connect to
+    node_proxy results[COLLISION_SCENE_MAX_WAKE_RESULTS];
+    int result_count = 0;
+    AABB_tree_query_bounds(&g_scene.object_aabbtree, &obj->bounding_box, results, &result_count, COLLISION_SCENE_MAX_WAKE_RESULTS);
+
+    for (int i = 0; i < result_count; i++) {
+        physics_object* neighbor = AABB_tree_get_node_data(&g_scene.object_aabbtree, results[i]);
+
+        if (!neighbor || neighbor == obj || !neighbor->_is_sleeping) {
+            continue;
         }
-    } else {
-        // If already awake, only recurse on SLEEPING contacts to avoid cycles
-        contact* c = obj->active_contacts;
-        while (c) {
-            if (c->other_object && c->other_object->_is_sleeping) {
-                collision_scene_wake_island(c->other_object);
-            }
-            c = c->next;
+
+        if (hash_map_get(&g_scene.contact_map, contact_pair_id_get(obj->entity_id, neighbor->entity_id))) {
+            collision_scene_wake_island(neighbor);
         }
     }
 }
@@ -156,34 +193,21 @@ static void collision_scene_wake_island(physics_object* obj) {
 void collision_scene_remove(physics_object* object) {
     if(!collision_scene_find_object(object->entity_id))return;
 
-    // Cleanup back-references in neighbors
-    contact* c = object->active_contacts;
-    while (c) {
-        physics_object* neighbor = c->other_object;
-        if (neighbor) {
-            // Wake up the neighbor so it can react to the removal (e.g. fall if it was resting on this object)
-            collision_scene_wake_island(neighbor);
+    // Wake up the neighbors so they can react to the removal (e.g. fall if they were resting on this object)
+    for (int i = 0; i < g_scene.cached_contact_constraint_count; i++) {
+        contact_constraint* constraint = &g_scene.cached_contact_constraints[i];
 
-            contact** pp = &neighbor->active_contacts;
-            while (*pp) {
-                contact* neighbor_c = *pp;
-                if (neighbor_c->other_object == object) {
-                    *pp = neighbor_c->next;
-                    neighbor_c->next = g_scene.next_free_contact;
-                    g_scene.next_free_contact = neighbor_c;
-                    break;
-                }
-                pp = &(*pp)->next;
-            }
+        if (constraint->objectA == object && constraint->objectB) {
+            collision_scene_wake_island(constraint->objectB);
+        } else if (constraint->objectB == object && constraint->objectA) {
+            collision_scene_wake_island(constraint->objectA);
         }
-        c = c->next;
     }
 
     bool has_found = false;
 
     for (int i = 0; i < g_scene.objectCount; i++) {
         if (object == g_scene.elements[i].object) {
-            collision_scene_release_object_contacts(object);
             has_found = true;
         }
 
@@ -198,6 +222,20 @@ void collision_scene_remove(physics_object* object) {
     AABB_tree_remove_leaf_node(&g_scene.object_aabbtree, object->_aabb_tree_node_id, true);
     hash_map_delete(&g_scene.entity_mapping, object->entity_id);
 
+    // End trigger overlaps involving this object, gameplay still sees the EXIT this step
+    for (int i = 0; i < g_scene.trigger_overlap_count; i++) {
+        struct trigger_overlap* overlap = &g_scene.trigger_overlaps[i];
+
+        if (overlap->trigger == object) {
+            overlap->trigger = NULL;
+            overlap->state = TRIGGER_OVERLAP_EXIT;
+        }
+        if (overlap->other == object) {
+            overlap->other = NULL;
+            overlap->state = TRIGGER_OVERLAP_EXIT;
+        }
+    }
+
     // Remove cached constraints involving this object
     int write_index = 0;
     bool constraints_removed = false;
@@ -205,6 +243,9 @@ void collision_scene_remove(physics_object* object) {
         contact_constraint* constraint = &g_scene.cached_contact_constraints[read_index];
         
         if (constraint->objectA == object || constraint->objectB == object) {
+            if (constraint->is_reported) {
+                collision_scene_push_contact_event(constraint, CONTACT_EVENT_END);
+            }
             constraints_removed = true;
             continue; // Skip this constraint (remove it)
         }
@@ -218,20 +259,20 @@ void collision_scene_remove(physics_object* object) {
 
     // Rebuild contact map if we removed anything
     if (constraints_removed) {
-        hash_map_clear(&g_scene.contact_map);
+        collision_scene_rebuild_contact_map();
+    }
+}
 
-        for (int i = 0; i < g_scene.cached_contact_constraint_count; i++) {
-            contact_constraint* c = &g_scene.cached_contact_constraints[i];
-            c->next_same_pid_index = -1;
-            
-            intptr_t existing_idx_plus_1 = (intptr_t)hash_map_get(&g_scene.contact_map, c->pid);
-            
-            if (existing_idx_plus_1 != 0) {
-                c->next_same_pid_index = (int)existing_idx_plus_1 - 1;
-            }
-            hash_map_set(&g_scene.contact_map, c->pid, (void*)(intptr_t)(i + 1));
+struct trigger_overlap* collision_scene_find_trigger_overlap(physics_object* trigger, physics_object* other) {
+    for (int i = 0; i < g_scene.trigger_overlap_count; i++) {
+        struct trigger_overlap* overlap = &g_scene.trigger_overlaps[i];
+
+        if ((!trigger || overlap->trigger == trigger) && (!other || overlap->other == other)) {
+            return overlap;
         }
     }
+
+    return NULL;
 }
 
 // ============================================================================
@@ -243,22 +284,109 @@ void collision_scene_use_static_collision(struct mesh_collider* mesh_collider) {
 }
 
 void collision_scene_remove_static_collision() {
-    AABB_tree_free(&g_scene.mesh_collider->aabbtree);
+    mesh_bvh_free(&g_scene.mesh_collider->bvh);
     g_scene.mesh_collider = NULL;
 }
 
+void collision_scene_add_mesh_instance(struct mesh_instance* instance) {
+    instance->_aabb_tree_node_id = AABB_tree_create_node(&g_scene.mesh_instance_tree, instance->world_bounds, instance);
+}
+
+void collision_scene_remove_mesh_instance(struct mesh_instance* instance) {
+    if (instance->_aabb_tree_node_id == AABB_TREE_NULL_NODE) {
+        return;
+    }
+    AABB_tree_remove_leaf_node(&g_scene.mesh_instance_tree, instance->_aabb_tree_node_id, true);
+    instance->_aabb_tree_node_id = AABB_TREE_NULL_NODE;
+
+    // Remove the constraints anchored to the instance, the objects resting on it have to fall
+    int write_index = 0;
+    bool constraints_removed = false;
+    for (int read_index = 0; read_index < g_scene.cached_contact_constraint_count; read_index++) {
+        contact_constraint* constraint = &g_scene.cached_contact_constraints[read_index];
+
+        if (constraint->instance == instance) {
+            if (constraint->is_reported) {
+                collision_scene_push_contact_event(constraint, CONTACT_EVENT_END);
+            }
+            collision_scene_wake_island(constraint->objectB);
+            constraints_removed = true;
+            continue;
+        }
+
+        if (write_index != read_index) {
+            g_scene.cached_contact_constraints[write_index] = g_scene.cached_contact_constraints[read_index];
+        }
+        write_index++;
+    }
+    g_scene.cached_contact_constraint_count = write_index;
+
+    if (constraints_removed) {
+        collision_scene_rebuild_contact_map();
+    }
+}
+
+void collision_scene_move_mesh_instance(struct mesh_instance* instance, const Vector3* position, const Quaternion* rotation) {
+    Vector3 displacement;
+    vector3Sub(position, &instance->position, &displacement);
+    mesh_instance_move(instance, position, rotation, FIXED_DELTATIME);
+
+    if (instance->_aabb_tree_node_id == AABB_TREE_NULL_NODE) {
+        return;
+    }
+    AABB_tree_move_node(&g_scene.mesh_instance_tree, instance->_aabb_tree_node_id, instance->world_bounds, &displacement);
+
+    if (vector3IsZero(&instance->velocity) && vector3IsZero(&instance->angular_velocity)) {
+        return;
+    }
+
+    // sleeping objects skip the mesh narrowphase, wake the ones the instance may carry or run into
+    node_proxy results[MESH_INSTANCE_MAX_WAKE_RESULTS];
+    int result_count = 0;
+    AABB_tree_query_bounds(&g_scene.object_aabbtree, &instance->world_bounds, results, &result_count, MESH_INSTANCE_MAX_WAKE_RESULTS);
+    for (int i = 0; i < result_count; i++) {
+        physics_object* object = AABB_tree_get_node_data(&g_scene.object_aabbtree, results[i]);
+
+        if (object && object->_is_sleeping) {
+            collision_scene_wake_island(object);
+        }
+    }
+}
+
+void collision_scene_use_heightfield(struct heightfield* heightfield) {
+    g_scene.heightfield = heightfield;
+}
+
+void collision_scene_remove_heightfield() {
+    g_scene.heightfield = NULL;
+}
+
 // ============================================================================
 // Internal / Helpers
 // ============================================================================
 
-contact* collision_scene_allocate_contact() {
-    if (!g_scene.next_free_contact) {
-        return NULL;
+void collision_scene_set_solver(enum collision_solver_type solver_type) {
+    g_scene.solver_type = solver_type;
+}
+
+bool collision_scene_has_mesh_contact(physics_object* object, const Vector3* normal, float min_normal_dot) {
+    contact_pair_id pid = contact_pair_id_get(0, object->entity_id);
+
+    // walk the constraints of the (mesh, object) pair
+    intptr_t idx_plus_1 = (intptr_t)hash_map_get(&g_scene.contact_map, pid);
+    int idx = (int)idx_plus_1 - 1;
+
+    while (idx >= 0) {
+        contact_constraint* constraint = &g_scene.cached_contact_constraints[idx];
+
+        if (constraint->pid == pid && constraint->objectA == NULL &&
+            (!normal || vector3Dot(normal, &constraint->normal) > min_normal_dot)) {
+            return true;
+        }
+        idx = constraint->next_same_pid_index;
     }
 
-    contact* result = g_scene.next_free_contact;
-    g_scene.next_free_contact = result->next;
-    return result;
+    return false;
 }
 
 // ============================================================================
@@ -297,7 +425,42 @@ static void physics_object_apply_angular_impulse_to_rotation(physics_object* obj
     }
 }
 
-/// @brief Refresh contacts: update world positions from local and mark as inactive
+/// @brief Allocates memory from the step scratch arena, valid until the start of the next step.
+/// The arena only grows for the first allocation of a step, since growing moves the memory of earlier allocations
+/// @param size 
+/// @return pointer to the memory, NULL if the arena is full or out of memory
+static void* collision_scene_scratch_alloc(int size) {
+    // keep allocations 16 byte aligned for the solver structs
+    size = (size + 15) & ~15;
+    if (g_scene._step_scratch_used + size > g_scene._step_scratch_size) {
+        if (g_scene._step_scratch_used) {
+            return NULL;
+        }
+
+        int new_size = ((size + STEP_SCRATCH_GROW_SIZE - 1) / STEP_SCRATCH_GROW_SIZE) * STEP_SCRATCH_GROW_SIZE;
+        // the old contents are discarded anyway, so there is nothing to copy
+        free(g_scene._step_scratch);
+        g_scene._step_scratch = malloc(new_size);
+        g_scene._step_scratch_size = g_scene._step_scratch ? new_size : 0;
+
+        if (!g_scene._step_scratch) {
+            return NULL;
+        }
+    }
+
+    void* result = g_scene._step_scratch + g_scene._step_scratch_used;
+    g_scene._step_scratch_used += size;
+    return result;
+}
+
+/// @brief Discards everything allocated from the step scratch arena
+static void collision_scene_scratch_reset() {
+    g_scene._step_scratch_used = 0;
+    g_scene.contact_solvers = NULL;
+    g_scene.contact_solver_count = 0;
+}
+
+/// @brief Refresh contacts: mark as inactive so they have to be re-detected
 static void collision_scene_refresh_contacts() {
     for (int i = 0; i < g_scene.cached_contact_constraint_count; i++) {
         contact_constraint* constraint = &g_scene.cached_contact_constraints[i];
@@ -314,30 +477,9 @@ static void collision_scene_refresh_contacts() {
         } else {
              constraint->is_active = false;
         }
-        
-        for (int j = 0; j < constraint->point_count; j++) {
-            contact_point* cp = &constraint->points[j];
-            cp->active = false;
 
-            // Update world positions from local
-            if (a) {
-                Vector3 rA = cp->localPointA;
-                if (a->rotation )quatMultVector(a->rotation, &rA, &rA);
-                vector3Add(a->position, &rA, &cp->contactA);
-            } else {
-                cp->contactA = cp->localPointA;
-            }
-            
-            if (b) {
-                Vector3 rB = cp->localPointB;
-                if (b->rotation )quatMultVector(b->rotation, &rB, &rB);
-                vector3Add(b->position, &rB, &cp->contactB);
-            } else {
-                cp->contactB = cp->localPointB;
-            }
-            
-            // Update the main point to be on A (arbitrary choice, consistent with cache_contact_constraint)
-            cp->point = cp->contactA;
+        for (int j = 0; j < constraint->point_count; j++) {
+            constraint->points[j].active = false;
         }
     }
 }
@@ -365,30 +507,19 @@ static void collision_scene_remove_inactive_contacts() {
                 g_scene.cached_contact_constraints[write_index] = g_scene.cached_contact_constraints[read_index];
             }
             write_index++;
+        } else if (constraint->is_reported) {
+            collision_scene_push_contact_event(constraint, CONTACT_EVENT_END);
         }
     }
     g_scene.cached_contact_constraint_count = write_index;
 
-    // Rebuild contact map
-    hash_map_clear(&g_scene.contact_map);
-
-    for (int i = 0; i < g_scene.cached_contact_constraint_count; i++) {
-        contact_constraint* c = &g_scene.cached_contact_constraints[i];
-        c->next_same_pid_index = -1;
-        
-        intptr_t existing_idx_plus_1 = (intptr_t)hash_map_get(&g_scene.contact_map, c->pid);
-        
-        if (existing_idx_plus_1 != 0) {
-            c->next_same_pid_index = (int)existing_idx_plus_1 - 1;
-        }
-        hash_map_set(&g_scene.contact_map, c->pid, (void*)(intptr_t)(i + 1));
-    }
+    collision_scene_rebuild_contact_map();
 }
 
 static void collision_scene_fix_sweep_collisions() {
     #define MAX_SWEPT_ITERATIONS    5
-    // Detect object-to-mesh collisions
-    if (g_scene.mesh_collider) {
+    // Detect object-to-mesh and object-to-heightfield collisions
+    if (g_scene.mesh_collider || g_scene.heightfield) {
         for (int i = 0; i < g_scene.objectCount; i++)
         {
             physics_object* obj = g_scene.elements[i].object;
@@ -402,17 +533,7 @@ static void collision_scene_fix_sweep_collisions() {
             }
 
             // Check if object is already in contact with the mesh
-            bool has_mesh_contact = false;
-            contact* c = obj->active_contacts;
-            while (c) {
-                if (c->other_object == NULL) { // Static mesh contact
-                    has_mesh_contact = true;
-                    break;
-                }
-                c = c->next;
-            }
-
-            if (has_mesh_contact) continue; // Skip swept check if already touching mesh
+            if (collision_scene_has_mesh_contact(obj, NULL, 0.0f)) continue; // Skip swept check if already touching mesh
 
             Vector3* prev_pos = &obj->_prev_step_pos;
             for (int k = 0; k < MAX_SWEPT_ITERATIONS; k += 1)
@@ -428,7 +549,11 @@ static void collision_scene_fix_sweep_collisions() {
                     fabs(offset.y) > bounding_box_size.y ||
                     fabs(offset.z) > bounding_box_size.z)
                 {
-                    if (!collide_object_to_mesh_swept(obj, g_scene.mesh_collider, prev_pos))
+                    bool did_hit = g_scene.mesh_collider && collide_object_to_mesh_swept(obj, g_scene.mesh_collider, prev_pos);
+                    if (!did_hit && g_scene.heightfield) {
+                        did_hit = collide_object_to_heightfield_swept(obj, g_scene.heightfield, prev_pos);
+                    }
+                    if (!did_hit)
                     {
                         break;
                     }
@@ -446,6 +571,90 @@ static void collision_scene_fix_sweep_collisions() {
     }
 }
 
+/// @brief Detect trigger overlaps and update their enter/stay/exit state.
+/// Triggers are resolved with a boolean overlap test only and don't use contact constraint slots.
+static void collision_scene_detect_trigger_overlaps() {
+    // Drop overlaps that ended last step, reset the seen flag on the rest
+    int write_index = 0;
+    for (int read_index = 0; read_index < g_scene.trigger_overlap_count; read_index++) {
+        struct trigger_overlap* overlap = &g_scene.trigger_overlaps[read_index];
+
+        if (overlap->state == TRIGGER_OVERLAP_EXIT) {
+            continue;
+        }
+
+        overlap->_seen = false;
+        if (write_index != read_index) {
+            g_scene.trigger_overlaps[write_index] = *overlap;
+        }
+        write_index++;
+    }
+    g_scene.trigger_overlap_count = write_index;
+
+    for (int i = 0; i < g_scene.objectCount; i++) {
+        physics_object* trigger = g_scene.elements[i].object;
+
+        if (!trigger->is_trigger) {
+            continue;
+        }
+
+        int result_count = 0;
+        int max_results = 10;
+        node_proxy results[max_results];
+        AABB_tree_query_bounds(&g_scene.object_aabbtree, &trigger->bounding_box,
+                               results, &result_count, max_results);
+
+        for (int j = 0; j < result_count; j++) {
+            physics_object* other = (physics_object*)AABB_tree_get_node_data(&g_scene.object_aabbtree, results[j]);
+
+            // triggers don't interact with each other
+            if (!other || other == trigger || other->is_trigger) {
+                continue;
+            }
+
+            if (!(trigger->collision_layers & other->collision_layers)) {
+                continue;
+            }
+
+            if (trigger->collision_group && (trigger->collision_group == other->collision_group)) {
+                continue;
+            }
+
+            if (!collide_trigger_overlap(trigger, other)) {
+                continue;
+            }
+
+            struct trigger_overlap* overlap = collision_scene_find_trigger_overlap(trigger, other);
+
+            if (overlap) {
+                overlap->state = TRIGGER_OVERLAP_STAY;
+                overlap->_seen = true;
+                continue;
+            }
+
+            if (g_scene.trigger_overlap_count >= MAX_TRIGGER_OVERLAPS) {
+                continue;
+            }
+
+            overlap = &g_scene.trigger_overlaps[g_scene.trigger_overlap_count++];
+            overlap->trigger = trigger;
+            overlap->other = other;
+            overlap->pid = contact_pair_id_get(trigger->entity_id, other->entity_id);
+            overlap->state = TRIGGER_OVERLAP_ENTER;
+            overlap->_seen = true;
+        }
+    }
+
+    // Overlaps that were not found this step have ended
+    for (int i = 0; i < g_scene.trigger_overlap_count; i++) {
+        struct trigger_overlap* overlap = &g_scene.trigger_overlaps[i];
+
+        if (!overlap->_seen) {
+            overlap->state = TRIGGER_OVERLAP_EXIT;
+        }
+    }
+}
+
 /// @brief Detect all contacts (object-to-object and object-to-mesh)
 static void collision_scene_detect_all_contacts() {
     // Refresh contacts (update world pos, mark inactive)
@@ -455,6 +664,11 @@ static void collision_scene_detect_all_contacts() {
     for (int i = 0; i < g_scene.objectCount; i++) {
         physics_object* a = g_scene.elements[i].object;
 
+        // triggers are handled by collision_scene_detect_trigger_overlaps
+        if (a->is_trigger) {
+            continue;
+        }
+
         if (!a->_is_sleeping)
         {
             // Broad phase
@@ -469,7 +683,7 @@ static void collision_scene_detect_all_contacts() {
                 physics_object *b = (physics_object *)AABB_tree_get_node_data(
                     &g_scene.object_aabbtree, results[j]);
 
-                if (!b || b == a)
+                if (!b || b == a || b->is_trigger)
                     continue;
 
                 // Optimization: Skip duplicate pairs
@@ -484,8 +698,8 @@ static void collision_scene_detect_all_contacts() {
             }
         }
 
-            // Detect object-to-mesh collisions
-        if (g_scene.mesh_collider)
+            // Detect object-to-mesh, object-to-instance and object-to-heightfield collisions
+        if (g_scene.mesh_collider || g_scene.heightfield || g_scene.mesh_instance_tree.root != AABB_TREE_NULL_NODE)
         {
 
             // Skip if all position axes are frozen (object can't move anyway)
@@ -496,21 +710,148 @@ static void collision_scene_detect_all_contacts() {
             {
                 continue;
             }
-            collide_detect_object_to_mesh(a, g_scene.mesh_collider);
+            if (g_scene.mesh_collider) {
+                collide_detect_object_to_mesh(a, g_scene.mesh_collider);
+            }
+            if (g_scene.heightfield) {
+                collide_detect_object_to_heightfield(a, g_scene.heightfield);
+            }
+
+            node_proxy instance_results[MESH_INSTANCE_MAX_QUERY_RESULTS];
+            int instance_count = 0;
+            AABB_tree_query_bounds(&g_scene.mesh_instance_tree, &a->bounding_box, instance_results, &instance_count, MESH_INSTANCE_MAX_QUERY_RESULTS);
+            for (int j = 0; j < instance_count; j++) {
+                struct mesh_instance* instance = AABB_tree_get_node_data(&g_scene.mesh_instance_tree, instance_results[j]);
+                collide_detect_object_to_mesh_instance(a, instance);
+            }
         }
     }
 
 
     // Remove contacts that were not detected this frame
     collision_scene_remove_inactive_contacts();
+
+    collision_scene_detect_trigger_overlaps();
+}
+
+// Solver mode of one side of a contact constraint. The kernels below are force-inlined with constant modes,
+// so the compiler folds away the kinematic/rotation/freeze checks that don't apply to a body-type class.
+#define SOLVER_SIDE_STATIC 0 // no object (static mesh) or kinematic, never moved by the solver
+#define SOLVER_SIDE_LINEAR 1 // dynamic without rotation (or all rotation axes frozen), no frozen position axes
+#define SOLVER_SIDE_FULL 2 // dynamic with rotation, no frozen position axes
+#define SOLVER_SIDE_GENERIC 3 // frozen position axes, every flag is checked at runtime
+
+#define SOLVER_KERNEL static inline __attribute__((always_inline))
+
+/// @brief Get the solver mode of one side of a contact constraint
+static int collision_scene_solver_side_mode(physics_object* obj) {
+    if (!obj) return SOLVER_SIDE_STATIC;
+    // rotating kinematic objects still add their inertia to the position solver, so they stay generic
+    if (obj->is_kinematic) return (obj->rotation && (obj->constraints & CONSTRAINTS_FREEZE_ROTATION_ALL) != CONSTRAINTS_FREEZE_ROTATION_ALL) ? SOLVER_SIDE_GENERIC : SOLVER_SIDE_STATIC;
+    if (obj->constraints & CONSTRAINTS_FREEZE_POSITION_ALL) return SOLVER_SIDE_GENERIC;
+    if (!obj->rotation || (obj->constraints & CONSTRAINTS_FREEZE_ROTATION_ALL) == CONSTRAINTS_FREEZE_ROTATION_ALL) return SOLVER_SIDE_LINEAR;
+    return SOLVER_SIDE_FULL;
+}
+
+/// @brief Bucket a constraint into the body-type class of its specialized solver kernel
+static uint8_t collision_scene_classify_constraint(contact_constraint* cc) {
+    int mode_a = collision_scene_solver_side_mode(cc->objectA);
+    int mode_b = collision_scene_solver_side_mode(cc->objectB);
+
+    if (mode_a == SOLVER_SIDE_STATIC && mode_b == SOLVER_SIDE_FULL) return CONTACT_SOLVER_CLASS_STATIC_DYNAMIC;
+    if (mode_a == SOLVER_SIDE_STATIC && mode_b == SOLVER_SIDE_LINEAR) return CONTACT_SOLVER_CLASS_ROTATION_LOCKED;
+    if (mode_a == SOLVER_SIDE_FULL && mode_b == SOLVER_SIDE_FULL) return CONTACT_SOLVER_CLASS_DYNAMIC_DYNAMIC;
+    return CONTACT_SOLVER_CLASS_GENERIC;
+}
+
+/// @brief Solves the small dense system m * x = rhs in place with gaussian elimination (partial pivoting)
+/// @param m the system matrix, destroyed by the call
+/// @param rhs the right hand side, replaced with the solution x
+/// @param n the system size (at most MAX_CONTACT_POINTS_PER_PAIR)
+/// @return false if the system is singular
+static bool collision_scene_solve_block_system(float m[MAX_CONTACT_POINTS_PER_PAIR][MAX_CONTACT_POINTS_PER_PAIR], float* rhs, int n) {
+    for (int col = 0; col < n; col++) {
+        int pivot = col;
+        for (int row = col + 1; row < n; row++) {
+            if (fabsf(m[row][col]) > fabsf(m[pivot][col])) pivot = row;
+        }
+
+        if (fabsf(m[pivot][col]) < EPSILON) return false;
+
+        if (pivot != col) {
+            for (int k = 0; k < n; k++) {
+                float tmp = m[col][k];
+                m[col][k] = m[pivot][k];
+                m[pivot][k] = tmp;
+            }
+            float tmp = rhs[col];
+            rhs[col] = rhs[pivot];
+            rhs[pivot] = tmp;
+        }
+
+        for (int row = col + 1; row < n; row++) {
+            float factor = m[row][col] / m[col][col];
+            for (int k = col; k < n; k++) {
+                m[row][k] -= factor * m[col][k];
+            }
+            rhs[row] -= factor * rhs[col];
+        }
+    }
+
+    for (int row = n - 1; row >= 0; row--) {
+        float sum = rhs[row];
+        for (int k = row + 1; k < n; k++) {
+            sum -= m[row][k] * rhs[k];
+        }
+        rhs[row] = sum / m[row][row];
+    }
+
+    return true;
+}
+
+/// @brief Checks if the normal block mass matrix of a constraint is safe to solve directly.
+/// Nearly redundant contact points (e.g. two points on the same spot) make K close to singular,
+/// those constraints fall back to the sequential solver.
+static bool collision_scene_block_is_well_conditioned(const contact_constraint* cc, const contact_constraint_solver* cs) {
+    int n = cc->point_count;
+    float m[MAX_CONTACT_POINTS_PER_PAIR][MAX_CONTACT_POINTS_PER_PAIR];
+
+    for (int row = 0; row < n; row++) {
+        for (int col = 0; col < n; col++) {
+            m[row][col] = cs->normal_block_mass[row][col];
+        }
+    }
+
+    // K is symmetric positive (semi)definite, so the elimination pivots are positive if it is well conditioned
+    for (int col = 0; col < n; col++) {
+        if (m[col][col] < EPSILON || m[col][col] * CONTACT_BLOCK_SOLVER_MAX_CONDITION < cs->normal_block_mass[col][col]) return false;
+
+        for (int row = col + 1; row < n; row++) {
+            float factor = m[row][col] / m[col][col];
+            for (int k = col; k < n; k++) {
+                m[row][k] -= factor * m[col][k];
+            }
+        }
+    }
+
+    return true;
 }
 
 /// @brief Pre-solve: calculate effective masses and prepare constraint data
 static void collision_scene_pre_solve_contacts() {
-    for (int i = 0; i < g_scene.cached_contact_constraint_count; i++) {
+    // Solver data only lives for this step, entry i belongs to cached constraint i
+    g_scene.contact_solvers = collision_scene_scratch_alloc(sizeof(contact_constraint_solver) * g_scene.cached_contact_constraint_count);
+    if (!g_scene.contact_solvers) {
+        g_scene.contact_solver_count = 0;
+        return;
+    }
+    g_scene.contact_solver_count = g_scene.cached_contact_constraint_count;
+
+    for (int i = 0; i < g_scene.contact_solver_count; i++) {
         contact_constraint* cont_constraint = &g_scene.cached_contact_constraints[i];
+        contact_constraint_solver* cont_solver = &g_scene.contact_solvers[i];
 
-        if (!cont_constraint->is_active || cont_constraint->is_trigger) continue;
+        if (!cont_constraint->is_active) continue;
 
         physics_object* a = cont_constraint->objectA;
         physics_object* b = cont_constraint->objectB;
@@ -530,64 +871,83 @@ static void collision_scene_pre_solve_contacts() {
         }
 
         // Calculate tangent vectors for friction (shared across all points)
-        vector3CalculateTangents(&cont_constraint->normal, &cont_constraint->tangent_u, &cont_constraint->tangent_v);
+        vector3CalculateTangents(&cont_constraint->normal, &cont_solver->tangent_u, &cont_solver->tangent_v);
+
+        // Calculate linear effective mass terms (shared across all points)
+        bool aMovementConstrained = a && (a->is_kinematic || ((a->constraints & CONSTRAINTS_FREEZE_POSITION_ALL) == CONSTRAINTS_FREEZE_POSITION_ALL));
+        bool bMovementConstrained = b && (b->is_kinematic || ((b->constraints & CONSTRAINTS_FREEZE_POSITION_ALL) == CONSTRAINTS_FREEZE_POSITION_ALL));
+
+        float invMassA = 0.0f;
+        float invMassB = 0.0f;
+
+        if (a && !aMovementConstrained) {
+            bool constrainedAlongNormal = ((a->constraints & CONSTRAINTS_FREEZE_POSITION_X) && fabsf(normal.x) > 0.01f) ||
+                                          ((a->constraints & CONSTRAINTS_FREEZE_POSITION_Y) && fabsf(normal.y) > 0.01f) ||
+                                          ((a->constraints & CONSTRAINTS_FREEZE_POSITION_Z) && fabsf(normal.z) > 0.01f);
+            invMassA = constrainedAlongNormal ? 0.0f : a->_inv_mass;
+        }
+
+        if (b && !bMovementConstrained) {
+            bool constrainedAlongNormal = ((b->constraints & CONSTRAINTS_FREEZE_POSITION_X) && fabsf(normal.x) > 0.01f) ||
+                                          ((b->constraints & CONSTRAINTS_FREEZE_POSITION_Y) && fabsf(normal.y) > 0.01f) ||
+                                          ((b->constraints & CONSTRAINTS_FREEZE_POSITION_Z) && fabsf(normal.z) > 0.01f);
+            invMassB = constrainedAlongNormal ? 0.0f : b->_inv_mass;
+        }
+
+        bool aRotates = a && a->rotation && !((a->constraints & CONSTRAINTS_FREEZE_ROTATION_ALL) == CONSTRAINTS_FREEZE_ROTATION_ALL);
+        bool bRotates = b && b->rotation && !((b->constraints & CONSTRAINTS_FREEZE_ROTATION_ALL) == CONSTRAINTS_FREEZE_ROTATION_ALL);
+
+        // Angular normal terms per point, kept for the block solver's coupling terms
+        Vector3 rACrossN[MAX_CONTACT_POINTS_PER_PAIR];
+        Vector3 rBCrossN[MAX_CONTACT_POINTS_PER_PAIR];
+        Vector3 torquePerImpulseA[MAX_CONTACT_POINTS_PER_PAIR];
+        Vector3 torquePerImpulseB[MAX_CONTACT_POINTS_PER_PAIR];
 
         // Process each contact point
         for (int p = 0; p < cont_constraint->point_count; p++) {
-            contact_point* cont_point = &cont_constraint->points[p];
+            contact_point_solver* cont_point = &cont_solver->points[p];
+
+            // Calculate rA and rB (contact point relative to center of mass) from the cached local anchors
+            Vector3 contactA, contactB;
+            collide_contact_point_world(cont_constraint, &cont_constraint->points[p], &contactA, &contactB);
 
-            // Calculate rA and rB (contact point relative to center of mass)
             if (a) {
-                vector3Sub(&cont_point->contactA, &centerOfMassA, &cont_point->a_to_contact);
+                vector3Sub(&contactA, &centerOfMassA, &cont_point->a_to_contact);
             } else {
                 cont_point->a_to_contact = gZeroVec;
             }
 
             if (b) {
-                vector3Sub(&cont_point->contactB, &centerOfMassB, &cont_point->b_to_contact);
+                vector3Sub(&contactB, &centerOfMassB, &cont_point->b_to_contact);
             } else {
                 cont_point->b_to_contact = gZeroVec;
             }
 
-            // Calculate effective mass for normal direction
-            bool aMovementConstrained = a && (a->is_kinematic || ((a->constraints & CONSTRAINTS_FREEZE_POSITION_ALL) == CONSTRAINTS_FREEZE_POSITION_ALL));
-            bool bMovementConstrained = b && (b->is_kinematic || ((b->constraints & CONSTRAINTS_FREEZE_POSITION_ALL) == CONSTRAINTS_FREEZE_POSITION_ALL));
-
-            float invMassA = 0.0f;
-            float invMassB = 0.0f;
-
-            if (a && !aMovementConstrained) {
-                bool constrainedAlongNormal = ((a->constraints & CONSTRAINTS_FREEZE_POSITION_X) && fabsf(normal.x) > 0.01f) ||
-                                              ((a->constraints & CONSTRAINTS_FREEZE_POSITION_Y) && fabsf(normal.y) > 0.01f) ||
-                                              ((a->constraints & CONSTRAINTS_FREEZE_POSITION_Z) && fabsf(normal.z) > 0.01f);
-                invMassA = constrainedAlongNormal ? 0.0f : a->_inv_mass;
-            }
-
-            if (b && !bMovementConstrained) {
-                bool constrainedAlongNormal = ((b->constraints & CONSTRAINTS_FREEZE_POSITION_X) && fabsf(normal.x) > 0.01f) ||
-                                              ((b->constraints & CONSTRAINTS_FREEZE_POSITION_Y) && fabsf(normal.y) > 0.01f) ||
-                                              ((b->constraints & CONSTRAINTS_FREEZE_POSITION_Z) && fabsf(normal.z) > 0.01f);
-                invMassB = constrainedAlongNormal ? 0.0f : b->_inv_mass;
+            // a moving mesh instance drags the contact along like a kinematic body
+            cont_point->surface_velocity = gZeroVec;
+            if (cont_constraint->instance) {
+                mesh_instance_point_velocity(cont_constraint->instance, &contactA, &cont_point->surface_velocity);
             }
 
+            // Calculate effective mass for normal direction
             float denominator = invMassA + invMassB;
 
             // Add rotational inertia term for A
-            if (a && a->rotation && !((a->constraints & CONSTRAINTS_FREEZE_ROTATION_ALL) == CONSTRAINTS_FREEZE_ROTATION_ALL)) {
-                Vector3 rCrossN;
-                vector3Cross(&cont_point->a_to_contact, &normal, &rCrossN);
-                Vector3 torquePerImpulse;
-                physics_object_apply_world_inertia(a, &rCrossN, &torquePerImpulse);
-                denominator += vector3Dot(&rCrossN, &torquePerImpulse);
+            rACrossN[p] = gZeroVec;
+            torquePerImpulseA[p] = gZeroVec;
+            if (aRotates) {
+                vector3Cross(&cont_point->a_to_contact, &normal, &rACrossN[p]);
+                physics_object_apply_world_inertia(a, &rACrossN[p], &torquePerImpulseA[p]);
+                denominator += vector3Dot(&rACrossN[p], &torquePerImpulseA[p]);
             }
 
             // Add rotational inertia term for B
-            if (b && b->rotation && !((b->constraints & CONSTRAINTS_FREEZE_ROTATION_ALL) == CONSTRAINTS_FREEZE_ROTATION_ALL)) {
-                Vector3 rCrossN;
-                vector3Cross(&cont_point->b_to_contact, &normal, &rCrossN);
-                Vector3 torquePerImpulse;
-                physics_object_apply_world_inertia(b, &rCrossN, &torquePerImpulse);
-                denominator += vector3Dot(&rCrossN, &torquePerImpulse);
+            rBCrossN[p] = gZeroVec;
+            torquePerImpulseB[p] = gZeroVec;
+            if (bRotates) {
+                vector3Cross(&cont_point->b_to_contact, &normal, &rBCrossN[p]);
+                physics_object_apply_world_inertia(b, &rBCrossN[p], &torquePerImpulseB[p]);
+                denominator += vector3Dot(&rBCrossN[p], &torquePerImpulseB[p]);
             }
 
             if (denominator < EPSILON) denominator = EPSILON;
@@ -595,16 +955,16 @@ static void collision_scene_pre_solve_contacts() {
 
             // Calculate effective mass for tangent U
             float denominator_u = invMassA + invMassB;
-            if (a && a->rotation && !((a->constraints & CONSTRAINTS_FREEZE_ROTATION_ALL) == CONSTRAINTS_FREEZE_ROTATION_ALL)) {
+            if (aRotates) {
                 Vector3 rCrossT;
-                vector3Cross(&cont_point->a_to_contact, &cont_constraint->tangent_u, &rCrossT);
+                vector3Cross(&cont_point->a_to_contact, &cont_solver->tangent_u, &rCrossT);
                 Vector3 torquePerImpulse;
                 physics_object_apply_world_inertia(a, &rCrossT, &torquePerImpulse);
                 denominator_u += vector3Dot(&rCrossT, &torquePerImpulse);
             }
-            if (b && b->rotation && !((b->constraints & CONSTRAINTS_FREEZE_ROTATION_ALL) == CONSTRAINTS_FREEZE_ROTATION_ALL)) {
+            if (bRotates) {
                 Vector3 rCrossT;
-                vector3Cross(&cont_point->b_to_contact, &cont_constraint->tangent_u, &rCrossT);
+                vector3Cross(&cont_point->b_to_contact, &cont_solver->tangent_u, &rCrossT);
                 Vector3 torquePerImpulse;
                 physics_object_apply_world_inertia(b, &rCrossT, &torquePerImpulse);
                 denominator_u += vector3Dot(&rCrossT, &torquePerImpulse);
@@ -614,16 +974,16 @@ static void collision_scene_pre_solve_contacts() {
 
             // Calculate effective mass for tangent V
             float denominator_v = invMassA + invMassB;
-            if (a && a->rotation && !((a->constraints & CONSTRAINTS_FREEZE_ROTATION_ALL) == CONSTRAINTS_FREEZE_ROTATION_ALL)) {
+            if (aRotates) {
                 Vector3 rCrossT;
-                vector3Cross(&cont_point->a_to_contact, &cont_constraint->tangent_v, &rCrossT);
+                vector3Cross(&cont_point->a_to_contact, &cont_solver->tangent_v, &rCrossT);
                 Vector3 torquePerImpulse;
                 physics_object_apply_world_inertia(a, &rCrossT, &torquePerImpulse);
                 denominator_v += vector3Dot(&rCrossT, &torquePerImpulse);
             }
-            if (b && b->rotation && !((b->constraints & CONSTRAINTS_FREEZE_ROTATION_ALL) == CONSTRAINTS_FREEZE_ROTATION_ALL)) {
+            if (bRotates) {
                 Vector3 rCrossT;
-                vector3Cross(&cont_point->b_to_contact, &cont_constraint->tangent_v, &rCrossT);
+                vector3Cross(&cont_point->b_to_contact, &cont_solver->tangent_v, &rCrossT);
                 Vector3 torquePerImpulse;
                 physics_object_apply_world_inertia(b, &rCrossT, &torquePerImpulse);
                 denominator_v += vector3Dot(&rCrossT, &torquePerImpulse);
@@ -632,7 +992,7 @@ static void collision_scene_pre_solve_contacts() {
             cont_point->tangent_mass_v = 1.0f / denominator_v;
 
             // Calculate relative velocity for restitution
-            Vector3 contactVelA = gZeroVec;
+            Vector3 contactVelA = cont_point->surface_velocity;
             Vector3 contactVelB = gZeroVec;
 
             if (a && !a->is_kinematic) {
@@ -657,22 +1017,44 @@ static void collision_scene_pre_solve_contacts() {
             vector3Sub(&contactVelA, &contactVelB, &relVel);
             float normalVelocity = vector3Dot(&relVel, &cont_constraint->normal);
 
-            // Calculate velocity bias (restitution)
+            // Calculate velocity bias (restitution), the separation bias is only used by the TGS solver
+            cont_point->position_bias = 0.0f;
             cont_point->velocity_bias = 0.0f;
             if (normalVelocity < -0.5f) { // Threshold for bouncing
                 cont_point->velocity_bias = cont_constraint->combined_bounce * normalVelocity;
             }
         }
-    }
-}
-
+
+        // Build the coupled normal mass matrix K for the block solver
+        // K[i][j] = 1/mA + 1/mB + (rAi x n) * IA^-1 * (rAj x n) + (rBi x n) * IB^-1 * (rBj x n)
+        cont_constraint->solver_class = collision_scene_classify_constraint(cont_constraint);
+
+        cont_constraint->use_block_solver = false;
+        if (cont_constraint->point_count >= 2) {
+            int n = cont_constraint->point_count;
+            for (int row = 0; row < n; row++) {
+                for (int col = row; col < n; col++) {
+                    float k = invMassA + invMassB +
+                              vector3Dot(&rACrossN[row], &torquePerImpulseA[col]) +
+                              vector3Dot(&rBCrossN[row], &torquePerImpulseB[col]);
+                    cont_solver->normal_block_mass[row][col] = k;
+                    cont_solver->normal_block_mass[col][row] = k;
+                }
+            }
+
+            cont_constraint->use_block_solver = collision_scene_block_is_well_conditioned(cont_constraint, cont_solver);
+        }
+    }
+}
+
 
 /// @brief Warm start: apply accumulated impulses from previous frame
 static void collision_scene_warm_start() {
-    for (int i = 0; i < g_scene.cached_contact_constraint_count; i++) {
+    for (int i = 0; i < g_scene.contact_solver_count; i++) {
         contact_constraint* cc = &g_scene.cached_contact_constraints[i];
+        contact_constraint_solver* cs = &g_scene.contact_solvers[i];
 
-        if (!cc->is_active || cc->is_trigger) continue;
+        if (!cc->is_active) continue;
 
         physics_object* a = cc->objectA;
         physics_object* b = cc->objectB;
@@ -681,6 +1063,7 @@ static void collision_scene_warm_start() {
         for (int p = 0; p < cc->point_count; p++)
         {
             contact_point *cp = &cc->points[p];
+            contact_point_solver *sp = &cs->points[p];
             // Apply accumulated normal impulse
             Vector3 impulse;
             vector3Scale(&cc->normal, &impulse, cp->accumulated_normal_impulse);
@@ -701,7 +1084,7 @@ static void collision_scene_warm_start() {
                 if (a->rotation)
                 {
                     Vector3 angularImpulse;
-                    vector3Cross(&cp->a_to_contact, &impulse, &angularImpulse);
+                    vector3Cross(&sp->a_to_contact, &impulse, &angularImpulse);
                     physics_object_apply_angular_impulse(a, &angularImpulse);
                 }
             }
@@ -722,7 +1105,7 @@ static void collision_scene_warm_start() {
                 if (b->rotation)
                 {
                     Vector3 angularImpulse;
-                    vector3Cross(&cp->b_to_contact, &impulse, &angularImpulse);
+                    vector3Cross(&sp->b_to_contact, &impulse, &angularImpulse);
                     vector3Negate(&angularImpulse, &angularImpulse);
                     physics_object_apply_angular_impulse(b, &angularImpulse);
                 }
@@ -730,10 +1113,10 @@ static void collision_scene_warm_start() {
 
             // Apply accumulated tangent impulses for friction
             Vector3 tangentImpulseU;
-            vector3Scale(&cc->tangent_u, &tangentImpulseU, cp->accumulated_tangent_impulse_u);
+            vector3Scale(&cs->tangent_u, &tangentImpulseU, cp->accumulated_tangent_impulse_u);
 
             Vector3 tangentImpulseV;
-            vector3Scale(&cc->tangent_v, &tangentImpulseV, cp->accumulated_tangent_impulse_v);
+            vector3Scale(&cs->tangent_v, &tangentImpulseV, cp->accumulated_tangent_impulse_v);
 
             // Apply tangent_u to A
             if (a && !a->is_kinematic)
@@ -750,7 +1133,7 @@ static void collision_scene_warm_start() {
                 if (a->rotation)
                 {
                     Vector3 angularTangentU;
-                    vector3Cross(&cp->a_to_contact, &tangentImpulseU, &angularTangentU);
+                    vector3Cross(&sp->a_to_contact, &tangentImpulseU, &angularTangentU);
                     physics_object_apply_angular_impulse(a, &angularTangentU);
                 }
             }
@@ -770,7 +1153,7 @@ static void collision_scene_warm_start() {
                 if (b->rotation)
                 {
                     Vector3 angularTangentU;
-                    vector3Cross(&cp->b_to_contact, &tangentImpulseU, &angularTangentU);
+                    vector3Cross(&sp->b_to_contact, &tangentImpulseU, &angularTangentU);
                     vector3Negate(&angularTangentU, &angularTangentU);
                     physics_object_apply_angular_impulse(b, &angularTangentU);
                 }
@@ -791,7 +1174,7 @@ static void collision_scene_warm_start() {
                 if (a->rotation)
                 {
                     Vector3 angularTangentV;
-                    vector3Cross(&cp->a_to_contact, &tangentImpulseV, &angularTangentV);
+                    vector3Cross(&sp->a_to_contact, &tangentImpulseV, &angularTangentV);
                     physics_object_apply_angular_impulse(a, &angularTangentV);
                 }
             }
@@ -811,7 +1194,7 @@ static void collision_scene_warm_start() {
                 if (b->rotation)
                 {
                     Vector3 angularTangentV;
-                    vector3Cross(&cp->b_to_contact, &tangentImpulseV, &angularTangentV);
+                    vector3Cross(&sp->b_to_contact, &tangentImpulseV, &angularTangentV);
                     vector3Negate(&angularTangentV, &angularTangentV);
                     physics_object_apply_angular_impulse(b, &angularTangentV);
                 }
@@ -820,312 +1203,364 @@ static void collision_scene_warm_start() {
     }
 }
 
-/// @brief Solve velocity constraints iteratively
-static void collision_scene_solve_velocity_constraints()
+/// @brief Velocity of one side of a contact at its contact point
+/// @param static_velocity the velocity of a side the solver does not move, the surface velocity of a mesh instance
+SOLVER_KERNEL void collision_scene_side_contact_velocity(physics_object* obj, const Vector3* r, const int mode, const Vector3* static_velocity, Vector3* out)
 {
-    for (int i = 0; i < g_scene.cached_contact_constraint_count; i++)
+    if (mode == SOLVER_SIDE_STATIC || (mode == SOLVER_SIDE_GENERIC && (!obj || obj->is_kinematic)))
     {
-        contact_constraint *cc = &g_scene.cached_contact_constraints[i];
+        *out = *static_velocity;
+        return;
+    }
 
-        if (!cc->is_active || cc->is_trigger)
-            continue;
+    *out = obj->velocity;
+    if (mode == SOLVER_SIDE_FULL || (mode == SOLVER_SIDE_GENERIC && obj->rotation))
+    {
+        Vector3 angularContribution;
+        vector3Cross(&obj->angular_velocity, r, &angularContribution);
+        vector3Add(out, &angularContribution, out);
+    }
+}
 
-        physics_object *a = cc->objectA;
-        physics_object *b = cc->objectB;
+/// @brief Applies a velocity impulse to one side of a contact (sign is 1 for A and -1 for B)
+SOLVER_KERNEL void collision_scene_side_apply_impulse(physics_object* obj, const Vector3* r, const Vector3* impulse, const float sign, const int mode)
+{
+    if (mode == SOLVER_SIDE_STATIC || (mode == SOLVER_SIDE_GENERIC && (!obj || obj->is_kinematic)))
+        return;
 
-        // Process each contact point
-        for (int p = 0; p < cc->point_count; p++)
-        {
-            contact_point *cp = &cc->points[p];
+    Vector3 linearImpulse;
+    vector3Scale(impulse, &linearImpulse, sign * obj->_inv_mass);
 
-            // Calculate contact velocities
-            Vector3 contactVelA = gZeroVec;
-            Vector3 contactVelB = gZeroVec;
+    if (mode == SOLVER_SIDE_GENERIC)
+    {
+        if (!(obj->constraints & CONSTRAINTS_FREEZE_POSITION_X))
+            obj->velocity.x += linearImpulse.x;
+        if (!(obj->constraints & CONSTRAINTS_FREEZE_POSITION_Y))
+            obj->velocity.y += linearImpulse.y;
+        if (!(obj->constraints & CONSTRAINTS_FREEZE_POSITION_Z))
+            obj->velocity.z += linearImpulse.z;
+    }
+    else
+    {
+        vector3Add(&obj->velocity, &linearImpulse, &obj->velocity);
+    }
 
-            if (a && !a->is_kinematic)
-            {
-                contactVelA = a->velocity;
-                if (a->rotation)
-                {
-                    Vector3 angularContribution;
-                    vector3Cross(&a->angular_velocity, &cp->a_to_contact, &angularContribution);
-                    vector3Add(&contactVelA, &angularContribution, &contactVelA);
-                }
-            }
+    // _inv_world_inertia_tensor already accounts for frozen rotation axes
+    if (mode == SOLVER_SIDE_FULL || (mode == SOLVER_SIDE_GENERIC && obj->rotation))
+    {
+        Vector3 angularImpulse;
+        vector3Cross(r, impulse, &angularImpulse);
+        vector3Scale(&angularImpulse, &angularImpulse, sign);
 
-            if (b && !b->is_kinematic)
-            {
-                contactVelB = b->velocity;
-                if (b->rotation)
-                {
-                    Vector3 angularContribution;
-                    vector3Cross(&b->angular_velocity, &cp->b_to_contact, &angularContribution);
-                    vector3Add(&contactVelB, &angularContribution, &contactVelB);
-                }
-            }
+        Vector3 deltaOmega;
+        physics_object_apply_world_inertia(obj, &angularImpulse, &deltaOmega);
+        vector3Add(&obj->angular_velocity, &deltaOmega, &obj->angular_velocity);
+    }
+}
 
-            // Calculate relative velocity
-            Vector3 relVel;
-            vector3Sub(&contactVelA, &contactVelB, &relVel);
-            float normalVelocity = vector3Dot(&relVel, &cc->normal);
+/// @brief Calculates the relative velocity of A with respect to B at a contact point
+SOLVER_KERNEL void collision_scene_contact_relative_velocity(contact_constraint* cc, const contact_point_solver* sp, const int mode_a, const int mode_b, Vector3* relVel)
+{
+    Vector3 contactVelA;
+    Vector3 contactVelB;
+    // mesh instances are always side A
+    collision_scene_side_contact_velocity(cc->objectA, &sp->a_to_contact, mode_a, &sp->surface_velocity, &contactVelA);
+    collision_scene_side_contact_velocity(cc->objectB, &sp->b_to_contact, mode_b, &gZeroVec, &contactVelB);
+    vector3Sub(&contactVelA, &contactVelB, relVel);
+}
 
-            // Calculate lambda (impulse change)
-            // Use pre-calculated velocity bias (restitution)
-            float lambda = -(normalVelocity + cp->velocity_bias) * cp->normal_mass;
+/// @brief Applies an impulse along a direction at a contact point to both objects
+SOLVER_KERNEL void collision_scene_apply_contact_impulse(contact_constraint* cc, const contact_point_solver* sp, const Vector3* direction, float lambda, const int mode_a, const int mode_b)
+{
+    Vector3 impulse;
+    vector3Scale(direction, &impulse, lambda);
 
-            // Clamp accumulated impulse (key difference from old approach!)
-            float oldImpulse = cp->accumulated_normal_impulse;
-            cp->accumulated_normal_impulse = maxf(oldImpulse + lambda, 0.0f);
-            lambda = cp->accumulated_normal_impulse - oldImpulse;
+    collision_scene_side_apply_impulse(cc->objectA, &sp->a_to_contact, &impulse, 1.0f, mode_a);
+    collision_scene_side_apply_impulse(cc->objectB, &sp->b_to_contact, &impulse, -1.0f, mode_b);
+}
 
-            if (fabsf(lambda) < EPSILON)
-                continue;
+/// @brief Solves the normal constraint of a single contact point (sequential impulses)
+/// @return false if the impulse did not change
+SOLVER_KERNEL bool collision_scene_solve_normal_point(contact_constraint* cc, contact_point* cp, const contact_point_solver* sp, const int mode_a, const int mode_b)
+{
+    // Calculate relative velocity
+    Vector3 relVel;
+    collision_scene_contact_relative_velocity(cc, sp, mode_a, mode_b, &relVel);
+    float normalVelocity = vector3Dot(&relVel, &cc->normal);
+
+    // Calculate lambda (impulse change)
+    // Use pre-calculated velocity bias (restitution)
+    float lambda = -(normalVelocity + sp->velocity_bias - sp->position_bias) * sp->normal_mass;
+
+    // Clamp accumulated impulse (key difference from old approach!)
+    float oldImpulse = cp->accumulated_normal_impulse;
+    cp->accumulated_normal_impulse = maxf(oldImpulse + lambda, 0.0f);
+    lambda = cp->accumulated_normal_impulse - oldImpulse;
+
+    if (fabsf(lambda) < EPSILON)
+        return false;
+
+    // Apply lambda (the change, not total)
+    collision_scene_apply_contact_impulse(cc, sp, &cc->normal, lambda, mode_a, mode_b);
+    return true;
+}
 
-            // Apply lambda (the change, not total)
-            Vector3 impulse;
-            vector3Scale(&cc->normal, &impulse, lambda);
+/// @brief Solves the normal impulses of all points of a manifold simultaneously.
+///
+/// Finds the total impulses x with K * x + b = vn, x >= 0, vn >= 0 and x * vn = 0 (a mixed LCP) by direct
+/// enumeration of the active point sets. K is the normal block mass matrix from pre-solve and
+/// b = vn_current + bias - K * x_accumulated. With at most 4 points this is at most 16 small solves,
+/// the full active set is tried first as it is by far the most common case for resting boxes.
+/// @return false if no set satisfies the conditions (numerical issues), the caller falls back to sequential impulses
+SOLVER_KERNEL bool collision_scene_solve_normal_block(contact_constraint* cc, const contact_constraint_solver* cs, const int mode_a, const int mode_b)
+{
+    int n = cc->point_count;
+    float rhs[MAX_CONTACT_POINTS_PER_PAIR];
 
-            // Apply to object A
-            if (a && !a->is_kinematic)
-            {
-                Vector3 linearImpulse;
-                vector3Scale(&impulse, &linearImpulse, a->_inv_mass);
+    for (int i = 0; i < n; i++)
+    {
+        const contact_point_solver* sp = &cs->points[i];
+        Vector3 relVel;
+        collision_scene_contact_relative_velocity(cc, sp, mode_a, mode_b, &relVel);
+        rhs[i] = vector3Dot(&relVel, &cc->normal) + sp->velocity_bias - sp->position_bias;
 
-                if (!(a->constraints & CONSTRAINTS_FREEZE_POSITION_X))
-                    a->velocity.x += linearImpulse.x;
-                if (!(a->constraints & CONSTRAINTS_FREEZE_POSITION_Y))
-                    a->velocity.y += linearImpulse.y;
-                if (!(a->constraints & CONSTRAINTS_FREEZE_POSITION_Z))
-                    a->velocity.z += linearImpulse.z;
+        for (int j = 0; j < n; j++)
+        {
+            rhs[i] -= cs->normal_block_mass[i][j] * cc->points[j].accumulated_normal_impulse;
+        }
+    }
 
-                if (a->rotation)
-                {
-                    Vector3 angularImpulse;
-                    vector3Cross(&cp->a_to_contact, &impulse, &angularImpulse);
-                    
-                    Vector3 deltaOmega;
-                    physics_object_apply_world_inertia(a, &angularImpulse, &deltaOmega);
-                    vector3Add(&a->angular_velocity, &deltaOmega, &a->angular_velocity);
-                }
-            }
+    for (int active_mask = (1 << n) - 1; active_mask >= 0; active_mask--)
+    {
+        // Gather the sub system of the active points
+        int active_indices[MAX_CONTACT_POINTS_PER_PAIR];
+        int active_count = 0;
+        for (int i = 0; i < n; i++)
+        {
+            if (active_mask & (1 << i)) active_indices[active_count++] = i;
+        }
 
-            // Apply to object B
-            if (b && !b->is_kinematic)
+        float m[MAX_CONTACT_POINTS_PER_PAIR][MAX_CONTACT_POINTS_PER_PAIR];
+        float x_active[MAX_CONTACT_POINTS_PER_PAIR];
+        for (int row = 0; row < active_count; row++)
+        {
+            for (int col = 0; col < active_count; col++)
             {
-                Vector3 linearImpulse;
-                vector3Scale(&impulse, &linearImpulse, -b->_inv_mass);
+                m[row][col] = cs->normal_block_mass[active_indices[row]][active_indices[col]];
+            }
+            x_active[row] = -rhs[active_indices[row]];
+        }
 
-                if (!(b->constraints & CONSTRAINTS_FREEZE_POSITION_X))
-                    b->velocity.x += linearImpulse.x;
-                if (!(b->constraints & CONSTRAINTS_FREEZE_POSITION_Y))
-                    b->velocity.y += linearImpulse.y;
-                if (!(b->constraints & CONSTRAINTS_FREEZE_POSITION_Z))
-                    b->velocity.z += linearImpulse.z;
+        if (active_count > 0 && !collision_scene_solve_block_system(m, x_active, active_count))
+            continue;
 
-                if (b->rotation)
-                {
-                    Vector3 angularImpulse;
-                    vector3Cross(&cp->b_to_contact, &impulse, &angularImpulse);
-                    vector3Negate(&angularImpulse, &angularImpulse);
-                    
-                    Vector3 deltaOmega;
-                    physics_object_apply_world_inertia(b, &angularImpulse, &deltaOmega);
-                    vector3Add(&b->angular_velocity, &deltaOmega, &b->angular_velocity);
-                }
+        // Active impulses must be pushing
+        float x[MAX_CONTACT_POINTS_PER_PAIR] = {0};
+        bool valid = true;
+        for (int k = 0; k < active_count; k++)
+        {
+            if (x_active[k] < 0.0f)
+            {
+                valid = false;
+                break;
             }
-#ifndef DEBUG_IGNORE_FRICTION
-            // Handle friction with proper accumulation
-            if (cc->combined_friction > 0.0f)
+            x[active_indices[k]] = x_active[k];
+        }
+        if (!valid)
+            continue;
+
+        // Inactive points must be separating
+        for (int i = 0; i < n && valid; i++)
+        {
+            if (active_mask & (1 << i))
+                continue;
+
+            float vn = rhs[i];
+            for (int j = 0; j < n; j++)
             {
-                // Recalculate relative velocity after normal impulse
-                if (a && !a->is_kinematic)
-                {
-                    contactVelA = a->velocity;
-                    if (a->rotation)
-                    {
-                        Vector3 angularContribution;
-                        vector3Cross(&a->angular_velocity, &cp->a_to_contact, &angularContribution);
-                        vector3Add(&contactVelA, &angularContribution, &contactVelA);
-                    }
-                }
+                vn += cs->normal_block_mass[i][j] * x[j];
+            }
+            valid = vn >= -CONTACT_BLOCK_SOLVER_TOLERANCE;
+        }
+        if (!valid)
+            continue;
 
-                if (b && !b->is_kinematic)
-                {
-                    contactVelB = b->velocity;
-                    if (b->rotation)
-                    {
-                        Vector3 angularContribution;
-                        vector3Cross(&b->angular_velocity, &cp->b_to_contact, &angularContribution);
-                        vector3Add(&contactVelB, &angularContribution, &contactVelB);
-                    }
-                }
+        // Apply the change of the accumulated impulses
+        for (int i = 0; i < n; i++)
+        {
+            contact_point* cp = &cc->points[i];
+            float lambda = x[i] - cp->accumulated_normal_impulse;
+            cp->accumulated_normal_impulse = x[i];
 
-                vector3Sub(&contactVelA, &contactVelB, &relVel);
+            if (fabsf(lambda) >= EPSILON)
+            {
+                collision_scene_apply_contact_impulse(cc, &cs->points[i], &cc->normal, lambda, mode_a, mode_b);
+            }
+        }
 
-                // Calculate tangential velocity components along tangent_u and tangent_v
-                float vTangentU = vector3Dot(&relVel, &cc->tangent_u);
-                float vTangentV = vector3Dot(&relVel, &cc->tangent_v);
+        return true;
+    }
 
-                // Calculate friction impulse changes (lambda) for both tangent directions
-                float lambdaU = -vTangentU * cp->tangent_mass_u;
-                float lambdaV = -vTangentV * cp->tangent_mass_v;
+    return false;
+}
 
-                // Calculate new accumulated tangent impulses
-                float newAccumU = cp->accumulated_tangent_impulse_u + lambdaU;
-                float newAccumV = cp->accumulated_tangent_impulse_v + lambdaV;
+#ifndef DEBUG_IGNORE_FRICTION
+/// @brief Solves the friction constraint of a single contact point, clamped to the friction cone of its normal impulse
+SOLVER_KERNEL void collision_scene_solve_friction_point(contact_constraint* cc, const contact_constraint_solver* cs, contact_point* cp, const contact_point_solver* sp, const int mode_a, const int mode_b)
+{
+    // Recalculate relative velocity after normal impulse
+    Vector3 relVel;
+    collision_scene_contact_relative_velocity(cc, sp, mode_a, mode_b, &relVel);
 
-                // Clamp to friction cone (Coulomb's law: |tangent_impulse| <= friction * normal_impulse)
-                float maxFriction = cc->combined_friction * cp->accumulated_normal_impulse;
-                float tangentMagnitude = sqrtf(newAccumU * newAccumU + newAccumV * newAccumV);
+    // Calculate tangential velocity components along tangent_u and tangent_v
+    float vTangentU = vector3Dot(&relVel, &cs->tangent_u);
+    float vTangentV = vector3Dot(&relVel, &cs->tangent_v);
 
-                if (tangentMagnitude > maxFriction)
-                {
-                    float scale = maxFriction / tangentMagnitude;
-                    newAccumU *= scale;
-                    newAccumV *= scale;
-                }
+    // Calculate friction impulse changes (lambda) for both tangent directions
+    float lambdaU = -vTangentU * sp->tangent_mass_u;
+    float lambdaV = -vTangentV * sp->tangent_mass_v;
 
-                // Calculate actual impulse deltas to apply
-                lambdaU = newAccumU - cp->accumulated_tangent_impulse_u;
-                lambdaV = newAccumV - cp->accumulated_tangent_impulse_v;
+    // Calculate new accumulated tangent impulses
+    float newAccumU = cp->accumulated_tangent_impulse_u + lambdaU;
+    float newAccumV = cp->accumulated_tangent_impulse_v + lambdaV;
 
-                // Update accumulated values
-                cp->accumulated_tangent_impulse_u = newAccumU;
-                cp->accumulated_tangent_impulse_v = newAccumV;
+    // Clamp to friction cone (Coulomb's law: |tangent_impulse| <= friction * normal_impulse)
+    float maxFriction = cc->combined_friction * cp->accumulated_normal_impulse;
+    float tangentMagnitude = sqrtf(newAccumU * newAccumU + newAccumV * newAccumV);
 
-                // Apply tangent_u impulse
-                if (fabsf(lambdaU) > EPSILON)
-                {
-                    Vector3 tangentImpulseU;
-                    vector3Scale(&cc->tangent_u, &tangentImpulseU, lambdaU);
+    if (tangentMagnitude > maxFriction)
+    {
+        float scale = maxFriction / tangentMagnitude;
+        newAccumU *= scale;
+        newAccumV *= scale;
+    }
 
-                    if (a && !a->is_kinematic)
-                    {
-                        Vector3 linearImpulse;
-                        vector3Scale(&tangentImpulseU, &linearImpulse, a->_inv_mass);
-                        if (!(a->constraints & CONSTRAINTS_FREEZE_POSITION_X))
-                            a->velocity.x += linearImpulse.x;
-                        if (!(a->constraints & CONSTRAINTS_FREEZE_POSITION_Y))
-                            a->velocity.y += linearImpulse.y;
-                        if (!(a->constraints & CONSTRAINTS_FREEZE_POSITION_Z))
-                            a->velocity.z += linearImpulse.z;
-
-                        if (a->rotation)
-                        {
-                            Vector3 angularImpulse;
-                            vector3Cross(&cp->a_to_contact, &tangentImpulseU, &angularImpulse);
-                            physics_object_apply_angular_impulse(a, &angularImpulse);
-                        }
-                    }
+    // Calculate actual impulse deltas to apply
+    lambdaU = newAccumU - cp->accumulated_tangent_impulse_u;
+    lambdaV = newAccumV - cp->accumulated_tangent_impulse_v;
 
-                    if (b && !b->is_kinematic)
-                    {
-                        Vector3 linearImpulse;
-                        vector3Scale(&tangentImpulseU, &linearImpulse, -b->_inv_mass);
-                        if (!(b->constraints & CONSTRAINTS_FREEZE_POSITION_X))
-                            b->velocity.x += linearImpulse.x;
-                        if (!(b->constraints & CONSTRAINTS_FREEZE_POSITION_Y))
-                            b->velocity.y += linearImpulse.y;
-                        if (!(b->constraints & CONSTRAINTS_FREEZE_POSITION_Z))
-                            b->velocity.z += linearImpulse.z;
-
-                        if (b->rotation)
-                        {
-                            Vector3 angularImpulse;
-                            vector3Cross(&cp->b_to_contact, &tangentImpulseU, &angularImpulse);
-                            vector3Negate(&angularImpulse, &angularImpulse);
-                            physics_object_apply_angular_impulse(b, &angularImpulse);
-                        }
-                    }
-                }
+    // Update accumulated values
+    cp->accumulated_tangent_impulse_u = newAccumU;
+    cp->accumulated_tangent_impulse_v = newAccumV;
 
-                // Apply tangent_v impulse
-                if (fabsf(lambdaV) > EPSILON)
-                {
-                    Vector3 tangentImpulseV;
-                    vector3Scale(&cc->tangent_v, &tangentImpulseV, lambdaV);
+    // Apply tangent impulses
+    if (fabsf(lambdaU) > EPSILON)
+    {
+        collision_scene_apply_contact_impulse(cc, sp, &cs->tangent_u, lambdaU, mode_a, mode_b);
+    }
 
-                    if (a && !a->is_kinematic)
-                    {
-                        Vector3 linearImpulse;
-                        vector3Scale(&tangentImpulseV, &linearImpulse, a->_inv_mass);
-                        if (!(a->constraints & CONSTRAINTS_FREEZE_POSITION_X))
-                            a->velocity.x += linearImpulse.x;
-                        if (!(a->constraints & CONSTRAINTS_FREEZE_POSITION_Y))
-                            a->velocity.y += linearImpulse.y;
-                        if (!(a->constraints & CONSTRAINTS_FREEZE_POSITION_Z))
-                            a->velocity.z += linearImpulse.z;
-
-                        if (a->rotation)
-                        {
-                            Vector3 angularImpulse;
-                            vector3Cross(&cp->a_to_contact, &tangentImpulseV, &angularImpulse);
-                            physics_object_apply_angular_impulse(a, &angularImpulse);
-                        }
-                    }
+    if (fabsf(lambdaV) > EPSILON)
+    {
+        collision_scene_apply_contact_impulse(cc, sp, &cs->tangent_v, lambdaV, mode_a, mode_b);
+    }
+}
+#endif
 
-                    if (b && !b->is_kinematic)
-                    {
-                        Vector3 linearImpulse;
-                        vector3Scale(&tangentImpulseV, &linearImpulse, -b->_inv_mass);
-                        if (!(b->constraints & CONSTRAINTS_FREEZE_POSITION_X))
-                            b->velocity.x += linearImpulse.x;
-                        if (!(b->constraints & CONSTRAINTS_FREEZE_POSITION_Y))
-                            b->velocity.y += linearImpulse.y;
-                        if (!(b->constraints & CONSTRAINTS_FREEZE_POSITION_Z))
-                            b->velocity.z += linearImpulse.z;
-
-                        if (b->rotation)
-                        {
-                            Vector3 angularImpulse;
-                            vector3Cross(&cp->b_to_contact, &tangentImpulseV, &angularImpulse);
-                            vector3Negate(&angularImpulse, &angularImpulse);
-                            physics_object_apply_angular_impulse(b, &angularImpulse);
-                        }
-                    }
-                }
+/// @brief Velocity solver kernel for a single constraint
+SOLVER_KERNEL void collision_scene_solve_velocity_constraint(contact_constraint* cc, const contact_constraint_solver* cs, const int mode_a, const int mode_b)
+{
+    // Multi-point manifolds solve their normal impulses together, friction is still solved per point
+    if (cc->use_block_solver && collision_scene_solve_normal_block(cc, cs, mode_a, mode_b))
+    {
+#ifndef DEBUG_IGNORE_FRICTION
+        if (cc->combined_friction > 0.0f)
+        {
+            for (int p = 0; p < cc->point_count; p++)
+            {
+                collision_scene_solve_friction_point(cc, cs, &cc->points[p], &cs->points[p], mode_a, mode_b);
             }
+        }
 #endif
+        return;
+    }
+
+    // Process each contact point
+    for (int p = 0; p < cc->point_count; p++)
+    {
+        contact_point *cp = &cc->points[p];
+        const contact_point_solver *sp = &cs->points[p];
+
+        if (!collision_scene_solve_normal_point(cc, cp, sp, mode_a, mode_b))
+            continue;
+#ifndef DEBUG_IGNORE_FRICTION
+        // Handle friction with proper accumulation
+        if (cc->combined_friction > 0.0f)
+        {
+            collision_scene_solve_friction_point(cc, cs, cp, sp, mode_a, mode_b);
         }
+#endif
     }
 }
 
-/// @brief Solve position constraints iteratively
-static void collision_scene_solve_position_constraints() {
+/// @brief Solve velocity constraints iteratively
+static void collision_scene_solve_velocity_constraints()
+{
+    for (int i = 0; i < g_scene.contact_solver_count; i++)
+    {
+        contact_constraint *cc = &g_scene.cached_contact_constraints[i];
+        const contact_constraint_solver *cs = &g_scene.contact_solvers[i];
+
+        if (!cc->is_active)
+            continue;
+
+        // Dispatch to the kernel specialized for the constraint's body-type class
+        switch (cc->solver_class)
+        {
+        case CONTACT_SOLVER_CLASS_STATIC_DYNAMIC:
+            collision_scene_solve_velocity_constraint(cc, cs, SOLVER_SIDE_STATIC, SOLVER_SIDE_FULL);
+            break;
+        case CONTACT_SOLVER_CLASS_ROTATION_LOCKED:
+            collision_scene_solve_velocity_constraint(cc, cs, SOLVER_SIDE_STATIC, SOLVER_SIDE_LINEAR);
+            break;
+        case CONTACT_SOLVER_CLASS_DYNAMIC_DYNAMIC:
+            collision_scene_solve_velocity_constraint(cc, cs, SOLVER_SIDE_FULL, SOLVER_SIDE_FULL);
+            break;
+        default:
+            collision_scene_solve_velocity_constraint(cc, cs, SOLVER_SIDE_GENERIC, SOLVER_SIDE_GENERIC);
+            break;
+        }
+    }
+}
+
+/// @brief Position solver kernel for a single constraint
+SOLVER_KERNEL void collision_scene_solve_position_constraint(contact_constraint* cc, const contact_constraint_solver* cs, const int mode_a, const int mode_b) {
     const float slop = 0.01f;
     const float steeringConstant = 0.3f;
     const float maxCorrection = 0.04f;
 
-    for (int i = 0; i < g_scene.cached_contact_constraint_count; i++) {
-        contact_constraint* cc = &g_scene.cached_contact_constraints[i];
-
-        if (!cc->is_active || cc->is_trigger) continue;
-        
-
-        physics_object* a = cc->objectA;
-        physics_object* b = cc->objectB;
+    physics_object* a = cc->objectA;
+    physics_object* b = cc->objectB;
 
-        // Process each contact point
-        for (int p = 0; p < cc->point_count; p++)
-        {
-            contact_point *cp = &cc->points[p];
-            if (cp->penetration < slop)
-                continue;
+    const bool aMoves = mode_a == SOLVER_SIDE_LINEAR || mode_a == SOLVER_SIDE_FULL ||
+                        (mode_a == SOLVER_SIDE_GENERIC && a && !(a->is_kinematic || ((a->constraints & CONSTRAINTS_FREEZE_POSITION_ALL) == CONSTRAINTS_FREEZE_POSITION_ALL)));
+    const bool bMoves = mode_b == SOLVER_SIDE_LINEAR || mode_b == SOLVER_SIDE_FULL ||
+                        (mode_b == SOLVER_SIDE_GENERIC && b && !(b->is_kinematic || ((b->constraints & CONSTRAINTS_FREEZE_POSITION_ALL) == CONSTRAINTS_FREEZE_POSITION_ALL)));
+    const bool aRotates = mode_a == SOLVER_SIDE_FULL ||
+                          (mode_a == SOLVER_SIDE_GENERIC && a && a->rotation && !((a->constraints & CONSTRAINTS_FREEZE_ROTATION_ALL) == CONSTRAINTS_FREEZE_ROTATION_ALL));
+    const bool bRotates = mode_b == SOLVER_SIDE_FULL ||
+                          (mode_b == SOLVER_SIDE_GENERIC && b && b->rotation && !((b->constraints & CONSTRAINTS_FREEZE_ROTATION_ALL) == CONSTRAINTS_FREEZE_ROTATION_ALL));
 
-            const float steeringForce = clampf(steeringConstant * (cp->penetration - slop), 0, maxCorrection);
+    // Process each contact point
+    for (int p = 0; p < cc->point_count; p++)
+    {
+        contact_point *cp = &cc->points[p];
+        const contact_point_solver *sp = &cs->points[p];
+        if (cp->penetration < slop)
+            continue;
 
-            bool aMovementConstrained = a && (a->is_kinematic || ((a->constraints & CONSTRAINTS_FREEZE_POSITION_ALL) == CONSTRAINTS_FREEZE_POSITION_ALL));
-            bool bMovementConstrained = b && (b->is_kinematic || ((b->constraints & CONSTRAINTS_FREEZE_POSITION_ALL) == CONSTRAINTS_FREEZE_POSITION_ALL));
+        const float steeringForce = clampf(steeringConstant * (cp->penetration - slop), 0, maxCorrection);
 
-            float invMassA = 0.0f;
-            float invMassB = 0.0f;
+        float invMassA = 0.0f;
+        float invMassB = 0.0f;
 
-            Vector3 effectiveNormalA = cc->normal;
-            Vector3 effectiveNormalB = cc->normal;
+        Vector3 effectiveNormalA = cc->normal;
+        Vector3 effectiveNormalB = cc->normal;
 
-            float normal_dot_inv = 1.0f / vector3Dot(&cc->normal, &cc->normal);
+        float normal_dot_inv = 1.0f / vector3Dot(&cc->normal, &cc->normal);
 
-            if (a && !aMovementConstrained)
+        if (aMoves)
+        {
+            if (mode_a == SOLVER_SIDE_GENERIC)
             {
                 if (a->constraints & CONSTRAINTS_FREEZE_POSITION_X)
                     effectiveNormalA.x = 0.0f;
@@ -1133,12 +1568,15 @@ static void collision_scene_solve_position_constraints() {
                     effectiveNormalA.y = 0.0f;
                 if (a->constraints & CONSTRAINTS_FREEZE_POSITION_Z)
                     effectiveNormalA.z = 0.0f;
-
-                float normalDotA = vector3Dot(&effectiveNormalA, &cc->normal);
-                invMassA = a->_inv_mass * (normalDotA * normalDotA) * normal_dot_inv;
             }
 
-            if (b && !bMovementConstrained)
+            float normalDotA = vector3Dot(&effectiveNormalA, &cc->normal);
+            invMassA = a->_inv_mass * (normalDotA * normalDotA) * normal_dot_inv;
+        }
+
+        if (bMoves)
+        {
+            if (mode_b == SOLVER_SIDE_GENERIC)
             {
                 if (b->constraints & CONSTRAINTS_FREEZE_POSITION_X)
                     effectiveNormalB.x = 0.0f;
@@ -1146,75 +1584,187 @@ static void collision_scene_solve_position_constraints() {
                     effectiveNormalB.y = 0.0f;
                 if (b->constraints & CONSTRAINTS_FREEZE_POSITION_Z)
                     effectiveNormalB.z = 0.0f;
-
-                float normalDotB = vector3Dot(&effectiveNormalB, &cc->normal);
-                invMassB = b->_inv_mass * (normalDotB * normalDotB) * normal_dot_inv;
             }
 
-            float invMassSum = invMassA + invMassB;
+            float normalDotB = vector3Dot(&effectiveNormalB, &cc->normal);
+            invMassB = b->_inv_mass * (normalDotB * normalDotB) * normal_dot_inv;
+        }
 
-            // Add rotational inertia term for A
-            if (a && a->rotation && !((a->constraints & CONSTRAINTS_FREEZE_ROTATION_ALL) == CONSTRAINTS_FREEZE_ROTATION_ALL)) {
-                Vector3 rCrossN;
-                vector3Cross(&cp->a_to_contact, &cc->normal, &rCrossN);
+        float invMassSum = invMassA + invMassB;
 
-                Vector3 torquePerImpulse;
-                physics_object_apply_world_inertia(a, &rCrossN, &torquePerImpulse);
+        // Add rotational inertia term for A
+        if (aRotates) {
+            Vector3 rCrossN;
+            vector3Cross(&sp->a_to_contact, &cc->normal, &rCrossN);
 
-                invMassSum += vector3Dot(&rCrossN, &torquePerImpulse);
-            }
+            Vector3 torquePerImpulse;
+            physics_object_apply_world_inertia(a, &rCrossN, &torquePerImpulse);
 
-            // Add rotational inertia term for B
-            if (b && b->rotation && !((b->constraints & CONSTRAINTS_FREEZE_ROTATION_ALL) == CONSTRAINTS_FREEZE_ROTATION_ALL)) {
-                Vector3 rCrossN;
-                vector3Cross(&cp->b_to_contact, &cc->normal, &rCrossN);
+            invMassSum += vector3Dot(&rCrossN, &torquePerImpulse);
+        }
 
-                Vector3 torquePerImpulse;
-                physics_object_apply_world_inertia(b, &rCrossN, &torquePerImpulse);
+        // Add rotational inertia term for B
+        if (bRotates) {
+            Vector3 rCrossN;
+            vector3Cross(&sp->b_to_contact, &cc->normal, &rCrossN);
+
+            Vector3 torquePerImpulse;
+            physics_object_apply_world_inertia(b, &rCrossN, &torquePerImpulse);
+
+            invMassSum += vector3Dot(&rCrossN, &torquePerImpulse);
+        }
+
+        if (invMassSum == 0.0f)
+            continue;
 
-                invMassSum += vector3Dot(&rCrossN, &torquePerImpulse);
+        float correctionMag = steeringForce / invMassSum;
+        Vector3 impulse;
+        vector3Scale(&cc->normal, &impulse, correctionMag);
+
+        // Apply correction
+        if (aMoves)
+        {
+            if (invMassA > 0.0f) {
+                vector3AddScaled(a->position, &effectiveNormalA, correctionMag * invMassA, a->position);
             }
+            
+            if (aRotates) {
+                Vector3 angularImpulse;
+                vector3Cross(&sp->a_to_contact, &impulse, &angularImpulse);
+                physics_object_apply_angular_impulse_to_rotation(a, &angularImpulse);
+            }
+        }
 
-            if (invMassSum == 0.0f)
-                continue;
+        if (bMoves)
+        {
+            if (invMassB > 0.0f) {
+                vector3AddScaled(b->position, &effectiveNormalB, -correctionMag * invMassB, b->position);
+            }
 
-            float correctionMag = steeringForce / invMassSum;
-            Vector3 impulse;
-            vector3Scale(&cc->normal, &impulse, correctionMag);
+            if (bRotates) {
+                Vector3 angularImpulse;
+                vector3Cross(&sp->b_to_contact, &impulse, &angularImpulse);
+                vector3Negate(&angularImpulse, &angularImpulse);
+                physics_object_apply_angular_impulse_to_rotation(b, &angularImpulse);
+            }
+        }
 
-            // Apply correction
-            if (a && !aMovementConstrained)
-            {
-                if (invMassA > 0.0f) {
-                    vector3AddScaled(a->position, &effectiveNormalA, correctionMag * invMassA, a->position);
-                }
-                
-                if (a->rotation && !((a->constraints & CONSTRAINTS_FREEZE_ROTATION_ALL) == CONSTRAINTS_FREEZE_ROTATION_ALL)) {
-                    Vector3 angularImpulse;
-                    vector3Cross(&cp->a_to_contact, &impulse, &angularImpulse);
-                    physics_object_apply_angular_impulse_to_rotation(a, &angularImpulse);
-                }
+        cp->penetration -= steeringForce;
+    }
+}
+
+/// @brief Solve position constraints iteratively
+static void collision_scene_solve_position_constraints() {
+    for (int i = 0; i < g_scene.contact_solver_count; i++) {
+        contact_constraint* cc = &g_scene.cached_contact_constraints[i];
+        const contact_constraint_solver* cs = &g_scene.contact_solvers[i];
+
+        if (!cc->is_active) continue;
+
+        // Dispatch to the kernel specialized for the constraint's body-type class
+        switch (cc->solver_class) {
+        case CONTACT_SOLVER_CLASS_STATIC_DYNAMIC:
+            collision_scene_solve_position_constraint(cc, cs, SOLVER_SIDE_STATIC, SOLVER_SIDE_FULL);
+            break;
+        case CONTACT_SOLVER_CLASS_ROTATION_LOCKED:
+            collision_scene_solve_position_constraint(cc, cs, SOLVER_SIDE_STATIC, SOLVER_SIDE_LINEAR);
+            break;
+        case CONTACT_SOLVER_CLASS_DYNAMIC_DYNAMIC:
+            collision_scene_solve_position_constraint(cc, cs, SOLVER_SIDE_FULL, SOLVER_SIDE_FULL);
+            break;
+        default:
+            collision_scene_solve_position_constraint(cc, cs, SOLVER_SIDE_GENERIC, SOLVER_SIDE_GENERIC);
+            break;
+        }
+    }
+}
+
+// ============================================================================
+// Simulation (TGS soft step solver)
+// ============================================================================
+
+/// @brief Recompute the contact anchors and separations from the cached local points after a substep moved the objects.
+/// The effective masses from pre-solve are kept, only the lever arms and the separation-based bias are refreshed.
+/// @param substep_time the duration of one substep in seconds
+static void collision_scene_tgs_update_anchors(float substep_time) {
+    const float inv_substep_time = 1.0f / substep_time;
+
+    for (int i = 0; i < g_scene.contact_solver_count; i++) {
+        contact_constraint* cc = &g_scene.cached_contact_constraints[i];
+        contact_constraint_solver* cs = &g_scene.contact_solvers[i];
+
+        if (!cc->is_active) continue;
+
+        physics_object* a = cc->objectA;
+        physics_object* b = cc->objectB;
+
+        for (int p = 0; p < cc->point_count; p++) {
+            contact_point* cp = &cc->points[p];
+            contact_point_solver* sp = &cs->points[p];
+
+            Vector3 contactA, contactB;
+            collide_contact_point_world(cc, cp, &contactA, &contactB);
+
+            if (a) {
+                vector3Sub(&contactA, &a->_world_center_of_mass, &sp->a_to_contact);
             }
 
-            if (b && !bMovementConstrained)
-            {
-                if (invMassB > 0.0f) {
-                    vector3AddScaled(b->position, &effectiveNormalB, -correctionMag * invMassB, b->position);
-                }
+            if (b) {
+                vector3Sub(&contactB, &b->_world_center_of_mass, &sp->b_to_contact);
+            }
 
-                if (b->rotation && !((b->constraints & CONSTRAINTS_FREEZE_ROTATION_ALL) == CONSTRAINTS_FREEZE_ROTATION_ALL)) {
-                    Vector3 angularImpulse;
-                    vector3Cross(&cp->b_to_contact, &impulse, &angularImpulse);
-                    vector3Negate(&angularImpulse, &angularImpulse);
-                    physics_object_apply_angular_impulse_to_rotation(b, &angularImpulse);
-                }
+            // Normal points B -> A, overlap is positive
+            Vector3 diff;
+            vector3Sub(&contactA, &contactB, &diff);
+            cp->penetration = -vector3Dot(&diff, &cc->normal);
+
+            // Soft push-out velocity for the remaining penetration
+            sp->position_bias = 0.0f;
+            if (cp->penetration > TGS_SOLVER_SLOP) {
+                sp->position_bias = minf(TGS_SOLVER_BIAS_FACTOR * (cp->penetration - TGS_SOLVER_SLOP) * inv_substep_time, TGS_SOLVER_MAX_BIAS_VELOCITY);
             }
+        }
+    }
+}
+
+/// @brief Clear the separation bias so the final relax iteration removes the push-out velocity again
+static void collision_scene_tgs_clear_bias() {
+    for (int i = 0; i < g_scene.contact_solver_count; i++) {
+        contact_constraint* cc = &g_scene.cached_contact_constraints[i];
+        contact_constraint_solver* cs = &g_scene.contact_solvers[i];
 
-            cp->penetration -= steeringForce;
+        for (int p = 0; p < cc->point_count; p++) {
+            cs->points[p].position_bias = 0.0f;
         }
     }
 }
 
+/// @brief Run the substeps of the TGS soft step solver.
+/// Each substep recomputes the contact anchors, runs one biased velocity iteration and integrates the objects
+/// over a fraction of the step. A final relax iteration without bias follows, the split position solver is not used.
+static void collision_scene_solve_tgs_substeps() {
+    const float step_fraction = 1.0f / TGS_SOLVER_SUBSTEPS;
+
+    for (int substep = 0; substep < TGS_SOLVER_SUBSTEPS; substep++) {
+        collision_scene_tgs_update_anchors(FIXED_DELTATIME * step_fraction);
+        collision_scene_solve_velocity_constraints();
+
+        for (int i = 0; i < g_scene.objectCount; i++) {
+            physics_object* obj = g_scene.elements[i].object;
+
+            physics_object_integrate_position_substep(obj, step_fraction);
+            physics_object_integrate_rotation_substep(obj, step_fraction);
+
+            if (!obj->_is_sleeping) {
+                physics_object_update_world_inertia(obj);
+            }
+        }
+    }
+
+    collision_scene_tgs_clear_bias();
+    collision_scene_solve_velocity_constraints();
+}
+
 void collision_scene_step() {
     struct collision_scene_element* element;
 
@@ -1240,9 +1790,6 @@ void collision_scene_step() {
             obj->acceleration.y += PHYS_GRAVITY_CONSTANT * obj->gravity_scalar;
         }
 
-        // Release old contacts from previous frame
-        collision_scene_release_object_contacts(obj);
-
         // Integrate acceleration into velocity (but don't update position yet!)
         physics_object_integrate_velocity(obj);
 
@@ -1253,6 +1800,9 @@ void collision_scene_step() {
     // ========================================================================
     // PHASE 2: Detect all contacts (without resolving)
     // ========================================================================
+    // Contacts that go away during detection report their end event after the ones carried over from removed objects
+    collision_scene_begin_contact_events();
+    collision_scene_scratch_reset();
     collision_scene_detect_all_contacts();
 
     // ========================================================================
@@ -1265,26 +1815,40 @@ void collision_scene_step() {
     // ========================================================================
     collision_scene_warm_start();
 
-    // ========================================================================
-    // PHASE 5: Solve velocity constraints iteratively
-    // ========================================================================
-    for (int iter = 0; iter < VELOCITY_CONSTRAINT_SOLVER_ITERATIONS; iter++) {
-        collision_scene_solve_velocity_constraints();
+    if (g_scene.solver_type == COLLISION_SOLVER_TGS_SOFT) {
+        // ====================================================================
+        // PHASE 5+6: Substepped velocity solve and integration (TGS)
+        // ====================================================================
+        collision_scene_solve_tgs_substeps();
+    } else {
+        // ====================================================================
+        // PHASE 5: Solve velocity constraints iteratively
+        // ====================================================================
+        for (int iter = 0; iter < VELOCITY_CONSTRAINT_SOLVER_ITERATIONS; iter++) {
+            collision_scene_solve_velocity_constraints();
+        }
+
+        // ====================================================================
+        // PHASE 6: Integrate positions from velocities
+        // ====================================================================
+        for (int i = 0; i < g_scene.objectCount; i++) {
+            physics_object* obj = g_scene.elements[i].object;
+
+            // Integrate velocity into position
+            physics_object_integrate_position(obj);
+
+            // Integrate angular velocity into rotation
+            physics_object_integrate_rotation(obj);
+        }
     }
 
     // ========================================================================
-    // PHASE 6: Integrate positions from velocities and update AABBs
+    // Update AABBs
     // ========================================================================
     for (int i = 0; i < g_scene.objectCount; i++) {
         element = &g_scene.elements[i];
         physics_object* obj = element->object;
 
-        // Integrate velocity into position
-        physics_object_integrate_position(obj);
-
-        // Integrate angular velocity into rotation
-        physics_object_integrate_rotation(obj);
-
         // Recalculate AABB if object is awake (position may have changed due to velocity integration or solver)
         if (!obj->_is_sleeping) {
             // Check if object actually moved or rotated this frame
@@ -1302,10 +1866,12 @@ void collision_scene_step() {
     }
 
     // ========================================================================
-    // PHASE 7: Solve position constraints iteratively
+    // PHASE 7: Solve position constraints iteratively (the TGS solver resolves penetration in its substeps)
     // ========================================================================
-    for (int iter = 0; iter < POSITION_CONSTRAINT_SOLVER_ITERATIONS; iter++) {
-        collision_scene_solve_position_constraints();
+    if (g_scene.solver_type == COLLISION_SOLVER_PGS) {
+        for (int iter = 0; iter < POSITION_CONSTRAINT_SOLVER_ITERATIONS; iter++) {
+            collision_scene_solve_position_constraints();
+        }
     }
 
     collision_scene_fix_sweep_collisions();
@@ -1370,4 +1936,13 @@ void collision_scene_step() {
             g_scene._sleepy_count += 1;
         }
     }
+
+    // ========================================================================
+    // PHASE 9: Publish begin/persist events for all cached contacts
+    // ========================================================================
+    for (int i = 0; i < g_scene.cached_contact_constraint_count; i++) {
+        contact_constraint* constraint = &g_scene.cached_contact_constraints[i];
+        collision_scene_push_contact_event(constraint, constraint->is_reported ? CONTACT_EVENT_PERSIST : CONTACT_EVENT_BEGIN);
+    }
+    g_scene._step_contact_event_count = g_scene.contact_event_count;
 }
\ No newline at end of file
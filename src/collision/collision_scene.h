@@ -3,18 +3,31 @@
 
 #include "physics_object.h"
 #include "../collision/mesh_collider.h"
+#include "../collision/heightfield.h"
+#include "../collision/mesh_instance.h"
 #include "../util/hash_map.h"
 #include "../collision/aabb_tree.h"
 #include "contact.h"
 
 
 #define MAX_PHYSICS_OBJECTS 64
-#define MAX_ACTIVE_CONTACTS 128
 #define MAX_CACHED_CONTACTS 256
+#define MAX_TRIGGER_OVERLAPS 64
+#define MAX_CONTACT_EVENTS (MAX_CACHED_CONTACTS * 2)
+#define COLLISION_SCENE_MAX_WAKE_RESULTS 16 // broadphase results per object when waking an island
+#define STEP_SCRATCH_GROW_SIZE (sizeof(contact_constraint_solver) * 16) // the step scratch arena grows in steps of this size
 
 #define VELOCITY_CONSTRAINT_SOLVER_ITERATIONS 5
 #define POSITION_CONSTRAINT_SOLVER_ITERATIONS 4
 
+#define CONTACT_BLOCK_SOLVER_MAX_CONDITION 1000.0f // manifolds with a worse conditioned normal mass matrix use sequential impulses
+#define CONTACT_BLOCK_SOLVER_TOLERANCE 0.001f // allowed approaching velocity of inactive points in the block solution
+
+#define TGS_SOLVER_SUBSTEPS 4 // substeps per physics step, each runs one velocity iteration
+#define TGS_SOLVER_SLOP 0.01f // allowed penetration before the separation bias kicks in
+#define TGS_SOLVER_BIAS_FACTOR 0.2f // fraction of the penetration resolved per substep
+#define TGS_SOLVER_MAX_BIAS_VELOCITY 2.0f // maximum push-out velocity in units/s
+
 
 /// @brief A wrapper for a physics object in the collision scene
 struct collision_scene_element {
@@ -22,24 +35,72 @@ struct collision_scene_element {
 };
 
 
+/// @brief Contact solver backend used by collision_scene_step
+enum collision_solver_type {
+    COLLISION_SOLVER_PGS, // velocity iterations followed by split position iterations, the default
+    COLLISION_SOLVER_TGS_SOFT, // experimental: substeps with one soft velocity iteration each, no position iterations. Taller stacks jitter more and can collapse
+};
+
+
+/// @brief Lifecycle state of a trigger overlap
+enum trigger_overlap_state {
+    TRIGGER_OVERLAP_ENTER, // overlap started this step
+    TRIGGER_OVERLAP_STAY,  // overlap was already present in the previous step
+    TRIGGER_OVERLAP_EXIT,  // overlap ended this step (entry is dropped on the next step)
+};
+
+
+/// @brief A trigger overlapping another physics object.
+/// Trigger overlaps are tracked separately from the contact constraint cache and never reach the solver.
+struct trigger_overlap {
+    physics_object* trigger; // NULL once the trigger was removed from the scene
+    physics_object* other;   // NULL once the other object was removed from the scene
+    contact_pair_id pid;
+    uint8_t state;           // enum trigger_overlap_state
+    bool _seen;              // was this overlap found in the current step?
+};
+
+
 /// @brief The main collision scene structure holding all physics objects and contacts
 struct collision_scene {
     struct collision_scene_element* elements;
-    contact* next_free_contact;
-    contact* all_contacts;
     struct hash_map entity_mapping;
     uint16_t objectCount;
     uint16_t capacity;
     AABB_tree object_aabbtree;
     struct mesh_collider* mesh_collider;
+    struct heightfield* heightfield; // terrain, walls and overhangs stay in the mesh collider
+    AABB_tree mesh_instance_tree; // top-level tree of the placed mesh instances
     bool _moved_flags[MAX_PHYSICS_OBJECTS];
     bool _rotated_flags[MAX_PHYSICS_OBJECTS];
     uint16_t _sleepy_count;
+    uint8_t solver_type; // enum collision_solver_type
 
     // Iterative constraint solver data
     contact_constraint* cached_contact_constraints;
     int cached_contact_constraint_count;
     struct hash_map contact_map;
+
+    // Per-step scratch arena, everything allocated from it is discarded at the start of the next step.
+    // It starts empty and grows to the largest step seen so far
+    uint8_t* _step_scratch;
+    int _step_scratch_size;
+    int _step_scratch_used;
+
+    // Solver data of the cached constraints (allocated from the step scratch in pre-solve)
+    contact_constraint_solver* contact_solvers;
+    int contact_solver_count;
+
+    // Contact events of the last physics step (begin/persist/end)
+    // followed by the end events of objects removed since then, which are carried over into the next step
+    contact_event* contact_events;
+    int contact_event_count;
+    int _step_contact_event_count; // events published by the last step, the rest are carried over
+    int dropped_contact_event_count; // events that did not fit into the stream since the reset
+
+    // Trigger overlaps (boolean only, no constraints)
+    struct trigger_overlap* trigger_overlaps;
+    int trigger_overlap_count;
 };
 
 
@@ -75,12 +136,56 @@ void collision_scene_use_static_collision(struct mesh_collider* mesh_collider);
 void collision_scene_remove_static_collision();
 
 
+/// @brief Adds a placed mesh instance to the static collision of the scene
+/// @param instance The instance, initialized with mesh_instance_init
+void collision_scene_add_mesh_instance(struct mesh_instance* instance);
+
+
+/// @brief Removes a mesh instance from the scene, together with the contacts anchored to it
+/// @param instance The instance to remove
+void collision_scene_remove_mesh_instance(struct mesh_instance* instance);
+
+
+/// @brief Moves a mesh instance kinematically, only its node in the top-level tree is updated.
+/// Call it once per physics step from a fixed update callback, the move is taken as the velocity of the instance
+/// for that step and the objects in its bounds are woken up.
+/// @param instance The instance to move
+/// @param position The new position
+/// @param rotation The new rotation
+void collision_scene_move_mesh_instance(struct mesh_instance* instance, const Vector3* position, const Quaternion* rotation);
+
+
+/// @brief Sets the static terrain heightfield for the scene, used alongside the static mesh collider
+/// @param heightfield The heightfield to use
+void collision_scene_use_heightfield(struct heightfield* heightfield);
+
+
+/// @brief Removes the current terrain heightfield from the scene
+void collision_scene_remove_heightfield();
+
+
 /// @brief Performs a physics step on all objects in the scene
 void collision_scene_step();
 
 
-/// @brief Allocates a new contact from the scene's pool
-/// @return A pointer to the new contact, or NULL if the pool is empty
-contact* collision_scene_allocate_contact();
+/// @brief Selects the contact solver backend, can be changed between steps.
+/// The scene starts with COLLISION_SOLVER_PGS, the TGS solver is not yet tuned to replace it
+/// @param solver_type The solver to use
+void collision_scene_set_solver(enum collision_solver_type solver_type);
+
+
+/// @brief Finds the first trigger overlap between a trigger and another object
+/// @param trigger The trigger object, or NULL to match any trigger
+/// @param other The overlapping object, or NULL to match any object
+/// @return The overlap if found, NULL otherwise. Overlaps in the EXIT state are included.
+struct trigger_overlap* collision_scene_find_trigger_overlap(physics_object* trigger, physics_object* other);
+
+
+/// @brief Checks if an object currently has a contact constraint with the static mesh or heightfield
+/// @param object The object to check
+/// @param normal If not NULL, only contacts with a similar normal are considered
+/// @param min_normal_dot The minimum dot product between the contact normal and normal
+/// @return true if a matching mesh contact exists
+bool collision_scene_has_mesh_contact(physics_object* object, const Vector3* normal, float min_normal_dot);
 
 #endif
\ No newline at end of file
@@ -8,51 +8,83 @@
 #define MAX_CONTACT_POINTS_PER_PAIR 4
 
 typedef struct contact_constraint contact_constraint;
-typedef struct contact contact;
+typedef struct contact_constraint_solver contact_constraint_solver;
+typedef struct contact_event contact_event;
 typedef uint32_t contact_pair_id; //unique combination of two entity ids (enity_id is uint16_t), must be double size of entity_id
 typedef struct physics_object physics_object;
+struct mesh_instance;
 
 
-/// @brief contact struct containing information about a collision
-typedef struct __attribute__((aligned(16))) contact {
-    contact* next; // pointer to the next contact in a list
-    contact_constraint* constraint; // pointer to the shared constraint data
-    physics_object* other_object; // entity_id of the object that was collided with
-} contact;
+/// @brief Type of a contact event
+enum contact_event_type {
+    CONTACT_EVENT_BEGIN, // the contact was created this step
+    CONTACT_EVENT_PERSIST, // the contact already existed in the previous step
+    CONTACT_EVENT_END, // the contact was removed this step, or one of the objects was removed from the scene before it
+};
 
 
-/// @brief Single contact point data within a contact constraint
+/// @brief contact event published by the collision scene, one per contact constraint and physics step.
+/// Events only hold entity ids and layers, so they stay valid after one of the objects was removed.
+typedef struct contact_event {
+    Vector3 normal; // the collision normal pointing from B toward A
+    Vector3 point; // the first contact point in world space
+    float normal_impulse; // total normal impulse applied this step
+    contact_pair_id pid; // unique ID for this contact pair (combination of both entity IDs)
+    entity_id entity_a; // 0 for the static mesh, the id of the instance for mesh instances
+    entity_id entity_b;
+    uint16_t layers_a; // collision layers of A at the time of the event
+    uint16_t layers_b; // collision layers of B at the time of the event
+    uint8_t type; // enum contact_event_type
+    uint8_t _padding[3];
+} contact_event;
+
+
+/// @brief Single contact point data within a contact constraint.
+/// Only the data that has to survive between steps is stored here, world space anchors are
+/// rebuilt from the local points and solver data lives in contact_point_solver.
 typedef struct __attribute__((aligned(16))) contact_point {
-    Vector3 point; // the 3D position in world space of the contact point
-    Vector3 contactA; // contact point on surface A (world space)
-    Vector3 contactB; // contact point on surface B (world space)
-    Vector3 localPointA; // contact point on surface A (local space)
-    Vector3 localPointB; // contact point on surface B (local space)
-    Vector3 a_to_contact; // contact point relative to A's center of mass
-    Vector3 b_to_contact; // contact point relative to B's center of mass
+    Vector3 localPointA; // contact point on surface A (local space of A, anchor space of a mesh instance, world space for the static mesh)
+    Vector3 localPointB; // contact point on surface B (local space of B, world space for the static mesh)
     float penetration; // depth of penetration for this point
-    // Cached data for warm starting and iterative solving (per point)
+    // Cached data for warm starting (per point)
     float accumulated_normal_impulse; // accumulated normal impulse for warm starting
     float accumulated_tangent_impulse_u; // accumulated tangent impulse for friction (first tangent direction)
     float accumulated_tangent_impulse_v; // accumulated tangent impulse for friction (second tangent direction)
+
+    bool active; // whether this point was updated/validated this frame
+} contact_point;
+
+
+/// @brief Per-step solver data of a contact point, allocated from the collision scene's step scratch arena
+typedef struct contact_point_solver {
+    Vector3 a_to_contact; // contact point relative to A's center of mass
+    Vector3 b_to_contact; // contact point relative to B's center of mass
+    Vector3 surface_velocity; // velocity of the static side A at the contact point, only moving mesh instances have one
     float normal_mass; // cached effective mass for normal direction (1/denominator)
     float tangent_mass_u; // cached effective mass for first tangent direction
     float tangent_mass_v; // cached effective mass for second tangent direction
     float velocity_bias; // velocity bias for restitution
+    float position_bias; // separation velocity bias of the current substep (TGS solver only)
+} contact_point_solver;
 
-    bool active; // whether this point was updated/validated this frame
-} contact_point;
+
+/// @brief Body-type class of a contact constraint, selects the specialized solver kernel
+enum contact_solver_class {
+    CONTACT_SOLVER_CLASS_GENERIC, // position-locked or mixed pairs, every constraint flag is checked at runtime
+    CONTACT_SOLVER_CLASS_STATIC_DYNAMIC, // static mesh or kinematic A vs. freely rotating B
+    CONTACT_SOLVER_CLASS_DYNAMIC_DYNAMIC, // two freely rotating dynamic objects
+    CONTACT_SOLVER_CLASS_ROTATION_LOCKED, // static mesh or kinematic A vs. B without rotation (e.g. the player)
+};
 
 
 /// @brief contact constraint containing multiple contact points for a pair of objects
 typedef struct __attribute__((aligned(16))) contact_constraint {
     physics_object* objectA; // first object in the contact pair
     physics_object* objectB; // second object in the contact pair
+    const struct mesh_instance* instance; // the mesh instance on side A, objectA is NULL then. NULL for other contacts
     
     // Shared data for all contact points in this pair
     Vector3 normal; // the collision normal pointing from B toward A (shared across points)
-    Vector3 tangent_u; // first tangent direction for friction (shared)
-    Vector3 tangent_v; // second tangent direction for friction (shared)
 
     // Material properties (shared)
     float combined_friction;
@@ -64,14 +96,28 @@ typedef struct __attribute__((aligned(16))) contact_constraint {
 
     // Flags
     bool is_active; // was this contact found this frame?
-    bool is_trigger; // is this a trigger contact (no resolution)?
-    uint8_t _padding[2]; // Explicit padding to align next member
+    bool is_reported; // was a begin event already published for this contact?
+    bool use_block_solver; // solve the normal impulses of all points together (set in pre-solve)
+    uint8_t solver_class; // enum contact_solver_class (set in pre-solve)
 
     // Multiple contact points for this pair
     contact_point points[MAX_CONTACT_POINTS_PER_PAIR];
 
 } contact_constraint;
 
+
+/// @brief Per-step solver data of a contact constraint, allocated from the collision scene's step scratch arena.
+/// Entry i belongs to cached contact constraint i.
+typedef struct contact_constraint_solver {
+    Vector3 tangent_u; // first tangent direction for friction (shared)
+    Vector3 tangent_v; // second tangent direction for friction (shared)
+
+    // Coupled normal effective mass matrix of the points (point_count x point_count), used by the block solver
+    float normal_block_mass[MAX_CONTACT_POINTS_PER_PAIR][MAX_CONTACT_POINTS_PER_PAIR];
+
+    contact_point_solver points[MAX_CONTACT_POINTS_PER_PAIR];
+} contact_constraint_solver;
+
 /// @brief Create a unique contact pair id from two entity ids
 /// @param a 
 /// @param b 
@@ -83,4 +129,20 @@ inline contact_pair_id contact_pair_id_get(entity_id a_id, entity_id b_id){
         return ((contact_pair_id)b_id << (sizeof(entity_id) * __CHAR_BIT__)) | a_id;
 }
 
+/// @brief Check if a contact event involves the given entity
+/// @param event 
+/// @param id 
+/// @return true if either side of the event is the entity
+inline bool contact_event_has_entity(const contact_event* event, entity_id id){
+    return event->entity_a == id || event->entity_b == id;
+}
+
+/// @brief Get the collision layers of the other side of a contact event
+/// @param event 
+/// @param id the entity id of the side that is looking at the event
+/// @return collision layers of the other object
+inline uint16_t contact_event_other_layers(const contact_event* event, entity_id id){
+    return event->entity_a == id ? event->layers_b : event->layers_a;
+}
+
 #endif
@@ -0,0 +1,249 @@
+#include "heightfield.h"
+
+#include <math.h>
+#include "mesh_collider.h"
+#include "shapes/ray_triangle_intersection.h"
+#include "../math/mathf.h"
+#include "../math/minmax.h"
+
+static inline int16_t heightfield_get_sample(const struct heightfield* heightfield, int x, int z) {
+    return heightfield->heights[z * (heightfield->cells_x + 1) + x];
+}
+
+static inline float heightfield_sample_to_height(const struct heightfield* heightfield, int16_t sample) {
+    return heightfield->origin.y + sample * heightfield->height_scale;
+}
+
+void heightfield_init(struct heightfield* heightfield, int16_t* heights, uint16_t cells_x, uint16_t cells_z, const Vector3* origin, float cell_size, float height_scale) {
+    heightfield->heights = heights;
+    heightfield->cells_x = cells_x;
+    heightfield->cells_z = cells_z;
+    heightfield->origin = *origin;
+    heightfield->cell_size = cell_size;
+    heightfield->inv_cell_size = cell_size > 0.0f ? 1.0f / cell_size : 0.0f;
+    heightfield->height_scale = height_scale;
+
+    int16_t min_sample = INT16_MAX;
+    int16_t max_sample = INT16_MIN + 1;
+    int sample_count = (cells_x + 1) * (cells_z + 1);
+    for (int i = 0; i < sample_count; i++) {
+        if (heights[i] == HEIGHTFIELD_HOLE) continue;
+        min_sample = MIN(min_sample, heights[i]);
+        max_sample = MAX(max_sample, heights[i]);
+    }
+
+    heightfield->bounds.min = (Vector3){{origin->x, heightfield_sample_to_height(heightfield, min_sample), origin->z}};
+    heightfield->bounds.max = (Vector3){{
+        origin->x + cells_x * cell_size,
+        heightfield_sample_to_height(heightfield, max_sample),
+        origin->z + cells_z * cell_size
+    }};
+}
+
+bool heightfield_get_cell_range(const struct heightfield* heightfield, const AABB* box, int* min_x, int* min_z, int* max_x, int* max_z) {
+    if (heightfield->cells_x == 0 || heightfield->cells_z == 0 ||
+        box->max.x < heightfield->bounds.min.x || box->min.x > heightfield->bounds.max.x ||
+        box->max.z < heightfield->bounds.min.z || box->min.z > heightfield->bounds.max.z ||
+        box->max.y < heightfield->bounds.min.y || box->min.y > heightfield->bounds.max.y) {
+        return false;
+    }
+
+    *min_x = clampf(floorf((box->min.x - heightfield->origin.x) * heightfield->inv_cell_size), 0.0f, heightfield->cells_x - 1);
+    *min_z = clampf(floorf((box->min.z - heightfield->origin.z) * heightfield->inv_cell_size), 0.0f, heightfield->cells_z - 1);
+    *max_x = clampf(floorf((box->max.x - heightfield->origin.x) * heightfield->inv_cell_size), 0.0f, heightfield->cells_x - 1);
+    *max_z = clampf(floorf((box->max.z - heightfield->origin.z) * heightfield->inv_cell_size), 0.0f, heightfield->cells_z - 1);
+    return true;
+}
+
+bool heightfield_get_triangle(const struct heightfield* heightfield, int cell_x, int cell_z, int triangle, Vector3 corners[3]) {
+    // corner offsets of the two triangles, both share the diagonal from (0, 0) to (1, 1)
+    static const uint8_t offsets[HEIGHTFIELD_TRIANGLES_PER_CELL][3][2] = {
+        {{0, 0}, {0, 1}, {1, 1}},
+        {{0, 0}, {1, 1}, {1, 0}},
+    };
+
+    for (int i = 0; i < 3; i++) {
+        int x = cell_x + offsets[triangle][i][0];
+        int z = cell_z + offsets[triangle][i][1];
+        int16_t sample = heightfield_get_sample(heightfield, x, z);
+        if (sample == HEIGHTFIELD_HOLE) {
+            return false;
+        }
+
+        corners[i].x = heightfield->origin.x + x * heightfield->cell_size;
+        corners[i].y = heightfield_sample_to_height(heightfield, sample);
+        corners[i].z = heightfield->origin.z + z * heightfield->cell_size;
+    }
+
+    return true;
+}
+
+void heightfield_get_cell_height_range(const struct heightfield* heightfield, int cell_x, int cell_z, float* min_height, float* max_height) {
+    int16_t min_sample = INT16_MAX;
+    int16_t max_sample = INT16_MIN + 1;
+    for (int z = cell_z; z <= cell_z + 1; z++) {
+        for (int x = cell_x; x <= cell_x + 1; x++) {
+            int16_t sample = heightfield_get_sample(heightfield, x, z);
+            if (sample == HEIGHTFIELD_HOLE) continue;
+            min_sample = MIN(min_sample, sample);
+            max_sample = MAX(max_sample, sample);
+        }
+    }
+
+    *min_height = heightfield_sample_to_height(heightfield, min_sample);
+    *max_height = heightfield_sample_to_height(heightfield, max_sample);
+}
+
+bool heightfield_sample(const struct heightfield* heightfield, float x, float z, float* height, Vector3* normal) {
+    float local_x = (x - heightfield->origin.x) * heightfield->inv_cell_size;
+    float local_z = (z - heightfield->origin.z) * heightfield->inv_cell_size;
+    if (local_x < 0.0f || local_z < 0.0f || local_x > heightfield->cells_x || local_z > heightfield->cells_z) {
+        return false;
+    }
+
+    int cell_x = MIN((int)local_x, heightfield->cells_x - 1);
+    int cell_z = MIN((int)local_z, heightfield->cells_z - 1);
+    float fraction_x = local_x - cell_x;
+    float fraction_z = local_z - cell_z;
+
+    Vector3 corners[3];
+    int triangle = fraction_x > fraction_z ? 1 : 0;
+    if (!heightfield_get_triangle(heightfield, cell_x, cell_z, triangle, corners)) {
+        return false;
+    }
+
+    // both triangles start at (0, 0) and end at (1, 1), so the height interpolates along the two grid axes
+    float h00 = corners[0].y;
+    float h11 = triangle ? corners[1].y : corners[2].y;
+    float h_mid = triangle ? corners[2].y : corners[1].y; // sample (1, 0) or (0, 1)
+    if (triangle) {
+        *height = h00 + (h_mid - h00) * fraction_x + (h11 - h_mid) * fraction_z;
+    } else {
+        *height = h00 + (h_mid - h00) * fraction_z + (h11 - h_mid) * fraction_x;
+    }
+
+    if (normal) {
+        Vector3 edge1, edge2;
+        vector3Sub(&corners[1], &corners[0], &edge1);
+        vector3Sub(&corners[2], &corners[0], &edge2);
+        vector3Cross(&edge1, &edge2, normal);
+        vector3NormalizeSelf(normal);
+    }
+
+    return true;
+}
+
+/// @brief Clips the ray against the bounds of the heightfield
+/// @return false if the ray misses the bounds within its max distance
+static bool heightfield_clip_ray(const struct heightfield* heightfield, const raycast* ray, float* t_enter, float* t_exit) {
+    float t_min = 0.0f;
+    float t_max = ray->maxDistance;
+
+    for (int axis = 0; axis < 3; axis++) {
+        if (fabsf(ray->dir.v[axis]) < EPSILON) {
+            if (ray->origin.v[axis] < heightfield->bounds.min.v[axis] || ray->origin.v[axis] > heightfield->bounds.max.v[axis]) {
+                return false;
+            }
+            continue;
+        }
+
+        float t0 = (heightfield->bounds.min.v[axis] - ray->origin.v[axis]) * ray->_invDir.v[axis];
+        float t1 = (heightfield->bounds.max.v[axis] - ray->origin.v[axis]) * ray->_invDir.v[axis];
+        t_min = fmaxf(t_min, fminf(t0, t1));
+        t_max = fminf(t_max, fmaxf(t0, t1));
+        if (t_min > t_max) {
+            return false;
+        }
+    }
+
+    *t_enter = t_min;
+    *t_exit = t_max;
+    return true;
+}
+
+/// @brief Tests the ray against both triangles of a cell and keeps the closer hit
+static bool heightfield_raycast_cell(const struct heightfield* heightfield, raycast* ray, int cell_x, int cell_z, float t_from, float t_to, raycast_hit* hit) {
+    // reject cells the ray passes completely above or below
+    float min_height, max_height;
+    heightfield_get_cell_height_range(heightfield, cell_x, cell_z, &min_height, &max_height);
+    float y_from = ray->origin.y + ray->dir.y * t_from;
+    float y_to = ray->origin.y + ray->dir.y * t_to;
+    if (fminf(y_from, y_to) > max_height || fmaxf(y_from, y_to) < min_height) {
+        return false;
+    }
+
+    bool did_hit = false;
+    for (int i = 0; i < HEIGHTFIELD_TRIANGLES_PER_CELL; i++) {
+        Vector3 corners[3];
+        if (!heightfield_get_triangle(heightfield, cell_x, cell_z, i, corners)) {
+            continue;
+        }
+
+        struct mesh_triangle triangle;
+        mesh_triangle_init(&triangle, &corners[0], &corners[1], &corners[2], &gUp);
+
+        raycast_hit current_hit;
+        if (ray_triangle_intersection(ray, &current_hit, &triangle) && (!did_hit || current_hit.distance < hit->distance)) {
+            *hit = current_hit;
+            did_hit = true;
+        }
+    }
+
+    return did_hit;
+}
+
+bool heightfield_raycast(const struct heightfield* heightfield, raycast* ray, raycast_hit* hit) {
+    if (heightfield->cells_x == 0 || heightfield->cells_z == 0) {
+        return false;
+    }
+
+    float t_enter, t_exit;
+    if (!heightfield_clip_ray(heightfield, ray, &t_enter, &t_exit)) {
+        return false;
+    }
+
+    float local_x = (ray->origin.x + ray->dir.x * t_enter - heightfield->origin.x) * heightfield->inv_cell_size;
+    float local_z = (ray->origin.z + ray->dir.z * t_enter - heightfield->origin.z) * heightfield->inv_cell_size;
+    int cell_x = clampf(floorf(local_x), 0.0f, heightfield->cells_x - 1);
+    int cell_z = clampf(floorf(local_z), 0.0f, heightfield->cells_z - 1);
+
+    // distance along the ray to the next cell boundary and between two boundaries, per axis
+    int step_x = ray->dir.x >= 0.0f ? 1 : -1;
+    int step_z = ray->dir.z >= 0.0f ? 1 : -1;
+    float t_delta_x = fabsf(ray->dir.x) < EPSILON ? INFINITY : heightfield->cell_size * fabsf(ray->_invDir.x);
+    float t_delta_z = fabsf(ray->dir.z) < EPSILON ? INFINITY : heightfield->cell_size * fabsf(ray->_invDir.z);
+    float t_next_x = INFINITY;
+    float t_next_z = INFINITY;
+    if (t_delta_x != INFINITY) {
+        float boundary = heightfield->origin.x + (cell_x + (step_x > 0 ? 1 : 0)) * heightfield->cell_size;
+        t_next_x = (boundary - ray->origin.x) * ray->_invDir.x;
+    }
+    if (t_delta_z != INFINITY) {
+        float boundary = heightfield->origin.z + (cell_z + (step_z > 0 ? 1 : 0)) * heightfield->cell_size;
+        t_next_z = (boundary - ray->origin.z) * ray->_invDir.z;
+    }
+
+    float t_cell = t_enter;
+    while (t_cell <= t_exit) {
+        float t_cell_exit = fminf(fminf(t_next_x, t_next_z), t_exit);
+
+        if (heightfield_raycast_cell(heightfield, ray, cell_x, cell_z, t_cell, t_cell_exit, hit)) {
+            return true;
+        }
+
+        t_cell = t_cell_exit;
+        if (t_next_x < t_next_z) {
+            cell_x += step_x;
+            t_next_x += t_delta_x;
+        } else {
+            cell_z += step_z;
+            t_next_z += t_delta_z;
+        }
+
+        if (cell_x < 0 || cell_z < 0 || cell_x >= heightfield->cells_x || cell_z >= heightfield->cells_z || t_cell >= t_exit) {
+            break;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,89 @@
+#ifndef __COLLISION_HEIGHTFIELD_H__
+#define __COLLISION_HEIGHTFIELD_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../math/vector3.h"
+#include "../math/aabb.h"
+#include "raycast.h"
+
+#define HEIGHTFIELD_HOLE INT16_MIN // height sample value of a missing sample, triangles using it are skipped
+#define HEIGHTFIELD_TRIANGLES_PER_CELL 2
+
+/// @brief Static terrain collider built from a regular grid of quantized heights.
+///
+/// Every cell is split into two triangles along the diagonal from sample (x, z) to sample (x + 1, z + 1),
+/// so the cells overlapping a point or box are found without any tree traversal.
+/// Walls and overhangs are not representable and stay in the static triangle mesh.
+struct heightfield {
+    int16_t* heights; // (cells_x + 1) * (cells_z + 1) samples, row major along x
+    uint16_t cells_x;
+    uint16_t cells_z;
+    Vector3 origin; // world position of sample (0, 0) at height value 0
+    float cell_size;
+    float inv_cell_size;
+    float height_scale; // world units per height value
+    AABB bounds;
+};
+
+
+/// @brief Initializes a heightfield from its samples and computes its bounds
+/// @param heightfield
+/// @param heights the samples, owned by the heightfield afterwards
+/// @param cells_x
+/// @param cells_z
+/// @param origin world position of sample (0, 0) at height value 0
+/// @param cell_size
+/// @param height_scale world units per height value
+void heightfield_init(struct heightfield* heightfield, int16_t* heights, uint16_t cells_x, uint16_t cells_z, const Vector3* origin, float cell_size, float height_scale);
+
+
+/// @brief Returns the range of cells overlapping a box on the XZ plane, clamped to the grid
+/// @param heightfield
+/// @param box
+/// @param min_x
+/// @param min_z
+/// @param max_x inclusive
+/// @param max_z inclusive
+/// @return false if the box does not overlap the heightfield
+bool heightfield_get_cell_range(const struct heightfield* heightfield, const AABB* box, int* min_x, int* min_z, int* max_x, int* max_z);
+
+
+/// @brief Returns the corners of one of the two triangles of a cell, wound so the normal points up
+/// @param heightfield
+/// @param cell_x
+/// @param cell_z
+/// @param triangle 0 for the triangle on the +z side of the diagonal, 1 for the +x side
+/// @param corners
+/// @return false if the triangle is a hole
+bool heightfield_get_triangle(const struct heightfield* heightfield, int cell_x, int cell_z, int triangle, Vector3 corners[3]);
+
+
+/// @brief Returns the height range of the samples of a cell
+/// @param heightfield
+/// @param cell_x
+/// @param cell_z
+/// @param min_height
+/// @param max_height
+void heightfield_get_cell_height_range(const struct heightfield* heightfield, int cell_x, int cell_z, float* min_height, float* max_height);
+
+
+/// @brief Samples the terrain height and normal below a point in constant time
+/// @param heightfield
+/// @param x world position
+/// @param z world position
+/// @param height the terrain height at the position
+/// @param normal if not NULL, the normal of the triangle at the position
+/// @return false if the position is outside the heightfield or above a hole
+bool heightfield_sample(const struct heightfield* heightfield, float x, float z, float* height, Vector3* normal);
+
+
+/// @brief Casts a ray against the heightfield, walking the cells along the ray with a 2D DDA.
+/// The first hit found is the closest one.
+/// @param heightfield
+/// @param ray
+/// @param hit the resulting hit, only written if the ray hits
+/// @return true if the ray hits the terrain within its max distance
+bool heightfield_raycast(const struct heightfield* heightfield, raycast* ray, raycast_hit* hit);
+
+#endif // __COLLISION_HEIGHTFIELD_H__
@@ -0,0 +1,435 @@
+#include "mesh_bvh.h"
+
+#include <malloc.h>
+#include <string.h>
+#include <assert.h>
+#include <stdint.h>
+#include <math.h>
+#include "mesh_collider.h"
+#include "../math/mathf.h"
+
+/// @brief Node of the intermediate binary tree, the left child is always the next node
+struct mesh_bvh_binary_node {
+    AABB bounds;
+    uint16_t right_or_first; // inner node: index of the right child, leaf: first triangle of the range
+    uint16_t triangle_count; // 0 for inner nodes
+};
+
+/// @brief Temporary data used while building the tree
+struct mesh_bvh_builder {
+    mesh_bvh* bvh;
+    AABB* triangle_bounds;
+    Vector3* centroids;
+    uint16_t* order; // triangle order after the build, leaves reference ranges of it
+    struct mesh_bvh_binary_node* binary;
+    int binary_count;
+};
+
+// ============================================================================
+// Quantization
+// ============================================================================
+
+/// @brief Quantize world space bounds to the 16 bit grid of the tree, rounding outward
+static void mesh_bvh_quantize_bounds(const mesh_bvh* bvh, const AABB* bounds, uint16_t min[3], uint16_t max[3]) {
+    for (int axis = 0; axis < 3; axis++) {
+        float lo = floorf((bounds->min.v[axis] - bvh->origin.v[axis]) * bvh->quantize_scale.v[axis]);
+        float hi = ceilf((bounds->max.v[axis] - bvh->origin.v[axis]) * bvh->quantize_scale.v[axis]);
+        min[axis] = (uint16_t)clampf(lo, 0.0f, MESH_BVH_QUANTIZED_MAX);
+        max[axis] = (uint16_t)clampf(hi, 0.0f, MESH_BVH_QUANTIZED_MAX);
+    }
+}
+
+void mesh_bvh_get_child_bounds(const mesh_bvh* bvh, const mesh_bvh_node* node, int child, AABB* out) {
+    out->min.x = bvh->origin.x + node->min_x[child] * bvh->dequantize_scale.x;
+    out->min.y = bvh->origin.y + node->min_y[child] * bvh->dequantize_scale.y;
+    out->min.z = bvh->origin.z + node->min_z[child] * bvh->dequantize_scale.z;
+    out->max.x = bvh->origin.x + node->max_x[child] * bvh->dequantize_scale.x;
+    out->max.y = bvh->origin.y + node->max_y[child] * bvh->dequantize_scale.y;
+    out->max.z = bvh->origin.z + node->max_z[child] * bvh->dequantize_scale.z;
+}
+
+/// @brief Store the bounds and reference of a child slot
+static void mesh_bvh_set_child(const mesh_bvh* bvh, mesh_bvh_node* node, int slot, const AABB* bounds, uint16_t child, uint8_t triangle_count) {
+    uint16_t min[3];
+    uint16_t max[3];
+    mesh_bvh_quantize_bounds(bvh, bounds, min, max);
+
+    node->min_x[slot] = min[0];
+    node->min_y[slot] = min[1];
+    node->min_z[slot] = min[2];
+    node->max_x[slot] = max[0];
+    node->max_y[slot] = max[1];
+    node->max_z[slot] = max[2];
+    node->child[slot] = child;
+    node->triangle_count[slot] = triangle_count;
+}
+
+/// @brief Allocate a node with all child slots empty
+static mesh_bvh_node* mesh_bvh_allocate_node(mesh_bvh* bvh) {
+    // node indices are stored in 16 bit child slots and the node count
+    assert(bvh->node_count < UINT16_MAX);
+    mesh_bvh_node* node = &bvh->nodes[bvh->node_count++];
+    memset(node, 0, sizeof(mesh_bvh_node));
+    memset(node->triangle_count, MESH_BVH_CHILD_EMPTY, sizeof(node->triangle_count));
+    return node;
+}
+
+// ============================================================================
+// Build
+// ============================================================================
+
+/// @brief Partially sorts the triangle range so the k-th triangle is at its sorted position along the axis (quickselect)
+static void mesh_bvh_select(struct mesh_bvh_builder* builder, int first, int count, int k, int axis) {
+    uint16_t* order = builder->order;
+    int lo = first;
+    int hi = first + count - 1;
+    int target = first + k;
+
+    while (lo < hi) {
+        float pivot = builder->centroids[order[(lo + hi) / 2]].v[axis];
+        int i = lo;
+        int j = hi;
+
+        while (i <= j) {
+            while (builder->centroids[order[i]].v[axis] < pivot) i++;
+            while (builder->centroids[order[j]].v[axis] > pivot) j--;
+            if (i <= j) {
+                uint16_t tmp = order[i];
+                order[i] = order[j];
+                order[j] = tmp;
+                i++;
+                j--;
+            }
+        }
+
+        if (target <= j) {
+            hi = j;
+        } else if (target >= i) {
+            lo = i;
+        } else {
+            break;
+        }
+    }
+}
+
+/// @brief Recursively build the binary node for a triangle range, the left child is always built right after its parent
+/// @return the index of the node
+static int mesh_bvh_build_binary_node(struct mesh_bvh_builder* builder, int first, int count) {
+    int node_index = builder->binary_count++;
+
+    AABB bounds = builder->triangle_bounds[builder->order[first]];
+    AABB centroid_bounds = {builder->centroids[builder->order[first]], builder->centroids[builder->order[first]]};
+    for (int i = first + 1; i < first + count; i++) {
+        bounds = AABBUnion(&bounds, &builder->triangle_bounds[builder->order[i]]);
+        centroid_bounds = AABBUnionPoint(&centroid_bounds, &builder->centroids[builder->order[i]]);
+    }
+
+    struct mesh_bvh_binary_node* node = &builder->binary[node_index];
+    node->bounds = bounds;
+
+    if (count <= MESH_BVH_MAX_LEAF_TRIANGLES) {
+        node->right_or_first = first;
+        node->triangle_count = count;
+        return node_index;
+    }
+
+    // median split along the largest extent of the triangle centers
+    Vector3 extent;
+    vector3Sub(&centroid_bounds.max, &centroid_bounds.min, &extent);
+    int axis = 0;
+    if (extent.y > extent.v[axis]) axis = 1;
+    if (extent.z > extent.v[axis]) axis = 2;
+
+    int left_count = count / 2;
+    mesh_bvh_select(builder, first, count, left_count, axis);
+
+    mesh_bvh_build_binary_node(builder, first, left_count);
+    int right = mesh_bvh_build_binary_node(builder, first + left_count, count - left_count);
+
+    // the node array is allocated up front, so the pointer is still valid
+    node->right_or_first = right;
+    node->triangle_count = 0;
+    return node_index;
+}
+
+/// @brief Collapse a binary inner node and its descendants into a 4-wide node.
+/// The inner child with the largest surface area is opened until four children are collected.
+/// @return the index of the 4-wide node
+static int mesh_bvh_collapse_node(struct mesh_bvh_builder* builder, int binary_index) {
+    mesh_bvh* bvh = builder->bvh;
+    int node_index = bvh->node_count;
+    mesh_bvh_node* node = mesh_bvh_allocate_node(bvh);
+
+    int children[MESH_BVH_WIDTH];
+    children[0] = binary_index + 1;
+    children[1] = builder->binary[binary_index].right_or_first;
+    int child_count = 2;
+
+    while (child_count < MESH_BVH_WIDTH) {
+        int best = -1;
+        float best_area = -1.0f;
+        for (int i = 0; i < child_count; i++) {
+            struct mesh_bvh_binary_node* candidate = &builder->binary[children[i]];
+            if (candidate->triangle_count != 0) continue;
+
+            float area = AABBGetArea(candidate->bounds);
+            if (area > best_area) {
+                best = i;
+                best_area = area;
+            }
+        }
+
+        if (best < 0) break;
+
+        int opened = children[best];
+        children[best] = opened + 1;
+        children[child_count++] = builder->binary[opened].right_or_first;
+    }
+
+    for (int i = 0; i < child_count; i++) {
+        struct mesh_bvh_binary_node* child = &builder->binary[children[i]];
+
+        if (child->triangle_count != 0) {
+            mesh_bvh_set_child(bvh, node, i, &child->bounds, child->right_or_first, child->triangle_count);
+        } else {
+            // the node array is allocated up front, so the pointer is still valid
+            int child_node = mesh_bvh_collapse_node(builder, children[i]);
+            mesh_bvh_set_child(bvh, node, i, &child->bounds, child_node, MESH_BVH_CHILD_INNER);
+        }
+    }
+
+    return node_index;
+}
+
+void mesh_bvh_build(mesh_bvh* bvh, const Vector3* vertices, struct mesh_triangle_indices* triangles, void* triangle_data, int triangle_data_size, int triangle_count) {
+    bvh->nodes = NULL;
+    bvh->node_count = 0;
+
+    if (triangle_count == 0) {
+        return;
+    }
+
+    // triangle indices are stored as 16 bit values in the leaves, the triangle order and the query results
+    assert(triangle_count <= UINT16_MAX);
+
+    struct mesh_bvh_builder builder;
+    builder.bvh = bvh;
+    builder.triangle_bounds = malloc(sizeof(AABB) * triangle_count);
+    builder.centroids = malloc(sizeof(Vector3) * triangle_count);
+    builder.order = malloc(sizeof(uint16_t) * triangle_count);
+
+    AABB mesh_bounds;
+    for (int i = 0; i < triangle_count; i++) {
+        struct mesh_triangle_indices* triangle = &triangles[i];
+        Vector3 v0 = vertices[triangle->indices[0]];
+        Vector3 v1 = vertices[triangle->indices[1]];
+        Vector3 v2 = vertices[triangle->indices[2]];
+
+        builder.triangle_bounds[i] = AABBFromTriangle(&v0, &v1, &v2);
+        vector3Add(&builder.triangle_bounds[i].min, &builder.triangle_bounds[i].max, &builder.centroids[i]);
+        vector3Scale(&builder.centroids[i], &builder.centroids[i], 0.5f);
+        builder.order[i] = i;
+
+        mesh_bounds = i == 0 ? builder.triangle_bounds[i] : AABBUnion(&mesh_bounds, &builder.triangle_bounds[i]);
+    }
+
+    bvh->bounds = mesh_bounds;
+    bvh->origin = mesh_bounds.min;
+    for (int axis = 0; axis < 3; axis++) {
+        float extent = mesh_bounds.max.v[axis] - mesh_bounds.min.v[axis];
+        bvh->quantize_scale.v[axis] = extent > EPSILON ? MESH_BVH_QUANTIZED_MAX / extent : 0.0f;
+        bvh->dequantize_scale.v[axis] = extent / MESH_BVH_QUANTIZED_MAX;
+    }
+
+    // leaves hold at least two triangles (the median split never creates a smaller range), so n - 1 nodes suffice
+    int binary_capacity = triangle_count > 1 ? triangle_count - 1 : 1;
+    builder.binary = malloc(sizeof(struct mesh_bvh_binary_node) * binary_capacity);
+    builder.binary_count = 0;
+    mesh_bvh_build_binary_node(&builder, 0, triangle_count);
+    assert(builder.binary_count <= binary_capacity);
+
+    // every 4-wide node consumes at least one binary inner node
+    bvh->nodes = malloc(sizeof(mesh_bvh_node) * binary_capacity);
+    if (builder.binary[0].triangle_count != 0) {
+        mesh_bvh_node* root = mesh_bvh_allocate_node(bvh);
+        mesh_bvh_set_child(bvh, root, 0, &builder.binary[0].bounds, 0, builder.binary[0].triangle_count);
+    } else {
+        mesh_bvh_collapse_node(&builder, 0);
+    }
+    bvh->nodes = realloc(bvh->nodes, sizeof(mesh_bvh_node) * bvh->node_count);
+
+    // store the triangles in leaf order so each leaf references a contiguous range
+    struct mesh_triangle_indices* sorted_triangles = malloc(sizeof(struct mesh_triangle_indices) * triangle_count);
+    for (int i = 0; i < triangle_count; i++) {
+        sorted_triangles[i] = triangles[builder.order[i]];
+    }
+    memcpy(triangles, sorted_triangles, sizeof(struct mesh_triangle_indices) * triangle_count);
+    free(sorted_triangles);
+
+    if (triangle_data) {
+        char* data = triangle_data;
+        char* sorted_data = malloc(triangle_data_size * triangle_count);
+        for (int i = 0; i < triangle_count; i++) {
+            memcpy(sorted_data + i * triangle_data_size, data + builder.order[i] * triangle_data_size, triangle_data_size);
+        }
+        memcpy(data, sorted_data, triangle_data_size * triangle_count);
+        free(sorted_data);
+    }
+
+    free(builder.binary);
+    free(builder.triangle_bounds);
+    free(builder.centroids);
+    free(builder.order);
+}
+
+void mesh_bvh_free(mesh_bvh* bvh) {
+    free(bvh->nodes);
+    bvh->nodes = NULL;
+    bvh->node_count = 0;
+}
+
+// ============================================================================
+// Queries
+// ============================================================================
+
+/// @brief Append the triangle range of a leaf child to the results
+/// @return false if the results are full
+static inline bool mesh_bvh_append_leaf(const mesh_bvh_node* node, int slot, uint16_t* results, int* count, int max_results) {
+    for (int i = 0; i < node->triangle_count[slot]; i++) {
+        if (*count >= max_results) return false;
+        results[(*count)++] = node->child[slot] + i;
+    }
+    return *count < max_results;
+}
+
+/// @brief Slab test of a ray against a box, same rules as AABBIntersectsRay
+/// @param t_enter the distance along the ray where it enters the box, 0 if the origin is inside
+/// @return true if the ray hits the box within its max distance
+static bool mesh_bvh_ray_enter_distance(const AABB* box, const raycast* ray, float* t_enter) {
+    float tEnter = -INFINITY, tExit = INFINITY;
+
+    for (int i = 0; i < 3; i++) {
+        if (ray->dir.v[i] != 0.0f) {
+            float t1 = (box->min.v[i] - ray->origin.v[i]) * ray->_invDir.v[i];
+            float t2 = (box->max.v[i] - ray->origin.v[i]) * ray->_invDir.v[i];
+            if (t1 > t2) {
+                float temp = t1;
+                t1 = t2;
+                t2 = temp;
+            }
+            tEnter = fmaxf(tEnter, t1);
+            tExit = fminf(tExit, t2);
+        }
+        else if (ray->origin.v[i] < box->min.v[i] || ray->origin.v[i] > box->max.v[i]) {
+            return false;
+        }
+    }
+
+    *t_enter = fmaxf(tEnter, 0.0f);
+    return tEnter <= tExit && tExit >= 0.0f && tEnter <= ray->maxDistance;
+}
+
+void mesh_bvh_query_bounds(const mesh_bvh* bvh, const AABB* query_box, uint16_t* results, int* result_count, int max_results) {
+    int count = 0;
+    *result_count = 0;
+
+    if (bvh->node_count == 0 || !AABBHasOverlap(&bvh->bounds, query_box)) {
+        return;
+    }
+
+    // the query is quantized once, every child test is integer only
+    uint16_t query_min[3];
+    uint16_t query_max[3];
+    mesh_bvh_quantize_bounds(bvh, query_box, query_min, query_max);
+
+    uint16_t stack[MESH_BVH_QUERY_STACK_SIZE];
+    int top = 1;
+    stack[0] = 0;
+
+    while (top > 0) {
+        const mesh_bvh_node* node = &bvh->nodes[stack[--top]];
+
+        for (int i = 0; i < MESH_BVH_WIDTH; i++) {
+            uint8_t type = node->triangle_count[i];
+            // empty slots are always at the end
+            if (type == MESH_BVH_CHILD_EMPTY) break;
+
+            if (node->min_x[i] > query_max[0] || node->max_x[i] < query_min[0] ||
+                node->min_y[i] > query_max[1] || node->max_y[i] < query_min[1] ||
+                node->min_z[i] > query_max[2] || node->max_z[i] < query_min[2])
+                continue;
+
+            if (type == MESH_BVH_CHILD_INNER) {
+                if (top < MESH_BVH_QUERY_STACK_SIZE) {
+                    stack[top++] = node->child[i];
+                }
+            } else if (!mesh_bvh_append_leaf(node, i, results, &count, max_results)) {
+                *result_count = count;
+                return;
+            }
+        }
+    }
+
+    *result_count = count;
+}
+
+void mesh_bvh_query_ray(const mesh_bvh* bvh, const raycast* ray, uint16_t* results, int* result_count, int max_results) {
+    int count = 0;
+    *result_count = 0;
+
+    if (bvh->node_count == 0) {
+        return;
+    }
+
+    uint16_t stack[MESH_BVH_QUERY_STACK_SIZE];
+    int top = 1;
+    stack[0] = 0;
+
+    while (top > 0) {
+        const mesh_bvh_node* node = &bvh->nodes[stack[--top]];
+
+        // collect the hit children sorted by entry distance
+        int hit_slots[MESH_BVH_WIDTH];
+        float hit_distances[MESH_BVH_WIDTH];
+        int hit_count = 0;
+
+        for (int i = 0; i < MESH_BVH_WIDTH; i++) {
+            if (node->triangle_count[i] == MESH_BVH_CHILD_EMPTY) break;
+
+            AABB bounds;
+            mesh_bvh_get_child_bounds(bvh, node, i, &bounds);
+
+            float distance;
+            if (!mesh_bvh_ray_enter_distance(&bounds, ray, &distance)) continue;
+
+            int insert = hit_count++;
+            while (insert > 0 && hit_distances[insert - 1] > distance) {
+                hit_slots[insert] = hit_slots[insert - 1];
+                hit_distances[insert] = hit_distances[insert - 1];
+                insert--;
+            }
+            hit_slots[insert] = i;
+            hit_distances[insert] = distance;
+        }
+
+        // leaves are reported nearest first
+        for (int h = 0; h < hit_count; h++) {
+            int slot = hit_slots[h];
+            if (node->triangle_count[slot] != MESH_BVH_CHILD_INNER &&
+                !mesh_bvh_append_leaf(node, slot, results, &count, max_results)) {
+                *result_count = count;
+                return;
+            }
+        }
+
+        // inner children are pushed farthest first so the nearest one is popped next
+        for (int h = hit_count - 1; h >= 0; h--) {
+            int slot = hit_slots[h];
+            if (node->triangle_count[slot] == MESH_BVH_CHILD_INNER && top < MESH_BVH_QUERY_STACK_SIZE) {
+                stack[top++] = node->child[slot];
+            }
+        }
+    }
+
+    *result_count = count;
+}
@@ -0,0 +1,91 @@
+#ifndef __COLLISION_MESH_BVH_H__
+#define __COLLISION_MESH_BVH_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../math/vector3.h"
+#include "../math/aabb.h"
+#include "raycast.h"
+
+#define MESH_BVH_MAX_LEAF_TRIANGLES 4 // leaves hold a range of up to this many triangles
+#define MESH_BVH_WIDTH 4 // children per node
+#define MESH_BVH_QUERY_STACK_SIZE 64
+#define MESH_BVH_QUANTIZED_MAX 65535.0f
+#define MESH_BVH_CHILD_INNER 0 // triangle_count of a child that is an inner node
+#define MESH_BVH_CHILD_EMPTY 0xFF // triangle_count of an unused child slot
+
+struct mesh_triangle_indices;
+
+/// @brief A read-only node of the static mesh BVH (64 bytes) holding the bounds of up to four children.
+///
+/// The tree is built as a binary BVH and collapsed, so traversal tests all children of a node in one pass.
+/// Bounds are quantized to 16 bit relative to the extents of the whole mesh and rounded outward,
+/// so a child is never smaller than the triangles it contains. The bounds are stored per axis, the
+/// four values of one axis share a single 8 byte run.
+typedef struct __attribute__((aligned(16))) mesh_bvh_node {
+    uint16_t min_x[MESH_BVH_WIDTH];
+    uint16_t min_y[MESH_BVH_WIDTH];
+    uint16_t min_z[MESH_BVH_WIDTH];
+    uint16_t max_x[MESH_BVH_WIDTH];
+    uint16_t max_y[MESH_BVH_WIDTH];
+    uint16_t max_z[MESH_BVH_WIDTH];
+    uint16_t child[MESH_BVH_WIDTH]; // inner child: node index, leaf child: first triangle of the range
+    uint8_t triangle_count[MESH_BVH_WIDTH]; // MESH_BVH_CHILD_INNER, MESH_BVH_CHILD_EMPTY or the leaf triangle count
+} mesh_bvh_node;
+
+
+/// @brief BVH over the triangles of a static mesh collider, built once when the mesh is loaded
+typedef struct mesh_bvh {
+    mesh_bvh_node* nodes; // nodes[0] is the root
+    uint16_t node_count;
+    AABB bounds; // extents of the whole mesh
+    Vector3 origin; // minimum of the mesh extents, quantized value 0
+    Vector3 quantize_scale; // quantized units per world unit for each axis
+    Vector3 dequantize_scale; // world units per quantized unit for each axis
+} mesh_bvh;
+
+
+/// @brief Builds the BVH over the triangles of a mesh.
+///
+/// The triangles and their data are reordered in place so every leaf references a contiguous triangle range.
+/// @param bvh
+/// @param vertices the vertices of the mesh
+/// @param triangles the vertex indices of the triangles
+/// @param triangle_data per triangle data moved along with the triangles (e.g. the face normals), may be NULL
+/// @param triangle_data_size the size of the data of one triangle in bytes
+/// @param triangle_count
+void mesh_bvh_build(mesh_bvh* bvh, const Vector3* vertices, struct mesh_triangle_indices* triangles, void* triangle_data, int triangle_data_size, int triangle_count);
+
+
+/// @brief free the memory allocated for a mesh BVH
+/// @param bvh
+void mesh_bvh_free(mesh_bvh* bvh);
+
+
+/// @brief Returns the dequantized bounds of a child of a node in world space
+/// @param bvh
+/// @param node
+/// @param child the child slot
+/// @param out
+void mesh_bvh_get_child_bounds(const mesh_bvh* bvh, const mesh_bvh_node* node, int child, AABB* out);
+
+
+/// @brief Query the mesh BVH for triangles whose leaf bounds overlap with a given AABB
+/// @param bvh mesh BVH
+/// @param query_box the AABB to query for
+/// @param results the pre-initialized array of triangle indices to store the results
+/// @param result_count the amount of results found
+/// @param max_results the maximum amount of results to find
+void mesh_bvh_query_bounds(const mesh_bvh* bvh, const AABB* query_box, uint16_t* results, int* result_count, int max_results);
+
+
+/// @brief Query the mesh BVH for triangles whose leaf bounds are intersected by a given Ray.
+/// Children are visited front to back, so the nearest candidates are found first if max_results is hit.
+/// @param bvh mesh BVH
+/// @param ray the ray to query for
+/// @param results the pre-initialized array of triangle indices to store the results
+/// @param result_count the amount of results found
+/// @param max_results the maximum amount of results to find
+void mesh_bvh_query_ray(const mesh_bvh* bvh, const raycast* ray, uint16_t* results, int* result_count, int max_results);
+
+#endif // __COLLISION_MESH_BVH_H__
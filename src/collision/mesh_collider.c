@@ -3,29 +3,123 @@
 #include <math.h>
 #include <stdio.h>
 #include "../math/minmax.h"
+#include "../math/mathf.h"
 
 #define MAX_INDEX_SET_SIZE 64
 
+void mesh_triangle_init(struct mesh_triangle* triangle, const Vector3* v0, const Vector3* v1, const Vector3* v2, const Vector3* normal) {
+    triangle->v0 = *v0;
+    vector3Sub(v1, v0, &triangle->edge1);
+    vector3Sub(v2, v0, &triangle->edge2);
+
+    float e11 = vector3Dot(&triangle->edge1, &triangle->edge1);
+    float e12 = vector3Dot(&triangle->edge1, &triangle->edge2);
+    float e22 = vector3Dot(&triangle->edge2, &triangle->edge2);
+    float determinant = e11 * e22 - e12 * e12;
+
+    Vector3 face_normal;
+    vector3Cross(&triangle->edge1, &triangle->edge2, &face_normal);
+
+    // Degenerate triangles get a zero plane, rays never hit them and the plane test never rejects them
+    if (vector3MagSqrd(&face_normal) < EPSILON * EPSILON || determinant < EPSILON * EPSILON) {
+        triangle->normal = gZeroVec;
+        triangle->plane_d = 0.0f;
+        triangle->bary_e11 = 0.0f;
+        triangle->bary_e12 = 0.0f;
+        triangle->bary_e22 = 0.0f;
+        return;
+    }
+
+    // Use the exact plane of the vertices, oriented like the exported normal
+    vector3Normalize(&face_normal, &triangle->normal);
+    if (vector3Dot(&triangle->normal, normal) < 0.0f) {
+        vector3Negate(&triangle->normal, &triangle->normal);
+    }
+    triangle->plane_d = vector3Dot(&triangle->normal, v0);
+
+    float inv_determinant = 1.0f / determinant;
+    triangle->bary_e11 = e11 * inv_determinant;
+    triangle->bary_e12 = e12 * inv_determinant;
+    triangle->bary_e22 = e22 * inv_determinant;
+}
+
+void mesh_triangle_get_vertex(const struct mesh_triangle* triangle, int index, Vector3* output) {
+    *output = triangle->v0;
+    if (index == 1) {
+        vector3Add(output, &triangle->edge1, output);
+    } else if (index == 2) {
+        vector3Add(output, &triangle->edge2, output);
+    }
+}
+
+// ============================================================================
+// Compact meshes
+// ============================================================================
+
+static struct mesh_triangle decode_cache_triangles[MESH_COLLIDER_DECODE_CACHE_SIZE];
+static const struct mesh_collider* decode_cache_meshes[MESH_COLLIDER_DECODE_CACHE_SIZE];
+static uint16_t decode_cache_indices[MESH_COLLIDER_DECODE_CACHE_SIZE];
+
+void mesh_collider_decode_vertex(const struct mesh_collider* mesh, int index, Vector3* output) {
+    const struct mesh_compact_vertex* vertex = &mesh->compact_vertices[index];
+    output->x = mesh->compact_origin.x + vertex->v[0] * mesh->compact_scale.x;
+    output->y = mesh->compact_origin.y + vertex->v[1] * mesh->compact_scale.y;
+    output->z = mesh->compact_origin.z + vertex->v[2] * mesh->compact_scale.z;
+}
+
+struct mesh_triangle* mesh_collider_decode_triangle(const struct mesh_collider* mesh, int index) {
+    int slot = index & (MESH_COLLIDER_DECODE_CACHE_SIZE - 1);
+    struct mesh_triangle* triangle = &decode_cache_triangles[slot];
+
+    if (decode_cache_meshes[slot] == mesh && decode_cache_indices[slot] == index) {
+        return triangle;
+    }
+
+    const struct mesh_compact_triangle* compact = &mesh->compact_triangles[index];
+    Vector3 v0, v1, v2, normal;
+    mesh_collider_decode_vertex(mesh, compact->indices[0], &v0);
+    mesh_collider_decode_vertex(mesh, compact->indices[1], &v1);
+    mesh_collider_decode_vertex(mesh, compact->indices[2], &v2);
+    vector3FromOctahedral(compact->normal, &normal);
+    mesh_triangle_init(triangle, &v0, &v1, &v2, &normal);
+
+    decode_cache_meshes[slot] = mesh;
+    decode_cache_indices[slot] = index;
+    return triangle;
+}
+
+void mesh_collider_clear_decode_cache(const struct mesh_collider* mesh) {
+    for (int i = 0; i < MESH_COLLIDER_DECODE_CACHE_SIZE; i++) {
+        if (decode_cache_meshes[i] == mesh) {
+            decode_cache_meshes[i] = NULL;
+        }
+    }
+}
+
 void mesh_triangle_gjk_support_function(const void* data, const Vector3* direction, Vector3* output) {
-    struct mesh_triangle* triangle = (struct mesh_triangle*)data;
+    const struct mesh_triangle* triangle = (const struct mesh_triangle*)data;
 
-    int idx = 0;
-    float distance = vector3Dot(&triangle->vertices[triangle->triangle.indices[0]], direction);
+    // the support distances relative to v0, v0 itself has distance 0
+    float distance = 0.0f;
+    const Vector3* edge = NULL;
 
-    float check = vector3Dot(&triangle->vertices[triangle->triangle.indices[1]], direction);
+    float check = vector3Dot(&triangle->edge1, direction);
 
     if (check > distance) {
-        idx = 1;
+        edge = &triangle->edge1;
         distance = check;
     }
 
-    check = vector3Dot(&triangle->vertices[triangle->triangle.indices[2]], direction);
+    check = vector3Dot(&triangle->edge2, direction);
 
     if (check > distance) {
-        idx = 2;
+        edge = &triangle->edge2;
     }
 
-    *output = triangle->vertices[triangle->triangle.indices[idx]];
+    *output = triangle->v0;
+    if (edge) {
+        vector3Add(output, edge, output);
+    }
 }
 
 /// @brief Check if a point is in front of or behind a triangle
@@ -38,10 +132,8 @@ void mesh_triangle_gjk_support_function(const void* data, const Vector3* directi
 /// @param triangle 
 /// @param point 
 /// @return 
-float mesh_triangle_comparePoint(struct mesh_triangle *triangle, Vector3* point){
-    Vector3 toPoint = *point;
-    vector3SubFromSelf(&toPoint, &triangle->vertices[triangle->triangle.indices[0]]);
-    return vector3Dot(&triangle->normal, &toPoint);
+float mesh_triangle_comparePoint(const struct mesh_triangle *triangle, const Vector3* point){
+    return vector3Dot(&triangle->normal, point) - triangle->plane_d;
 }
 
 bool is_inf(float value) {
@@ -6,32 +6,100 @@
 
 #include "../math/vector3.h"
 #include "../math/aabb.h"
-#include "aabb_tree.h"
+#include "mesh_bvh.h"
 #include "../render/defs.h"
 
 struct mesh_triangle_indices {
     uint16_t indices[3];
 };
 
+/// @brief Precomputed triangle of a mesh collider (64 bytes).
+///
+/// A welded mesh has about half as many vertices as triangles, so the indexed layout took about 24 bytes per triangle
+/// and this one takes about 2.7 times that. The loader logs both sizes of every mesh.
+/// The loader stores the triangles in BVH leaf order, so candidates of a query are read from one
+/// contiguous array without index or normal indirection.
+struct mesh_triangle {
+    Vector3 v0;
+    Vector3 edge1; // v1 - v0
+    Vector3 edge2; // v2 - v0
+    Vector3 normal; // unit plane normal, zero for degenerate triangles
+    float plane_d; // plane offset, dot(normal, v0)
+    // edge dot products divided by the determinant of the edge Gram matrix, used to get the barycentric
+    // coordinates of a point on the plane without a division
+    float bary_e11;
+    float bary_e12;
+    float bary_e22;
+};
+
+#define MESH_COLLIDER_DECODE_CACHE_SIZE 32 // decoded triangles kept for compact meshes, power of two
+
+/// @brief Vertex of a compact mesh, quantized over the mesh bounds
+struct mesh_compact_vertex {
+    int16_t v[3];
+};
+
+/// @brief Triangle of a compact mesh (8 bytes)
+struct mesh_compact_triangle {
+    uint16_t indices[3];
+    uint16_t normal; // octahedral encoded face normal
+};
+
 struct mesh_collider {
-    struct AABB_tree aabbtree;
-    Vector3* vertices;
-    struct mesh_triangle_indices* triangles;
-    Vector3* normals;
+    mesh_bvh bvh;
+    struct mesh_triangle* triangles; // in BVH leaf order, NULL for compact meshes
+    // compact meshes only keep the quantized vertices and decode triangles on demand
+    struct mesh_compact_triangle* compact_triangles; // in BVH leaf order
+    struct mesh_compact_vertex* compact_vertices;
+    Vector3 compact_origin; // world position of the quantized value 0
+    Vector3 compact_scale; // world units per quantized unit for each axis
     uint16_t triangle_count;
-    uint16_t vertex_count;
     Vector3* offset;
     float scale;
 };
 
-struct mesh_triangle {
-    Vector3* vertices;
-    Vector3 normal;
-    struct mesh_triangle_indices triangle;
-};
 
+/// @brief Precompute the triangle data from its vertices
+/// @param triangle 
+/// @param v0 
+/// @param v1 
+/// @param v2 
+/// @param normal the exported face normal, only used to orient the plane normal (may be zero)
+void mesh_triangle_init(struct mesh_triangle* triangle, const Vector3* v0, const Vector3* v1, const Vector3* v2, const Vector3* normal);
+
+/// @brief Returns the corner of the triangle with the given index (0-2)
+/// @param triangle 
+/// @param index 
+/// @param output 
+void mesh_triangle_get_vertex(const struct mesh_triangle* triangle, int index, Vector3* output);
+
+/// @brief Returns the world position of a vertex of a compact mesh
+/// @param mesh 
+/// @param index 
+/// @param output 
+void mesh_collider_decode_vertex(const struct mesh_collider* mesh, int index, Vector3* output);
+
+/// @brief Decodes a triangle of a compact mesh through a small direct mapped cache.
+/// The returned triangle stays valid until another triangle mapping to the same cache slot is decoded.
+/// @param mesh 
+/// @param index the triangle index in BVH leaf order
+struct mesh_triangle* mesh_collider_decode_triangle(const struct mesh_collider* mesh, int index);
+
+/// @brief Drops the decoded triangles of a mesh from the cache, called when a compact mesh is released
+/// @param mesh 
+void mesh_collider_clear_decode_cache(const struct mesh_collider* mesh);
+
+/// @brief Returns the precomputed triangle with the given index, decoding it if the mesh is compact
+/// @param mesh 
+/// @param index the triangle index in BVH leaf order
+static inline struct mesh_triangle* mesh_collider_get_triangle(const struct mesh_collider* mesh, int index) {
+    if (mesh->triangles) {
+        return &mesh->triangles[index];
+    }
+    return mesh_collider_decode_triangle(mesh, index);
+}
 
 void mesh_triangle_gjk_support_function(const void* data, const Vector3* direction, Vector3* output);
-float mesh_triangle_comparePoint(struct mesh_triangle *triangle, Vector3 *point);
+float mesh_triangle_comparePoint(const struct mesh_triangle *triangle, const Vector3 *point);
 
 #endif
\ No newline at end of file
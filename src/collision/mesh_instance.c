@@ -0,0 +1,182 @@
+#include "mesh_instance.h"
+
+#include <assert.h>
+#include <math.h>
+
+/// @brief Transforms a point from mesh space to world space
+static void mesh_instance_point_to_world(const struct mesh_instance* instance, const Vector3* in, Vector3* out) {
+    Vector3 scaled;
+    vector3Scale(in, &scaled, instance->scale);
+    matrix3Vec3Mul(&instance->_rotation_matrix, &scaled, out);
+    vector3AddToSelf(out, &instance->position);
+}
+
+/// @brief Rotates a direction from mesh space to world space
+static void mesh_instance_direction_to_world(const struct mesh_instance* instance, const Vector3* in, Vector3* out) {
+    matrix3Vec3Mul(&instance->_rotation_matrix, in, out);
+}
+
+/// @brief Rotates a direction from world space to mesh space, the inverse rotation is the transposed matrix
+static void mesh_instance_direction_to_local(const struct mesh_instance* instance, const Vector3* in, Vector3* out) {
+    const Matrix3x3* m = &instance->_rotation_matrix;
+    Vector3 result;
+    result.x = m->m[0][0] * in->x + m->m[0][1] * in->y + m->m[0][2] * in->z;
+    result.y = m->m[1][0] * in->x + m->m[1][1] * in->y + m->m[1][2] * in->z;
+    result.z = m->m[2][0] * in->x + m->m[2][1] * in->y + m->m[2][2] * in->z;
+    *out = result;
+}
+
+/// @brief Transforms the extents of a box with a rotation matrix, scaling the result
+static void mesh_instance_transform_box(const Matrix3x3* m, bool transpose, const Vector3* center, const Vector3* extent, float scale, Vector3* out_center, Vector3* out_extent) {
+    for (int row = 0; row < 3; row++) {
+        out_center->v[row] = 0.0f;
+        out_extent->v[row] = 0.0f;
+        for (int column = 0; column < 3; column++) {
+            float value = transpose ? m->m[row][column] : m->m[column][row];
+            out_center->v[row] += value * center->v[column];
+            out_extent->v[row] += fabsf(value) * extent->v[column];
+        }
+        out_center->v[row] *= scale;
+        out_extent->v[row] *= scale;
+    }
+}
+
+/// @brief Recomputes the cached rotation and the world bounds from the mesh bounds
+static void mesh_instance_update(struct mesh_instance* instance) {
+    quatToMatrix3(&instance->rotation, &instance->_rotation_matrix);
+
+    const AABB* bounds = &instance->mesh->bvh.bounds;
+    Vector3 center, extent;
+    vector3Add(&bounds->min, &bounds->max, &center);
+    vector3Scale(&center, &center, 0.5f);
+    vector3Sub(&bounds->max, &center, &extent);
+
+    Vector3 world_center, world_extent;
+    mesh_instance_transform_box(&instance->_rotation_matrix, false, &center, &extent, instance->scale, &world_center, &world_extent);
+    vector3AddToSelf(&world_center, &instance->position);
+    vector3Sub(&world_center, &world_extent, &instance->world_bounds.min);
+    vector3Add(&world_center, &world_extent, &instance->world_bounds.max);
+}
+
+void mesh_instance_init(struct mesh_instance* instance, struct mesh_collider* mesh, const Vector3* position, const Quaternion* rotation, float scale) {
+    assert(scale > 0.0f);
+    instance->mesh = mesh;
+    instance->entity_id = entity_id_new();
+    instance->position = *position;
+    instance->rotation = *rotation;
+    instance->scale = scale;
+    instance->velocity = gZeroVec;
+    instance->angular_velocity = gZeroVec;
+    instance->_inv_scale = 1.0f / scale;
+    instance->_aabb_tree_node_id = AABB_TREE_NULL_NODE;
+    mesh_instance_update(instance);
+}
+
+void mesh_instance_set_transform(struct mesh_instance* instance, const Vector3* position, const Quaternion* rotation) {
+    instance->position = *position;
+    instance->rotation = *rotation;
+    mesh_instance_update(instance);
+}
+
+void mesh_instance_move(struct mesh_instance* instance, const Vector3* position, const Quaternion* rotation, float time_step) {
+    assert(time_step > 0.0f);
+    float inv_time_step = 1.0f / time_step;
+
+    vector3Sub(position, &instance->position, &instance->velocity);
+    vector3Scale(&instance->velocity, &instance->velocity, inv_time_step);
+
+    // the rotation of the step is new * old^-1, taking the shorter way around
+    Quaternion inverse, delta;
+    quatConjugate(&instance->rotation, &inverse);
+    quatMultiply(rotation, &inverse, &delta);
+    if (delta.w < 0.0f) {
+        delta = (Quaternion){{-delta.x, -delta.y, -delta.z, -delta.w}};
+    }
+
+    Vector3 axis = {{delta.x, delta.y, delta.z}};
+    float sin_half_angle = sqrtf(vector3MagSqrd(&axis));
+    if (sin_half_angle < 0.0001f) {
+        instance->angular_velocity = gZeroVec;
+    } else {
+        float angle = 2.0f * atan2f(sin_half_angle, delta.w);
+        vector3Scale(&axis, &instance->angular_velocity, angle * inv_time_step / sin_half_angle);
+    }
+
+    mesh_instance_set_transform(instance, position, rotation);
+}
+
+void mesh_instance_anchor_from_world(const struct mesh_instance* instance, const Vector3* point, Vector3* out) {
+    Vector3 offset;
+    vector3Sub(point, &instance->position, &offset);
+    mesh_instance_direction_to_local(instance, &offset, out);
+}
+
+void mesh_instance_anchor_to_world(const struct mesh_instance* instance, const Vector3* anchor, Vector3* out) {
+    mesh_instance_direction_to_world(instance, anchor, out);
+    vector3AddToSelf(out, &instance->position);
+}
+
+void mesh_instance_point_velocity(const struct mesh_instance* instance, const Vector3* point, Vector3* out) {
+    Vector3 offset, rotational;
+    vector3Sub(point, &instance->position, &offset);
+    vector3Cross(&instance->angular_velocity, &offset, &rotational);
+    vector3Add(&instance->velocity, &rotational, out);
+}
+
+void mesh_instance_box_to_local(const struct mesh_instance* instance, const AABB* world_box, AABB* out) {
+    Vector3 center, extent;
+    vector3Add(&world_box->min, &world_box->max, &center);
+    vector3Scale(&center, &center, 0.5f);
+    vector3Sub(&world_box->max, &center, &extent);
+    vector3SubFromSelf(&center, &instance->position);
+
+    Vector3 local_center, local_extent;
+    mesh_instance_transform_box(&instance->_rotation_matrix, true, &center, &extent, instance->_inv_scale, &local_center, &local_extent);
+    vector3Sub(&local_center, &local_extent, &out->min);
+    vector3Add(&local_center, &local_extent, &out->max);
+}
+
+void mesh_instance_ray_to_local(const struct mesh_instance* instance, const raycast* ray, raycast* out) {
+    *out = *ray;
+
+    Vector3 offset;
+    vector3Sub(&ray->origin, &instance->position, &offset);
+    mesh_instance_direction_to_local(instance, &offset, &out->origin);
+    vector3Scale(&out->origin, &out->origin, instance->_inv_scale);
+
+    mesh_instance_direction_to_local(instance, &ray->dir, &out->dir);
+    out->_invDir.x = safeInvert(out->dir.x);
+    out->_invDir.y = safeInvert(out->dir.y);
+    out->_invDir.z = safeInvert(out->dir.z);
+    out->maxDistance = ray->maxDistance * instance->_inv_scale;
+}
+
+void mesh_instance_hit_to_world(const struct mesh_instance* instance, raycast_hit* hit) {
+    Vector3 point = hit->point;
+    Vector3 normal = hit->normal;
+    mesh_instance_point_to_world(instance, &point, &hit->point);
+    mesh_instance_direction_to_world(instance, &normal, &hit->normal);
+    hit->distance *= instance->scale;
+    hit->hit_entity_id = instance->entity_id;
+}
+
+void mesh_instance_get_triangle(const struct mesh_instance* instance, int index, struct mesh_triangle* out) {
+    const struct mesh_triangle* triangle = mesh_collider_get_triangle(instance->mesh, index);
+
+    mesh_instance_point_to_world(instance, &triangle->v0, &out->v0);
+
+    Vector3 scaled;
+    vector3Scale(&triangle->edge1, &scaled, instance->scale);
+    mesh_instance_direction_to_world(instance, &scaled, &out->edge1);
+    vector3Scale(&triangle->edge2, &scaled, instance->scale);
+    mesh_instance_direction_to_world(instance, &scaled, &out->edge2);
+
+    // rotation keeps the normal a unit vector, the barycentric terms scale with 1 / scale^2
+    mesh_instance_direction_to_world(instance, &triangle->normal, &out->normal);
+    out->plane_d = vector3Dot(&out->normal, &out->v0);
+
+    float inv_scale_sq = instance->_inv_scale * instance->_inv_scale;
+    out->bary_e11 = triangle->bary_e11 * inv_scale_sq;
+    out->bary_e12 = triangle->bary_e12 * inv_scale_sq;
+    out->bary_e22 = triangle->bary_e22 * inv_scale_sq;
+}
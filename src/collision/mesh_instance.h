@@ -0,0 +1,104 @@
+#ifndef __COLLISION_MESH_INSTANCE_H__
+#define __COLLISION_MESH_INSTANCE_H__
+
+#include "../math/vector3.h"
+#include "../math/quaternion.h"
+#include "../math/matrix.h"
+#include "../math/aabb.h"
+#include "aabb_tree.h"
+#include "mesh_collider.h"
+#include "raycast.h"
+#include "../entity/entity_id.h"
+
+#define MAX_MESH_INSTANCES 32
+#define MESH_INSTANCE_MAX_QUERY_RESULTS 8 // instances tested for a single object or ray
+#define MESH_INSTANCE_MAX_WAKE_RESULTS 16 // sleeping objects woken in the bounds of a moving instance
+
+/// @brief A placed copy of a static mesh collider.
+///
+/// Many instances can share one mesh collider, its BVH and triangles stay in mesh space. The scene keeps the
+/// instances in a top-level AABB tree, so moving an instance only updates its node in that tree.
+/// The scale is uniform so distances along rays and contact normals carry over between both spaces.
+/// An instance that moves carries its velocity of the last physics step, so objects resting on it are moved along.
+struct mesh_instance {
+    struct mesh_collider* mesh; // the shared bottom-level collider
+    entity_id entity_id; // identifies the contacts and ray hits of this instance
+    Vector3 position;
+    Quaternion rotation;
+    float scale;
+    Vector3 velocity; // world space velocity of the last move
+    Vector3 angular_velocity; // world space angular velocity of the last move
+
+    Matrix3x3 _rotation_matrix; // cached when the transform changes
+    float _inv_scale;
+    AABB world_bounds;
+    node_proxy _aabb_tree_node_id; // the node id of the instance in the mesh instance tree of the collision scene
+};
+
+
+/// @brief Initializes a mesh instance and computes its world bounds
+/// @param instance
+/// @param mesh the shared mesh collider
+/// @param position
+/// @param rotation
+/// @param scale uniform scale, must be > 0
+void mesh_instance_init(struct mesh_instance* instance, struct mesh_collider* mesh, const Vector3* position, const Quaternion* rotation, float scale);
+
+/// @brief Sets the transform of an instance and recomputes its world bounds.
+/// Use collision_scene_move_mesh_instance for instances that were added to the scene.
+/// @param instance
+/// @param position
+/// @param rotation
+void mesh_instance_set_transform(struct mesh_instance* instance, const Vector3* position, const Quaternion* rotation);
+
+/// @brief Moves an instance over a time step and keeps the velocity of the move.
+/// Use collision_scene_move_mesh_instance for instances that were added to the scene.
+/// @param instance
+/// @param position
+/// @param rotation
+/// @param time_step the time the move takes in seconds, must be > 0
+void mesh_instance_move(struct mesh_instance* instance, const Vector3* position, const Quaternion* rotation, float time_step);
+
+/// @brief Converts a world space point to a contact anchor that moves with the instance.
+/// Anchors are rotated and translated but not scaled, so distances between anchors are the same as in world space.
+/// @param instance
+/// @param point
+/// @param out
+void mesh_instance_anchor_from_world(const struct mesh_instance* instance, const Vector3* point, Vector3* out);
+
+/// @brief Converts a contact anchor back to world space at the current transform of the instance
+/// @param instance
+/// @param anchor
+/// @param out
+void mesh_instance_anchor_to_world(const struct mesh_instance* instance, const Vector3* anchor, Vector3* out);
+
+/// @brief Returns the velocity of the surface of an instance at a world space point
+/// @param instance
+/// @param point
+/// @param out
+void mesh_instance_point_velocity(const struct mesh_instance* instance, const Vector3* point, Vector3* out);
+
+/// @brief Returns a box in mesh space enclosing a world space box
+/// @param instance
+/// @param world_box
+/// @param out
+void mesh_instance_box_to_local(const struct mesh_instance* instance, const AABB* world_box, AABB* out);
+
+/// @brief Transforms a ray into mesh space, the distances along the local ray are scaled by 1 / scale
+/// @param instance
+/// @param ray
+/// @param out
+void mesh_instance_ray_to_local(const struct mesh_instance* instance, const raycast* ray, raycast* out);
+
+/// @brief Transforms a hit of a mesh space ray back to world space
+/// @param instance
+/// @param hit
+void mesh_instance_hit_to_world(const struct mesh_instance* instance, raycast_hit* hit);
+
+/// @brief Returns a triangle of the shared mesh transformed into world space
+/// @param instance
+/// @param index the triangle index in BVH leaf order
+/// @param out
+void mesh_instance_get_triangle(const struct mesh_instance* instance, int index, struct mesh_triangle* out);
+
+#endif // __COLLISION_MESH_INSTANCE_H__
@@ -1,4 +1,5 @@
 #include "physics_object.h"
+#include "collision_scene.h"
 #include <assert.h>
 #include "../time/time.h"
 #include "../math/minmax.h"
@@ -39,7 +40,6 @@ void physics_object_init(
     object->constraints = CONSTRAINTS_NONE;
     object->collision_layers = collision_layers;
     object->collision_group = COLLISION_GROUP_NONE;
-    object->active_contacts = NULL;
     object->angular_damping = 0.03f * (60.0f/PHYSICS_TICKRATE);
     object->angular_velocity = gZeroVec;
     object->_torque_accumulator = gZeroVec;
@@ -174,15 +174,23 @@ void physics_object_integrate_angular_velocity(physics_object* object) {
 }
 
 void physics_object_integrate_position(physics_object* object) {
+    physics_object_integrate_position_substep(object, 1.0f);
+}
+
+void physics_object_integrate_position_substep(physics_object* object, float step_fraction) {
     if (object->is_trigger || object->is_kinematic) return;
 
     // Update position using current velocity
-    vector3AddScaled(object->position, &object->velocity, FIXED_DELTATIME * object->time_scalar, object->position);
+    vector3AddScaled(object->position, &object->velocity, FIXED_DELTATIME * step_fraction * object->time_scalar, object->position);
 
     object->is_grounded = false;
 }
 
 void physics_object_integrate_rotation(physics_object* object) {
+    physics_object_integrate_rotation_substep(object, 1.0f);
+}
+
+void physics_object_integrate_rotation_substep(physics_object* object, float step_fraction) {
     if (object->is_trigger || object->is_kinematic ||!object->rotation) return;
 
     // Calculate rotated center offset before rotation
@@ -191,7 +199,7 @@ void physics_object_integrate_rotation(physics_object* object) {
 
     // Apply angular velocity to rotation quaternion
     quatApplyAngularVelocity(object->rotation, &object->angular_velocity,
-                            FIXED_DELTATIME * object->time_scalar, object->rotation);
+                            FIXED_DELTATIME * step_fraction * object->time_scalar, object->rotation);
     quatNormalize(object->rotation, object->rotation);
 
     // Calculate rotated center offset after rotation
@@ -304,21 +312,23 @@ void physics_object_set_angular_velocity(physics_object* object, Vector3* angula
 }
 
 
-contact* physics_object_nearest_contact(physics_object* object) {
-    contact* nearest_target = NULL;
-    contact* current = object->active_contacts;
+const contact_event* physics_object_nearest_contact(physics_object* object) {
+    struct collision_scene* scene = collision_scene_get_instance();
+    const contact_event* nearest_target = NULL;
     float distance = 0.0f;
 
-    while (current) {
-        if (current->constraint->point_count > 0) {
-            float check = vector3DistSqrd(&current->constraint->points[0].point, object->position);
-            if (!nearest_target || check < distance) {
-                distance = check;
-                nearest_target = current;
-            }
+    for (int i = 0; i < scene->contact_event_count; i++) {
+        const contact_event* current = &scene->contact_events[i];
+
+        if (current->type == CONTACT_EVENT_END || !contact_event_has_entity(current, object->entity_id)) {
+            continue;
         }
 
-        current = current->next;
+        float check = vector3DistSqrd(&current->point, object->position);
+        if (!nearest_target || check < distance) {
+            distance = check;
+            nearest_target = current;
+        }
     }
 
     return nearest_target;
@@ -326,14 +336,15 @@ contact* physics_object_nearest_contact(physics_object* object) {
 
 
 bool physics_object_is_touching(physics_object* object, entity_id id) {
-    contact* current = object->active_contacts;
+    struct collision_scene* scene = collision_scene_get_instance();
+    contact_pair_id pid = contact_pair_id_get(object->entity_id, id);
+
+    for (int i = 0; i < scene->contact_event_count; i++) {
+        const contact_event* current = &scene->contact_events[i];
 
-    while (current) {
-        if (current->other_object->entity_id == id) {
+        if (current->pid == pid && current->type != CONTACT_EVENT_END) {
             return true;
         }
-            
-        current = current->next;
     }
 
     return false;
@@ -79,7 +79,9 @@ typedef enum physics_object_collision_shape_type {
     COLLISION_SHAPE_CONE,
     COLLISION_SHAPE_CYLINDER,
     COLLISION_SHAPE_SWEEP,
-    COLLISION_SHAPE_PYRAMID
+    COLLISION_SHAPE_PYRAMID,
+    COLLISION_SHAPE_COMPOUND,
+    COLLISION_SHAPE_HULL
 } physics_object_collision_shape_type;
 
 /// @brief Flags for physics_object constraints
@@ -98,6 +100,9 @@ typedef enum physics_object_constraints {
     CONSTRAINTS_ALL = 0xff
 } physics_object_constraints;
 
+struct compound_collider;
+struct convex_hull;
+
 /// @brief Defines the parameters necessary to describe a collision shape
 union physics_object_collision_shape_data
 {
@@ -108,6 +113,8 @@ union physics_object_collision_shape_data
     struct { float radius; float half_height; } cylinder;
     struct { Vector2 range; float radius; float half_height; } sweep;
     struct { Vector2 base_half_widths; float half_height; } pyramid;
+    struct { struct compound_collider* collider; } compound;
+    struct { struct convex_hull* hull; } hull;
 };
 
 /// @brief Defines a set of functions and data to describe a collider.
@@ -141,7 +148,6 @@ typedef struct __attribute__((aligned(16))) physics_object {
     AABB bounding_box; // the bounding box fitting the object collider, used for broad phase collision detection
     Vector3 center_offset; // offset from the origin of the object to the center of the collision shape
     struct physics_object_collision_data* collision; // information about the collision shape
-    contact* active_contacts; // contacts with other objects from the last physics step
     
     Matrix3x3 _inv_world_inertia_tensor; // 3x3 matrix, recalculated every frame
     Matrix3x3 _rotation_matrix; // 3x3 rotation matrix, cached every frame
@@ -196,16 +202,16 @@ void physics_object_init(
 
 
 
-/// @brief iterate through the active contacts of the object and return the contact with the smallest distance to the object
+/// @brief iterate through the contact events of the last physics step and return the contact of the object with the smallest distance to it
 /// @param object the physics_object whose contacts are to be checked
-/// @return the contact with the smallest distance to the object
-contact* physics_object_nearest_contact(physics_object* object);
+/// @return the contact event with the smallest distance to the object, NULL if it has no contacts
+const contact_event* physics_object_nearest_contact(physics_object* object);
 
 
-/// @brief iterate through the active contacts of the object and check if the given entity id is in the list
+/// @brief iterate through the contact events of the last physics step and check if the object touches the given entity id
 /// @param object the physics_object whose contacts are to be checked
 /// @param id the entity id of the object to check for
-/// @return true if the object is in the list of contacts, false otherwise
+/// @return true if the objects are in contact, false otherwise
 bool physics_object_is_touching(physics_object* object, entity_id id);
 
 
@@ -245,6 +251,16 @@ void physics_object_integrate_position(physics_object* object);
 /// @param object
 void physics_object_integrate_rotation(physics_object* object);
 
+/// @brief Integrate velocity into position over a fraction of the fixed time step (used by the substepping solver)
+/// @param object
+/// @param step_fraction fraction of FIXED_DELTATIME to integrate
+void physics_object_integrate_position_substep(physics_object* object, float step_fraction);
+
+/// @brief Integrate angular velocity into rotation over a fraction of the fixed time step (used by the substepping solver)
+/// @param object
+/// @param step_fraction fraction of FIXED_DELTATIME to integrate
+void physics_object_integrate_rotation_substep(physics_object* object, float step_fraction);
+
 /// @brief Accelerates the object by the given acceleration vector. 
 /// @param object 
 /// @param acceleration 
@@ -36,7 +36,8 @@ float raycast_calc_distance_to_point(raycast* ray, Vector3* point) {
 bool raycast_cast(raycast* ray, raycast_hit* hit){
     struct collision_scene* collision_scene = collision_scene_get_instance();
     // prepare result structures for AABB_tree BVH queries
-    node_proxy results[RAYCAST_MAX_OBJECT_TESTS > RAYCAST_MAX_TRIANGLE_TESTS ? RAYCAST_MAX_OBJECT_TESTS : RAYCAST_MAX_TRIANGLE_TESTS];
+    node_proxy results[RAYCAST_MAX_OBJECT_TESTS];
+    uint16_t triangle_results[RAYCAST_MAX_TRIANGLE_TESTS];
     int result_count = 0;
     raycast_hit current_hit;
     hit->did_hit = false;
@@ -46,24 +47,54 @@ bool raycast_cast(raycast* ray, raycast_hit* hit){
     // check for intersection with the static collision scene if the mask allows it
     if(ray->mask & RAYCAST_COLLISION_SCENE_MASK_STATIC_COLLISION && collision_scene->mesh_collider != NULL){
         // query the BVH of mesh triangles for potential intersection candidates
-        AABB_tree_query_ray(&collision_scene->mesh_collider->aabbtree, ray, results, &result_count, RAYCAST_MAX_TRIANGLE_TESTS);
+        mesh_bvh_query_ray(&collision_scene->mesh_collider->bvh, ray, triangle_results, &result_count, RAYCAST_MAX_TRIANGLE_TESTS);
 
         //iterate over the results and perform the ray-triangle intersection test, update the hit object if the current result is closer
         for (size_t i = 0; i < result_count; i++)
         {
             current_hit.distance = INFINITY;
-            int triangle_index = (int)AABB_tree_get_node_data(&collision_scene->mesh_collider->aabbtree, results[i]);
-            struct mesh_triangle triangle;
-            triangle.triangle = collision_scene->mesh_collider->triangles[triangle_index];
-            triangle.normal = collision_scene->mesh_collider->normals[triangle_index];
-            triangle.vertices = collision_scene->mesh_collider->vertices;
-
-            hit->did_hit = hit->did_hit | ray_triangle_intersection(ray, &current_hit, &triangle);
+            int triangle_index = triangle_results[i];
+            hit->did_hit = hit->did_hit | ray_triangle_intersection(ray, &current_hit, mesh_collider_get_triangle(collision_scene->mesh_collider, triangle_index));
             if(current_hit.distance < hit->distance && current_hit.distance <= ray->maxDistance){
                 *hit = current_hit;
             }
         }
     }
+    // mesh instances are tested with the ray in mesh space of each instance
+    if(ray->mask & RAYCAST_COLLISION_SCENE_MASK_STATIC_COLLISION && collision_scene->mesh_instance_tree.root != AABB_TREE_NULL_NODE){
+        node_proxy instance_results[MESH_INSTANCE_MAX_QUERY_RESULTS];
+        int instance_count = 0;
+        AABB_tree_query_ray(&collision_scene->mesh_instance_tree, ray, instance_results, &instance_count, MESH_INSTANCE_MAX_QUERY_RESULTS);
+
+        for (int i = 0; i < instance_count; i++)
+        {
+            struct mesh_instance* instance = AABB_tree_get_node_data(&collision_scene->mesh_instance_tree, instance_results[i]);
+            raycast local_ray;
+            mesh_instance_ray_to_local(instance, ray, &local_ray);
+
+            result_count = 0;
+            mesh_bvh_query_ray(&instance->mesh->bvh, &local_ray, triangle_results, &result_count, RAYCAST_MAX_TRIANGLE_TESTS);
+            for (size_t j = 0; j < result_count; j++)
+            {
+                if(!ray_triangle_intersection(&local_ray, &current_hit, mesh_collider_get_triangle(instance->mesh, triangle_results[j]))){
+                    continue;
+                }
+                mesh_instance_hit_to_world(instance, &current_hit);
+                if(current_hit.distance < hit->distance && current_hit.distance <= ray->maxDistance){
+                    *hit = current_hit;
+                    hit->did_hit = true;
+                }
+            }
+        }
+    }
+
+    // the heightfield returns its closest hit directly
+    if(ray->mask & RAYCAST_COLLISION_SCENE_MASK_STATIC_COLLISION && collision_scene->heightfield != NULL){
+        if(heightfield_raycast(collision_scene->heightfield, ray, &current_hit) && current_hit.distance < hit->distance){
+            *hit = current_hit;
+            hit->did_hit = true;
+        }
+    }
     result_count = 0;
     
     // check for intersection with physics objects if the mask allows it
@@ -37,7 +37,7 @@ typedef struct raycast_hit {
     Vector3 point; // The impact point where the ray intersects the object or surface
     Vector3 normal; // The normal of the object or surface that was hit
     float distance; // The distance from the ray origin to the hit point
-    entity_id hit_entity_id; // The entity id of the object that was hit, 0 if no object was hit or the hit was against the static collision scene
+    entity_id hit_entity_id; // The entity id of the object or mesh instance that was hit, 0 if nothing was hit or the hit was against the static mesh or heightfield
     bool did_hit;
 } raycast_hit;
 
@@ -0,0 +1,236 @@
+#include "compound.h"
+
+#include <assert.h>
+#include <math.h>
+#include "../../math/minmax.h"
+
+/// @brief Returns the bounds of a child in compound space, rotated by an optional compound rotation
+static void compound_child_bounds(const struct compound_child* child, const Quaternion* rotation, AABB* box) {
+    physics_object shape;
+    shape.collision = (struct physics_object_collision_data*)&child->collision;
+
+    Quaternion child_rotation = child->rotation;
+    Vector3 offset = child->offset;
+    if (rotation) {
+        quatMultiply(rotation, &child->rotation, &child_rotation);
+        quatMultVector(rotation, &child->offset, &offset);
+    }
+
+    child->collision.bounding_box_calculator(&shape, &child_rotation, box);
+    vector3AddToSelf(&box->min, &offset);
+    vector3AddToSelf(&box->max, &offset);
+}
+
+/// @brief Builds the BVH node for a range of children, splitting at the median along the longest axis of the centers
+static int compound_build_node(struct compound_collider* compound, uint8_t* indices, AABB* child_bounds, int count) {
+    int node_index = compound->node_count++;
+    struct compound_node* node = &compound->nodes[node_index];
+
+    node->bounds = child_bounds[indices[0]];
+    for (int i = 1; i < count; i++) {
+        node->bounds = AABBUnion(&node->bounds, &child_bounds[indices[i]]);
+    }
+
+    if (count == 1) {
+        node->left = COMPOUND_NODE_LEAF;
+        node->right = indices[0];
+        return node_index;
+    }
+
+    Vector3 extent;
+    vector3Sub(&node->bounds.max, &node->bounds.min, &extent);
+    int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+    // insertion sort, there are only a few children
+    for (int i = 1; i < count; i++) {
+        uint8_t index = indices[i];
+        float key = child_bounds[index].min.v[axis] + child_bounds[index].max.v[axis];
+        int j = i - 1;
+        while (j >= 0 && child_bounds[indices[j]].min.v[axis] + child_bounds[indices[j]].max.v[axis] > key) {
+            indices[j + 1] = indices[j];
+            j--;
+        }
+        indices[j + 1] = index;
+    }
+
+    int half = count / 2;
+    int left = compound_build_node(compound, indices, child_bounds, half);
+    int right = compound_build_node(compound, indices + half, child_bounds, count - half);
+    compound->nodes[node_index].left = left;
+    compound->nodes[node_index].right = right;
+    return node_index;
+}
+
+void compound_collider_init(struct compound_collider* compound, struct compound_child* children, int child_count) {
+    assert(child_count > 0 && child_count <= COMPOUND_MAX_CHILDREN);
+    compound->children = children;
+    compound->child_count = child_count;
+    compound->node_count = 0;
+
+    AABB child_bounds[COMPOUND_MAX_CHILDREN];
+    uint8_t indices[COMPOUND_MAX_CHILDREN];
+
+    for (int i = 0; i < child_count; i++) {
+        struct compound_child* child = &children[i];
+        quatToMatrix3(&child->rotation, &child->_rotation_matrix);
+        compound_child_bounds(child, NULL, &child_bounds[i]);
+
+        Vector3 extent;
+        vector3Sub(&child_bounds[i].max, &child->offset, &extent);
+        Vector3 extent_min;
+        vector3Sub(&child->offset, &child_bounds[i].min, &extent_min);
+        vector3Max(&extent, &extent_min, &extent);
+        child->_radius = sqrtf(vector3MagSqrd(&extent));
+
+        indices[i] = i;
+    }
+
+    compound_build_node(compound, indices, child_bounds, child_count);
+}
+
+int compound_collider_query_bounds(const struct compound_collider* compound, const AABB* query_box, uint8_t* results, int max_results) {
+    int8_t stack[COMPOUND_MAX_NODES];
+    int stack_size = 0;
+    int result_count = 0;
+
+    stack[stack_size++] = 0;
+    while (stack_size > 0 && result_count < max_results) {
+        const struct compound_node* node = &compound->nodes[stack[--stack_size]];
+        if (!AABBHasOverlap(&node->bounds, query_box)) {
+            continue;
+        }
+
+        if (node->left == COMPOUND_NODE_LEAF) {
+            results[result_count++] = node->right;
+        } else {
+            stack[stack_size++] = node->left;
+            stack[stack_size++] = node->right;
+        }
+    }
+
+    return result_count;
+}
+
+void compound_box_to_local(const physics_object* object, const AABB* world_box, AABB* out) {
+    Vector3 center, extent;
+    vector3Add(&world_box->min, &world_box->max, &center);
+    vector3Scale(&center, &center, 0.5f);
+    vector3Sub(&world_box->max, &center, &extent);
+    vector3SubFromSelf(&center, &object->_world_center_of_mass);
+
+    // the inverse rotation is the transposed matrix
+    const Matrix3x3* m = &object->_rotation_matrix;
+    Vector3 local_center, local_extent;
+    for (int row = 0; row < 3; row++) {
+        local_center.v[row] = m->m[row][0] * center.x + m->m[row][1] * center.y + m->m[row][2] * center.z;
+        local_extent.v[row] = fabsf(m->m[row][0]) * extent.x + fabsf(m->m[row][1]) * extent.y + fabsf(m->m[row][2]) * extent.z;
+    }
+
+    vector3Sub(&local_center, &local_extent, &out->min);
+    vector3Add(&local_center, &local_extent, &out->max);
+}
+
+void compound_child_proxy_init(struct compound_child_proxy* proxy, const physics_object* object, int child_index) {
+    const struct compound_child* child = &object->collision->shape_data.compound.collider->children[child_index];
+
+    proxy->shape.collision = (struct physics_object_collision_data*)&child->collision;
+    matrix3Mul(&object->_rotation_matrix, &child->_rotation_matrix, &proxy->rotation);
+    matrix3Vec3Mul(&object->_rotation_matrix, &child->offset, &proxy->center);
+    vector3AddToSelf(&proxy->center, &object->_world_center_of_mass);
+    proxy->radius = child->_radius;
+}
+
+void compound_child_support_function(const void* data, const Vector3* direction, Vector3* output) {
+    const struct compound_child_proxy* proxy = (const struct compound_child_proxy*)data;
+    const Matrix3x3* m = &proxy->rotation;
+
+    Vector3 local_dir;
+    local_dir.x = m->m[0][0] * direction->x + m->m[0][1] * direction->y + m->m[0][2] * direction->z;
+    local_dir.y = m->m[1][0] * direction->x + m->m[1][1] * direction->y + m->m[1][2] * direction->z;
+    local_dir.z = m->m[2][0] * direction->x + m->m[2][1] * direction->y + m->m[2][2] * direction->z;
+    vector3Normalize(&local_dir, &local_dir);
+
+    Vector3 local_support;
+    proxy->shape.collision->gjk_support_function(&proxy->shape, &local_dir, &local_support);
+
+    matrix3Vec3Mul(m, &local_support, output);
+    vector3AddToSelf(output, &proxy->center);
+}
+
+void compound_support_function(const void* data, const Vector3* direction, Vector3* output) {
+    physics_object* object = (physics_object*)data;
+    const struct compound_collider* compound = object->collision->shape_data.compound.collider;
+    float best = -INFINITY;
+
+    for (int i = 0; i < compound->child_count; i++) {
+        const struct compound_child* child = &compound->children[i];
+        const Matrix3x3* m = &child->_rotation_matrix;
+        physics_object shape;
+        shape.collision = (struct physics_object_collision_data*)&child->collision;
+
+        Vector3 local_dir;
+        local_dir.x = m->m[0][0] * direction->x + m->m[0][1] * direction->y + m->m[0][2] * direction->z;
+        local_dir.y = m->m[1][0] * direction->x + m->m[1][1] * direction->y + m->m[1][2] * direction->z;
+        local_dir.z = m->m[2][0] * direction->x + m->m[2][1] * direction->y + m->m[2][2] * direction->z;
+
+        Vector3 local_support, support;
+        child->collision.gjk_support_function(&shape, &local_dir, &local_support);
+        matrix3Vec3Mul(m, &local_support, &support);
+        vector3AddToSelf(&support, &child->offset);
+
+        float distance = vector3Dot(&support, direction);
+        if (distance > best) {
+            best = distance;
+            *output = support;
+        }
+    }
+}
+
+void compound_bounding_box(const void* data, const Quaternion* rotation, AABB* box) {
+    physics_object* object = (physics_object*)data;
+    const struct compound_collider* compound = object->collision->shape_data.compound.collider;
+
+    compound_child_bounds(&compound->children[0], rotation, box);
+    for (int i = 1; i < compound->child_count; i++) {
+        AABB child_box;
+        compound_child_bounds(&compound->children[i], rotation, &child_box);
+        *box = AABBUnion(box, &child_box);
+    }
+}
+
+void compound_inertia_tensor(void* data, Vector3* out) {
+    physics_object* object = (physics_object*)data;
+    const struct compound_collider* compound = object->collision->shape_data.compound.collider;
+
+    float total_weight = 0.0f;
+    for (int i = 0; i < compound->child_count; i++) {
+        total_weight += compound->children[i].mass_weight;
+    }
+    assert(total_weight > 0.0f);
+
+    *out = gZeroVec;
+    for (int i = 0; i < compound->child_count; i++) {
+        const struct compound_child* child = &compound->children[i];
+        float mass = object->_mass * child->mass_weight / total_weight;
+
+        physics_object shape;
+        shape.collision = (struct physics_object_collision_data*)&child->collision;
+        shape._mass = mass;
+        Vector3 local_inertia;
+        child->collision.inertia_calculator(&shape, &local_inertia);
+
+        // diagonal of R * I * R^T, R[row][k] is m[k][row]
+        const Matrix3x3* m = &child->_rotation_matrix;
+        for (int row = 0; row < 3; row++) {
+            out->v[row] += m->m[0][row] * m->m[0][row] * local_inertia.x +
+                           m->m[1][row] * m->m[1][row] * local_inertia.y +
+                           m->m[2][row] * m->m[2][row] * local_inertia.z;
+        }
+
+        // parallel axis theorem: I += m * (|d|^2 * E - d * d^T)
+        const Vector3* d = &child->offset;
+        out->x += mass * (d->y * d->y + d->z * d->z);
+        out->y += mass * (d->x * d->x + d->z * d->z);
+        out->z += mass * (d->x * d->x + d->y * d->y);
+    }
+}
@@ -0,0 +1,132 @@
+#ifndef __COLLISION_SHAPE_COMPOUND_H__
+#define __COLLISION_SHAPE_COMPOUND_H__
+
+#include "../../math/vector3.h"
+#include "../../math/quaternion.h"
+#include "../../math/matrix.h"
+#include "../../math/aabb.h"
+#include "../physics_object.h"
+
+#define COMPOUND_MAX_CHILDREN 8
+#define COMPOUND_MAX_NODES (2 * COMPOUND_MAX_CHILDREN - 1)
+#define COMPOUND_NODE_LEAF -1 // value of left in a leaf node
+
+/// @brief A primitive that is part of a compound collider.
+///
+/// The collision data of the child holds its primitive functions and shape. Bounce and friction are taken from the
+/// compound, so they are ignored for the child.
+struct compound_child {
+    struct physics_object_collision_data collision;
+    Vector3 offset; // center of the child in the local space of the compound
+    Quaternion rotation; // rotation of the child relative to the compound
+    float mass_weight; // share of the object mass, relative to the weights of the other children
+
+    Matrix3x3 _rotation_matrix; // cached by compound_collider_init
+    float _radius; // distance from the center to the farthest corner of the local bounds
+};
+
+/// @brief A node of the local BVH over the children of a compound collider
+struct compound_node {
+    AABB bounds;
+    int8_t left; // index of the left node, COMPOUND_NODE_LEAF for leaves
+    int8_t right; // index of the right node for inner nodes, the child index for leaves
+};
+
+/// @brief A collider made of several primitives with local offsets, so non-convex props need only one body.
+///
+/// The children are positioned around the center of the compound, which is also the center of mass of the object.
+/// A small BVH over the child bounds in compound space is built once, so narrowphase only runs against the children
+/// that overlap the other collider.
+struct compound_collider {
+    struct compound_child* children;
+    uint8_t child_count;
+    uint8_t node_count;
+    struct compound_node nodes[COMPOUND_MAX_NODES]; // nodes[0] is the root
+};
+
+/// @brief A child of a compound placed in world space, used as GJK support data for narrowphase against one child.
+///
+/// The primitive functions read the shape from a physics_object, so the proxy carries one that only has its
+/// collision pointer set to the child collision data.
+struct compound_child_proxy {
+    physics_object shape;
+    Matrix3x3 rotation; // child to world rotation
+    Vector3 center; // world center of the child
+    float radius;
+};
+
+
+/// @brief Initializes a compound collider, caches the child rotations and builds the BVH over the children.
+/// @param compound
+/// @param children the children, must stay valid for the lifetime of the compound
+/// @param child_count between 1 and COMPOUND_MAX_CHILDREN
+void compound_collider_init(struct compound_collider* compound, struct compound_child* children, int child_count);
+
+/// @brief Query the compound BVH for the children whose bounds overlap a box
+/// @param compound
+/// @param query_box the box in the local space of the compound
+/// @param results the array of child indices to store the results
+/// @param max_results the maximum amount of results to find
+/// @return the amount of results found
+int compound_collider_query_bounds(const struct compound_collider* compound, const AABB* query_box, uint8_t* results, int max_results);
+
+/// @brief Returns a box in the local space of a compound object enclosing a world space box
+/// @param object the physics_object holding the compound collider
+/// @param world_box
+/// @param out
+void compound_box_to_local(const physics_object* object, const AABB* world_box, AABB* out);
+
+/// @brief Places a child of a compound object in world space.
+///
+/// Uses the cached rotation matrix and world center of mass of the object, so physics_object_update_world_inertia
+/// must have run for the current step.
+/// @param proxy
+/// @param object the physics_object holding the compound collider
+/// @param child_index
+void compound_child_proxy_init(struct compound_child_proxy* proxy, const physics_object* object, int child_index);
+
+/// @brief GJK Support function (see gjk_support_function) for a compound child placed in world space.
+/// @param data pointer to a compound_child_proxy
+/// @param direction input direction in world space
+/// @param output the support point in world space
+void compound_child_support_function(const void* data, const Vector3* direction, Vector3* output);
+
+/// @brief GJK Support function (see gjk_support_function) for the compound primitive.
+///
+/// Returns the support point of the convex hull of all children, for code that treats the object as one convex shape.
+/// The narrowphase tests the children separately using compound_child_support_function.
+/// @param data pointer to the physics_object holding the compound collider
+/// @param direction input direction (is expected to be normalized and rotated if the object has rotation)
+/// @param output the pointer of the vector to store the result
+void compound_support_function(const void* data, const Vector3* direction, Vector3* output);
+
+/// @brief Bounding Box Calculator function for the compound primitive.
+///
+/// Calculates the AABB fully containing the bounds of all (optionally rotated) children.
+/// @param data pointer to the physics_object holding the compound collider
+/// @param rotation pointer to the physics_object rotation Quaternion (may be NULL)
+/// @param box  pointer to the output AABB
+void compound_bounding_box(const void* data, const Quaternion* rotation, AABB* box);
+
+/// @brief Inertia Tensor function for the compound primitive.
+///
+/// Sums the child inertia tensors rotated into compound space and moved to the compound center with the parallel
+/// axis theorem. The object only stores a diagonal tensor, so the products of inertia are dropped.
+/// @param data pointer to the physics_object holding the compound collider
+/// @param out pointer to the 3d vector representing the inertia tensor diagonal Ixx, Iyy, Izz
+void compound_inertia_tensor(void* data, Vector3* out);
+
+
+// Predefined Compound Collider Definition, the compound must be initialized with compound_collider_init
+#define COMPOUND_COLLIDER(c)          \
+    .gjk_support_function = compound_support_function, \
+    .bounding_box_calculator = compound_bounding_box,  \
+    .inertia_calculator = compound_inertia_tensor,     \
+    .shape_type = COLLISION_SHAPE_COMPOUND, \
+    .shape_data = {                          \
+        .compound = {                       \
+            .collider = c,    \
+        },                             \
+    }
+
+#endif
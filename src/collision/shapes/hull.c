@@ -0,0 +1,74 @@
+#include "hull.h"
+
+#include "../physics_object.h"
+#include <math.h>
+
+static inline int hull_direction_octant(const Vector3* direction) {
+    return (direction->x < 0.0f ? 1 : 0) | (direction->y < 0.0f ? 2 : 0) | (direction->z < 0.0f ? 4 : 0);
+}
+
+int convex_hull_support_vertex(struct convex_hull* hull, const Vector3* direction) {
+    int octant = hull_direction_octant(direction);
+    int current = hull->_support_cache[octant];
+    float best = vector3Dot(&hull->vertices[current], direction);
+
+    // on a convex hull every local maximum of the vertex graph is the global maximum
+    bool improved = true;
+    while (improved) {
+        improved = false;
+
+        // the neighbors of the vertex the scan started from, the scan restarts from the first better neighbor
+        int start = hull->adjacency_offsets[current];
+        int end = hull->adjacency_offsets[current + 1];
+
+        for (int i = start; i < end; i++) {
+            int neighbor = hull->adjacency[i];
+            float distance = vector3Dot(&hull->vertices[neighbor], direction);
+            if (distance > best) {
+                best = distance;
+                current = neighbor;
+                improved = true;
+                break;
+            }
+        }
+    }
+
+    hull->_support_cache[octant] = current;
+    return current;
+}
+
+void hull_support_function(const void* data, const Vector3* direction, Vector3* output) {
+    physics_object* object = (physics_object*)data;
+    struct convex_hull* hull = object->collision->shape_data.hull.hull;
+
+    *output = hull->vertices[convex_hull_support_vertex(hull, direction)];
+}
+
+void hull_bounding_box(const void* data, const Quaternion* q, AABB* box) {
+    physics_object* object = (physics_object*)data;
+    struct convex_hull* hull = object->collision->shape_data.hull.hull;
+
+    Matrix3x3 rotation;
+    if (q) {
+        quatToMatrix3(q, &rotation);
+    } else {
+        matrix3Identity(&rotation);
+    }
+
+    for (int axis = 0; axis < 3; axis++) {
+        // the world axis in hull space is a row of the rotation matrix
+        Vector3 local_axis = {{rotation.m[0][axis], rotation.m[1][axis], rotation.m[2][axis]}};
+        Vector3 negative_axis;
+        vector3Negate(&local_axis, &negative_axis);
+
+        box->max.v[axis] = vector3Dot(&hull->vertices[convex_hull_support_vertex(hull, &local_axis)], &local_axis);
+        box->min.v[axis] = -vector3Dot(&hull->vertices[convex_hull_support_vertex(hull, &negative_axis)], &negative_axis);
+    }
+}
+
+void hull_inertia_tensor(void* data, Vector3* out) {
+    physics_object* object = (physics_object*)data;
+    struct convex_hull* hull = object->collision->shape_data.hull.hull;
+
+    vector3Scale(&hull->unit_inertia, out, object->_mass);
+}
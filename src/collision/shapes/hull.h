@@ -0,0 +1,69 @@
+#ifndef __COLLISION_SHAPE_HULL_H__
+#define __COLLISION_SHAPE_HULL_H__
+
+#include <stdint.h>
+#include "../../math/vector3.h"
+#include "../../math/quaternion.h"
+#include "../../math/aabb.h"
+
+#define HULL_SUPPORT_CACHE_SIZE 8 // one warm start vertex per direction octant
+#define HULL_MAX_VERTICES 256 // the adjacency and the support cache store vertex indices in 8 bits
+
+/// @brief A convex hull built offline from model geometry (see tools/collision_export/hull_export.py).
+///
+/// Only the vertices and the vertex adjacency are stored. The support function walks the vertex graph uphill
+/// from the vertex found last for the same direction octant, which usually takes a step or two between frames.
+/// The vertices are centered on the centroid of the hull, use center as the center_offset of the physics object.
+struct convex_hull {
+    Vector3* vertices;
+    uint16_t* adjacency_offsets; // the neighbors of vertex i are adjacency[adjacency_offsets[i]] up to adjacency_offsets[i + 1]
+    uint8_t* adjacency;
+    uint16_t vertex_count;
+    Vector3 center; // centroid of the hull in model space
+    Vector3 unit_inertia; // inertia tensor diagonal for a mass of 1
+    uint8_t _support_cache[HULL_SUPPORT_CACHE_SIZE];
+};
+
+/// @brief Returns the index of the hull vertex furthest in a direction, by hill climbing from the cached vertex
+/// @param hull
+/// @param direction the direction in hull space, does not need to be normalized
+/// @return the vertex index
+int convex_hull_support_vertex(struct convex_hull* hull, const Vector3* direction);
+
+/// @brief GJK Support function (see gjk_support_function) for the hull primitive.
+///
+/// Will return the hull vertex furthest in the input direction.
+/// @param data pointer to the physics_object holding the hull collider
+/// @param direction input direction (is expected to be normalized and rotated if the object has rotation)
+/// @param output the pointer of the vector to store the result
+void hull_support_function(const void* data, const Vector3* direction, Vector3* output);
+
+/// @brief Bounding Box Calculator function for the hull primitive.
+///
+/// Calculates the AABB fully containing the (optionally rotated) hull from the support vertices along the world axes.
+/// @param data pointer to the physics_object holding the hull collider
+/// @param rotation pointer to the physics_object rotation Quaternion (may be NULL)
+/// @param box  pointer to the output AABB
+void hull_bounding_box(const void* data, const Quaternion* rotation, AABB* box);
+
+/// @brief Inertia Tensor function for the hull primitive.
+///
+/// Scales the inertia computed by the exporter with the object mass.
+/// @param data pointer to the physics_object holding the hull collider
+/// @param out pointer to the 3d vector representing the inertia tensor diagonal Ixx, Iyy, Izz
+void hull_inertia_tensor(void* data, Vector3* out);
+
+
+// Predefined Hull Collider Definition, the hull must be loaded with convex_hull_load
+#define HULL_COLLIDER(h)          \
+    .gjk_support_function = hull_support_function, \
+    .bounding_box_calculator = hull_bounding_box,  \
+    .inertia_calculator = hull_inertia_tensor,     \
+    .shape_type = COLLISION_SHAPE_HULL, \
+    .shape_data = {                          \
+        .hull = {                       \
+            .hull = h,    \
+        },                             \
+    }
+
+#endif
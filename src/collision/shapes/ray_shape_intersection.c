@@ -1,4 +1,5 @@
 #include "ray_shape_intersection.h"
+#include "compound.h"
 #include "../../math/mathf.h"
 #include <math.h>
 #include <float.h>
@@ -610,70 +611,67 @@ bool ray_cone_intersection(
     return true;
 }
 
-bool ray_physics_object_intersection(
-    raycast* ray, 
-    physics_object* object, 
-    raycast_hit* hit
+/// @brief Dispatches to the intersection function of a primitive shape
+static bool ray_collision_shape_intersection(
+    raycast* ray,
+    struct physics_object_collision_data* collision,
+    Vector3* collider_center,
+    Quaternion* rotation,
+    raycast_hit* hit,
+    entity_id entity_id
 ) {
-    // Get the object's collision data
-    struct physics_object_collision_data* collision = object->collision;
-    
-    // Calculate the world center of the collider
-    Vector3 collider_center;
-    vector3Add(object->position, &object->center_offset, &collider_center);
-    
     // Dispatch to the appropriate shape-specific intersection function
     switch (collision->shape_type) {
         case COLLISION_SHAPE_SPHERE:
             return ray_sphere_intersection(
                 ray, 
-                &collider_center, 
+                collider_center, 
                 collision->shape_data.sphere.radius, 
                 hit,
-                object->entity_id
+                entity_id
             );
             
         case COLLISION_SHAPE_BOX:
             return ray_box_intersection(
                 ray, 
-                &collider_center, 
+                collider_center, 
                 &collision->shape_data.box.half_size, 
-                object->rotation, 
+                rotation, 
                 hit,
-                object->entity_id
+                entity_id
             );
             
         case COLLISION_SHAPE_CAPSULE:
             return ray_capsule_intersection(
                 ray, 
-                &collider_center, 
+                collider_center, 
                 collision->shape_data.capsule.radius, 
                 collision->shape_data.capsule.inner_half_height, 
-                object->rotation, 
+                rotation, 
                 hit,
-                object->entity_id
+                entity_id
             );
             
         case COLLISION_SHAPE_CYLINDER:
             return ray_cylinder_intersection(
                 ray, 
-                &collider_center, 
+                collider_center, 
                 collision->shape_data.cylinder.radius, 
                 collision->shape_data.cylinder.half_height, 
-                object->rotation, 
+                rotation, 
                 hit,
-                object->entity_id
+                entity_id
             );
             
         case COLLISION_SHAPE_CONE:
             return ray_cone_intersection(
                 ray, 
-                &collider_center, 
+                collider_center, 
                 collision->shape_data.cone.radius, 
                 collision->shape_data.cone.half_height, 
-                object->rotation, 
+                rotation, 
                 hit,
-                object->entity_id
+                entity_id
             );
             
         case COLLISION_SHAPE_SWEEP:
@@ -686,3 +684,55 @@ bool ray_physics_object_intersection(
             return false;
     }
 }
+
+/// @brief Tests the ray against every child of a compound and keeps the closest hit
+static bool ray_compound_intersection(
+    raycast* ray,
+    const struct compound_collider* compound,
+    Vector3* collider_center,
+    Quaternion* rotation,
+    raycast_hit* hit,
+    entity_id entity_id
+) {
+    bool did_hit = false;
+
+    for (int i = 0; i < compound->child_count; i++) {
+        struct compound_child* child = &compound->children[i];
+
+        Quaternion child_rotation = child->rotation;
+        Vector3 child_center = child->offset;
+        if (rotation) {
+            quatMultiply(rotation, &child->rotation, &child_rotation);
+            quatMultVector(rotation, &child->offset, &child_center);
+        }
+        vector3AddToSelf(&child_center, collider_center);
+
+        raycast_hit child_hit;
+        if (ray_collision_shape_intersection(ray, &child->collision, &child_center, &child_rotation, &child_hit, entity_id) &&
+            (!did_hit || child_hit.distance < hit->distance)) {
+            *hit = child_hit;
+            did_hit = true;
+        }
+    }
+
+    return did_hit;
+}
+
+bool ray_physics_object_intersection(
+    raycast* ray, 
+    physics_object* object, 
+    raycast_hit* hit
+) {
+    // Get the object's collision data
+    struct physics_object_collision_data* collision = object->collision;
+    
+    // Calculate the world center of the collider
+    Vector3 collider_center;
+    vector3Add(object->position, &object->center_offset, &collider_center);
+
+    if (collision->shape_type == COLLISION_SHAPE_COMPOUND) {
+        return ray_compound_intersection(ray, collision->shape_data.compound.collider, &collider_center, object->rotation, hit, object->entity_id);
+    }
+
+    return ray_collision_shape_intersection(ray, collision, &collider_center, object->rotation, hit, object->entity_id);
+}
@@ -6,7 +6,7 @@
 #include "../raycast.h"
 #include "../mesh_collider.h"
 
-/// @brief Möller–Trumbore Ray-Triangle intersection algorithm
+/// @brief Ray-Triangle intersection using the precomputed plane and barycentric terms of the triangle
 /// @param ray 
 /// @param hit the resulting hit object
 /// @param triangle the mesh triangle to be tested
@@ -14,7 +14,7 @@
 bool ray_triangle_intersection(
     raycast *ray, 
     raycast_hit* hit, 
-    struct mesh_triangle *triangle
+    const struct mesh_triangle *triangle
 );
 
 #endif // __COLLISION_SHAPE_RAY_TRIANGLE_INTERSECTION_H__
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include "particle_system.h"
+
+#include <malloc.h>
+#include <math.h>
+#include "../render/render_scene.h"
+#include "../resource/material_cache.h"
+#include "../time/time.h"
+#include "../math/mathf.h"
+
+/// @brief Radius around the emitter that contains every particle over its whole lifetime
+/// @param def
+/// @return
+static float particle_emitter_def_bounds_radius(const struct particle_emitter_def* def) {
+    float lifetime = def->lifetime;
+    float max_speed = vector3Mag(&def->velocity) + vector3Mag(&def->velocity_randomness);
+
+    return vector3Mag(&def->spawn_offset) +
+        max_speed * lifetime +
+        0.5f * vector3Mag(&def->acceleration) * lifetime * lifetime +
+        maxf(def->start_radius, def->end_radius);
+}
+
+static uint8_t particle_color_channel_lerp(uint8_t from, uint8_t to, float t) {
+    return (uint8_t)mathfLerp(from, to, t);
+}
+
+/// @brief Precalculates the color of each quantized step of the lifetime
+/// @param emitter
+static void particle_emitter_init_colors(struct particle_emitter* emitter) {
+    const struct particle_emitter_def* def = emitter->def;
+
+    for (int step = 0; step < PARTICLE_COLOR_STEPS; ++step) {
+        float t = step * (1.0f / (PARTICLE_COLOR_STEPS - 1));
+        color_t* color = &emitter->colors[step];
+
+        color->r = particle_color_channel_lerp(def->start_color.r, def->end_color.r, t);
+        color->g = particle_color_channel_lerp(def->start_color.g, def->end_color.g, t);
+        color->b = particle_color_channel_lerp(def->start_color.b, def->end_color.b, t);
+        color->a = particle_color_channel_lerp(def->start_color.a, def->end_color.a, t);
+
+        if (t > def->fade_start) {
+            float fade = 1.0f - (t - def->fade_start) * (1.0f / (1.0f - def->fade_start));
+            color->a = (uint8_t)(color->a * fade);
+        }
+    }
+}
+
+static void particle_pool_init(struct particle_pool* pool, int capacity) {
+    // all attributes share one allocation
+    char* memory = malloc((sizeof(Vector3) * 2 + sizeof(float)) * capacity);
+
+    pool->positions = (Vector3*)memory;
+    pool->velocities = (Vector3*)(memory + sizeof(Vector3) * capacity);
+    pool->ages = (float*)(memory + sizeof(Vector3) * 2 * capacity);
+    pool->count = 0;
+    pool->capacity = capacity;
+}
+
+static void particle_pool_destroy(struct particle_pool* pool) {
+    free(pool->positions);
+    pool->positions = NULL;
+    pool->velocities = NULL;
+    pool->ages = NULL;
+    pool->count = 0;
+}
+
+static void particle_pool_remove(struct particle_pool* pool, int index) {
+    int last = pool->count - 1;
+
+    pool->positions[index] = pool->positions[last];
+    pool->velocities[index] = pool->velocities[last];
+    pool->ages[index] = pool->ages[last];
+    pool->count = last;
+}
+
+static void particle_emitter_spawn(struct particle_emitter* emitter) {
+    struct particle_pool* pool = &emitter->pool;
+
+    if (pool->count == pool->capacity) {
+        return;
+    }
+
+    const struct particle_emitter_def* def = emitter->def;
+    int index = pool->count;
+    Vector3* position = &pool->positions[index];
+    Vector3* velocity = &pool->velocities[index];
+
+    for (int axis = 0; axis < 3; ++axis) {
+        position->v[axis] = emitter->position->v[axis] + randomInRangef(-def->spawn_offset.v[axis], def->spawn_offset.v[axis]);
+        velocity->v[axis] = def->velocity.v[axis] + randomInRangef(-def->velocity_randomness.v[axis], def->velocity_randomness.v[axis]);
+    }
+
+    pool->ages[index] = 0.0f;
+    pool->count = index + 1;
+}
+
+/// @brief Adds the living particles to the batch as one billboard element, the batch sorts them by depth if the material blends
+/// @param emitter
+/// @param batch
+static void particle_emitter_render(struct particle_emitter* emitter, struct render_batch* batch) {
+    struct particle_pool* pool = &emitter->pool;
+
+    if (!pool->count) {
+        return;
+    }
+
+    struct render_batch_billboard_element* element = render_batch_add_particles(batch, emitter->material, pool->count, emitter->position);
+
+    if (!element) {
+        return;
+    }
+
+    const struct particle_emitter_def* def = emitter->def;
+    float inv_lifetime = 1.0f / def->lifetime;
+
+    for (int i = 0; i < element->sprite_count; ++i) {
+        struct render_billboard_sprite* sprite = &element->sprites[i];
+        float t = pool->ages[i] * inv_lifetime;
+        int step = (int)(t * PARTICLE_COLOR_STEPS);
+
+        if (step >= PARTICLE_COLOR_STEPS) {
+            step = PARTICLE_COLOR_STEPS - 1;
+        }
+
+        sprite->position = pool->positions[i];
+        sprite->radius = mathfLerp(def->start_radius, def->end_radius, t);
+        sprite->color = emitter->colors[step];
+        sprite->frame = 0;
+    }
+}
+
+void particle_emitter_init(struct particle_emitter* emitter, const struct particle_emitter_def* def, Vector3* position) {
+    emitter->def = def;
+    emitter->material = material_cache_load(def->material_filename);
+    emitter->position = position;
+    emitter->bounds_radius = particle_emitter_def_bounds_radius(def);
+    emitter->spawn_accumulator = 0.0f;
+    emitter->emitting = true;
+
+    particle_pool_init(&emitter->pool, def->max_particles);
+    particle_emitter_init_colors(emitter);
+
+    render_scene_add_callback(position, emitter->bounds_radius, (render_scene_callback)particle_emitter_render, emitter);
+    update_add(emitter, (update_callback)particle_emitter_update, UPDATE_PRIORITY_EFFECTS, UPDATE_LAYER_WORLD);
+}
+
+void particle_emitter_destroy(struct particle_emitter* emitter) {
+    render_scene_remove(emitter);
+    update_remove(emitter);
+    particle_pool_destroy(&emitter->pool);
+    material_cache_release(emitter->material);
+    emitter->material = NULL;
+}
+
+void particle_emitter_update(struct particle_emitter* emitter) {
+    struct particle_pool* pool = &emitter->pool;
+    const struct particle_emitter_def* def = emitter->def;
+
+    Vector3 velocity_change;
+    vector3Scale(&def->acceleration, &velocity_change, deltatime_sec);
+
+    for (int i = 0; i < pool->count;) {
+        pool->ages[i] += deltatime_sec;
+
+        if (pool->ages[i] >= def->lifetime) {
+            // the last particle moves into this slot and is updated next
+            particle_pool_remove(pool, i);
+            continue;
+        }
+
+        vector3Add(&pool->velocities[i], &velocity_change, &pool->velocities[i]);
+        vector3AddScaled(&pool->positions[i], &pool->velocities[i], deltatime_sec, &pool->positions[i]);
+        ++i;
+    }
+
+    if (!emitter->emitting) {
+        return;
+    }
+
+    emitter->spawn_accumulator += deltatime_sec * def->spawn_rate;
+
+    while (emitter->spawn_accumulator >= 1.0f) {
+        emitter->spawn_accumulator -= 1.0f;
+        particle_emitter_spawn(emitter);
+    }
+}
+
+void particle_emitter_stop(struct particle_emitter* emitter) {
+    emitter->emitting = false;
+}
@@ -0,0 +1,65 @@
+#ifndef __EFFECT_PARTICLE_SYSTEM_H__
+#define __EFFECT_PARTICLE_SYSTEM_H__
+
+#include <libdragon.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "../math/vector3.h"
+#include "../render/material.h"
+
+// the color over the lifetime is quantized, so particles of a similar age share the prim color when drawn
+#define PARTICLE_COLOR_STEPS    16
+
+/// @brief Describes an effect, every emitter of the effect shares the definition
+struct particle_emitter_def {
+    const char* material_filename;
+    uint16_t max_particles; // capacity of the pool of each emitter
+    float spawn_rate; // particles per second
+    float lifetime; // in seconds
+    Vector3 spawn_offset; // particles spawn up to this far from the emitter on each axis
+    Vector3 velocity;
+    Vector3 velocity_randomness; // up to this much is added to the velocity of a particle on each axis
+    Vector3 acceleration;
+    float start_radius;
+    float end_radius;
+    color_t start_color;
+    color_t end_color;
+    float fade_start; // fraction of the lifetime after which the alpha fades out
+};
+
+/// @brief Fixed capacity pool with one array per particle attribute.
+/// Dead particles are replaced by the last particle so the living ones stay packed at the start
+struct particle_pool {
+    Vector3* positions;
+    Vector3* velocities;
+    float* ages;
+    uint16_t count;
+    uint16_t capacity;
+};
+
+struct particle_emitter {
+    const struct particle_emitter_def* def;
+    struct material* material;
+    struct particle_pool pool;
+    Vector3* position; // the emitter follows the position, it has to stay valid until the emitter is destroyed
+    float bounds_radius; // radius around the position that contains every particle
+    float spawn_accumulator;
+    bool emitting;
+    color_t colors[PARTICLE_COLOR_STEPS];
+};
+
+/// @brief Allocates the particle pool, starts emitting and adds the emitter to the update loop and the render scene.
+/// The emitter is culled with a bounding sphere that contains every particle it can spawn
+/// @param emitter
+/// @param def must stay valid until the emitter is destroyed
+/// @param position
+void particle_emitter_init(struct particle_emitter* emitter, const struct particle_emitter_def* def, Vector3* position);
+void particle_emitter_destroy(struct particle_emitter* emitter);
+
+void particle_emitter_update(struct particle_emitter* emitter);
+
+/// @brief Stops spawning new particles, the living particles finish their lifetime
+/// @param emitter
+void particle_emitter_stop(struct particle_emitter* emitter);
+
+#endif
@@ -16,6 +16,7 @@
 #include "render/render_scene.h"
 #include "collision/collision_scene.h"
 #include "collision/mesh_collider.h"
+#include "collision/collide.h"
 
 #include "player/player.h"
 #include "map/map.h"
@@ -26,6 +27,8 @@
 #include "objects/cylinder/cylinder.h"
 #include "objects/soda_can/soda_can.h"
 #include "objects/platform/platform.h"
+#include "objects/bench/bench.h"
+#include "objects/lift/lift.h"
 #include "effects/fire.h"
 #include "skybox/skybox_flat.h"
 #include "math/transform.h"
@@ -37,6 +40,7 @@
 
 #include "resource/model_cache.h"
 #include "resource/mesh_collider.h"
+#include "resource/heightfield.h"
 #include "render/renderable.h"
 
 #include "collectables/collectable.h"
@@ -56,6 +60,7 @@ Vector3 lightDirVec = {{1.0f, 1.0f, -1.0f}};
 #define NUM_CRATES 3
 #define NUM_BALLS 3
 #define NUM_COINS 5
+#define NUM_LIFTS 2
 
 struct player player;
 struct map map;
@@ -66,10 +71,13 @@ struct cone cone;
 struct pyramid pyramid;
 struct cylinder cylinder;
 struct platform plat;
+struct bench bench;
+struct lift lifts[NUM_LIFTS];
 struct soda_can soda_can;
 struct fire fire;
 struct skybox_flat skybox_flat;
 struct mesh_collider test_mesh_collider;
+struct heightfield test_heightfield;
 bool render_collision = false;
 bool render_contacts = true;
 
@@ -120,6 +128,14 @@ struct generic_object_pos_definition can_def = {
     (Vector3){{64, 4, -90}}
 };
 
+struct generic_object_pos_definition bench_def = {
+    (Vector3){{102, 3, -136}}
+};
+
+struct generic_object_pos_definition lift_def = {
+    (Vector3){{78, 2, -118}}
+};
+
 void setup()
 {
     vector3NormalizeSelf(&lightDirVec);
@@ -153,6 +169,13 @@ void setup()
     cone_init(&cone, &cone_def);
     pyramid_init(&pyramid, &pyramid_def);
     cylinder_init(&cylinder, &cyl_def);
+    bench_init(&bench, &bench_def);
+
+    // the lifts are instances of one shared mesh collider
+    for(int i = 0; i < NUM_LIFTS; i++){
+        lift_init(&lifts[i], &lift_def);
+        lift_def.position.z += 12.0f;
+    }
     // soda_can_init(&soda_can, &can_def);
     
     map_init(&map);
@@ -169,6 +192,11 @@ void setup()
     // mesh_collider_load_test(&test_mesh_collider);
     mesh_collider_load(&test_mesh_collider, "rom:/maps/bob_omb_battlefield/bob_map.cmsh", 1.0f, NULL);
     collision_scene_use_static_collision(&test_mesh_collider);
+    if (heightfield_load(&test_heightfield, "rom:/maps/bob_omb_battlefield/bob_map.chfd", 1.0f)) {
+        collision_scene_use_heightfield(&test_heightfield);
+    } else {
+        heightfield_release(&test_heightfield);
+    }
     
 }
 
@@ -203,7 +231,7 @@ void render3d()
     t3d_light_set_directional(0, colorDir, (T3DVec3 *)&lightDirVec);
     t3d_light_set_count(1);
 
-    render_scene_render(&camera, &viewport, &frame_memory_pools[frame_index], &fog);
+    render_scene_render(&camera, &viewport, memory_pool, &fog);
 }
 
 void render()
@@ -227,7 +255,10 @@ void render()
     rdpq_text_printf(NULL, FONT_BUILTIN_DEBUG_MONO, posX, posY + 30, "ray dwn hit (%.2f, %.2f, %.2f)", player.ray_down_hit.point.x, player.ray_down_hit.point.y, player.ray_down_hit.point.z);
     rdpq_text_printf(NULL, FONT_BUILTIN_DEBUG_MONO, posX, posY + 40, "ray fwd dist %.1f, entity_id: %d", player.ray_fwd_hit.distance, player.ray_fwd_hit.hit_entity_id);
     rdpq_text_printf(NULL, FONT_BUILTIN_DEBUG_MONO, posX, posY + 50, "ray fwd hit (%.2f, %.2f, %.2f)", player.ray_fwd_hit.point.x, player.ray_fwd_hit.point.y, player.ray_fwd_hit.point.z);
-    rdpq_text_printf(NULL, FONT_BUILTIN_DEBUG_MONO, posX, posY + 60, "cached contacts: %i", c_scene->cached_contact_constraint_count);
+    rdpq_text_printf(NULL, FONT_BUILTIN_DEBUG_MONO, posX, posY + 60, "cached contacts: %i, dropped events: %i, solver: %s", c_scene->cached_contact_constraint_count, c_scene->dropped_contact_event_count, c_scene->solver_type == COLLISION_SOLVER_PGS ? "PGS" : "TGS");
+    const struct render_batch_billboard_stats* billboard_stats = render_batch_get_billboard_stats();
+    rdpq_text_printf(NULL, FONT_BUILTIN_DEBUG_MONO, posX, posY + 70, "sprites: %d in %lu us", billboard_stats->sprites, TICKS_TO_US(billboard_stats->ticks));
+    rdpq_text_printf(NULL, FONT_BUILTIN_DEBUG_MONO, posX, posY + 80, "tmem: %lu bytes", render_batch_get_state_counters()->tmem_bytes_uploaded);
     posY = 200;
     rdpq_text_printf(NULL, FONT_BUILTIN_DEBUG_MONO, posX, posY, "Pos: %.2f, %.2f, %.2f", player.transform.position.x, player.transform.position.y, player.transform.position.z);
     rdpq_text_printf(NULL, FONT_BUILTIN_DEBUG_MONO, posX, posY + 20, "Vel: %.2f, %.2f, %.2f", player.physics.velocity.x, player.physics.velocity.y, player.physics.velocity.z);
@@ -294,6 +325,11 @@ int main()
             // crate_destroy(&crates[0]);
         }
 
+        if(joypad_get_buttons_pressed(0).d_right){
+            struct collision_scene* c_scene = collision_scene_get_instance();
+            collision_scene_set_solver(c_scene->solver_type == COLLISION_SOLVER_PGS ? COLLISION_SOLVER_TGS_SOFT : COLLISION_SOLVER_PGS);
+        }
+
 
         // mixer_try_play();
 
@@ -388,7 +424,8 @@ int main()
                 if (!cc->is_active) continue;
 
                 for (int j = 0; j < cc->point_count; j++){
-                    Vector3 cA = cc->points[j].contactA;
+                    Vector3 cA, cB;
+                    collide_contact_point_world(cc, &cc->points[j], &cA, &cB);
                     Vector3 normal = cc->normal;
                     Vector3 contact_line_end;
                     vector3Scale(&normal, &contact_line_end, 1.0f);
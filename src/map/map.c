@@ -5,9 +5,63 @@
 #include "../math/vector2.h"
 
 #include "../render/render_scene.h"
+#include "../resource/pvs.h"
 #include "../time/time.h"
 #include "../render/defs.h"
 
+#include <malloc.h>
+
+
+/// @brief Matches the objects of the map model to the chunks of the pvs by name.
+/// Every chunk has to match an object, otherwise the pvs was baked from a different version of the map
+/// @param map 
+static void map_init_chunks(struct map* map) {
+    T3DModel* model = map->renderable.model->t3d_model;
+
+    hash_map_init(&map->object_chunks, map->pvs.chunk_count);
+
+    // a chunk can be split into several objects, one per material
+    bool* chunk_found = calloc(map->pvs.chunk_count, sizeof(bool));
+
+    T3DModelIter it = t3d_model_iter_create(model, T3D_CHUNK_TYPE_OBJECT);
+    while (t3d_model_iter_next(&it)) {
+        int chunk = pvs_find_chunk(&map->pvs, it.object->name);
+
+        if (chunk >= 0) {
+            // store index + 1 so a missing object (NULL) can be told apart from chunk 0
+            hash_map_set(&map->object_chunks, (int)it.object, (void*)(intptr_t)(chunk + 1));
+            chunk_found[chunk] = true;
+        }
+    }
+
+    for (int chunk = 0; chunk < map->pvs.chunk_count; chunk++) {
+        assertf(chunk_found[chunk], "pvs chunk %s has no object in the map model", map->pvs.chunk_names[chunk]);
+    }
+
+    free(chunk_found);
+}
+
+/// @brief Object filter that skips the objects of chunks that are not visible from the camera cell
+static bool map_object_filter(void* data, const T3DObject* object) {
+    struct map* map = (struct map*)data;
+    intptr_t chunk_plus_1 = (intptr_t)hash_map_get(&map->object_chunks, (int)object);
+
+    return !chunk_plus_1 || pvs_is_chunk_visible(map->_visible_chunks, chunk_plus_1 - 1);
+}
+
+void map_render(struct map* map, struct render_batch* batch) {
+    T3DMat4FP* mtxfp = renderable_get_matrix(&map->renderable);
+
+    map->_visible_chunks = map->has_pvs ? pvs_visible_chunks(&map->pvs, &batch->camera_position) : NULL;
+
+    // outside of the baked grid everything may be visible
+    if (!map->_visible_chunks) {
+        render_batch_add_t3dmodel(batch, map->renderable.model, mtxfp, NULL);
+        return;
+    }
+
+    render_batch_add_t3dmodel_filtered(batch, map->renderable.model, mtxfp, NULL, map_object_filter, map);
+}
 
 void map_init(struct map* map) {
     transformInitIdentity(&map->transform);
@@ -16,10 +70,23 @@ void map_init(struct map* map) {
     map->transform.position = (Vector3){{0,0,0}};
     map->transform.scale = (Vector3){{1.0f, 1.0f, 1.0f}};
 
-    render_scene_add_callback(NULL, 0, render_scene_render_renderable, &map->renderable);
+    // the pvs is baked in world space, so the map transform has to stay the identity
+    map->has_pvs = pvs_load(&map->pvs, "rom:/maps/bob_omb_battlefield/bob_map.pvs", 1.0f);
+    map->_visible_chunks = NULL;
+
+    if (map->has_pvs) {
+        map_init_chunks(map);
+    }
+
+    // the pvs replaces frustum culling of the whole map
+    render_scene_add_callback(NULL, 0.0f, (render_scene_callback)map_render, map);
 }
 
 void map_destroy(struct map* map) {
+    render_scene_remove(map);
     renderable_destroy(&map->renderable);
-    render_scene_remove(&map->renderable);
+    pvs_release(&map->pvs);
+    if (map->has_pvs) {
+        hash_map_destroy(&map->object_chunks);
+    }
 }
\ No newline at end of file
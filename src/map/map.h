@@ -7,12 +7,18 @@
 #include "../render/renderable.h"
 #include "../render/model.h"
 #include "../resource/model_cache.h"
+#include "../render/pvs.h"
+#include "../util/hash_map.h"
 
 
 struct map {
     Transform transform;
     struct renderable renderable;
     struct model* model;
+    struct pvs pvs;
+    bool has_pvs;
+    struct hash_map object_chunks; // pvs chunk + 1 of the objects of the map model keyed by the T3DObject*, objects without a chunk are always drawn
+    const uint8_t* _visible_chunks; // chunks visible from the camera this frame
 };
 
 void map_init(struct map* map);
@@ -29,6 +29,24 @@ void vector3ToVector3u8(const Vector3* input, Vector3u8* output) {
     output->z = floatTos8norm(input->z);
 }
 
+static inline float vector3SignNotZero(float value) {
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+void vector3FromOctahedral(uint16_t input, Vector3* output) {
+    float x = (int8_t)(input >> 8) * (1.0f / 127.0f);
+    float y = (int8_t)(input & 0xFF) * (1.0f / 127.0f);
+    float z = 1.0f - fabsf(x) - fabsf(y);
+    if (z < 0.0f) {
+        float unfolded_x = (1.0f - fabsf(y)) * vector3SignNotZero(x);
+        y = (1.0f - fabsf(x)) * vector3SignNotZero(y);
+        x = unfolded_x;
+    }
+
+    *output = (Vector3){{x, y, z}};
+    vector3NormalizeSelf(output);
+}
+
 void vector3Reflect(const Vector3 *in, const Vector3 *normal, Vector3 *out)
 {
     Vector3 tmp;
@@ -337,6 +337,11 @@ bool vector3MoveTowards(const Vector3* from, const Vector3* towards, float maxDi
 /// @param output 
 void vector3ToVector3u8(const Vector3* input, Vector3u8* output);
 
+/// @brief Decodes an octahedral encoded unit vector
+/// @param input two signed 8 bit octahedral coordinates, x in the high byte
+/// @param output the normalized vector
+void vector3FromOctahedral(uint16_t input, Vector3* output);
+
 /// @brief Compute the reflection of an incident vector off a surface.
 /// @param in The incident vector
 /// @param normal The surface's normal vector. Must be normalized
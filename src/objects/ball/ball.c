@@ -25,7 +25,7 @@ void ball_init(struct ball* ball, struct generic_object_pos_definition* def){
 
     renderable_init(&ball->renderable, &ball->transform, "rom:/models/ball/ball.t3dm");
 
-    render_scene_add_renderable(&ball->renderable, BALL_RADIUS);
+    render_scene_add_renderable(&ball->renderable);
 
 
     physics_object_init(
@@ -40,6 +40,7 @@ void ball_init(struct ball* ball, struct generic_object_pos_definition* def){
     );
     ball->physics.angular_damping = 0.02f;
     collision_scene_add(&ball->physics);
+    renderable_set_physics(&ball->renderable, &ball->physics);
 }
 
 void ball_destroy(struct ball* ball){
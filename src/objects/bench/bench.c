@@ -0,0 +1,106 @@
+#include "bench.h"
+
+#include <libdragon.h>
+#include "../../render/render_scene.h"
+#include "../../collision/collision_scene.h"
+#include "../../collision/shapes/box.h"
+#include "../../collision/shapes/compound.h"
+#include "../../time/time.h"
+#include "../../entity/entity_id.h"
+#include "../../render/defs.h"
+
+// the children are placed around the center of mass, the seat weighs as much as both legs together
+static struct compound_child bench_children[BENCH_PART_COUNT] = {
+    {
+        .collision = { BOX_COLLIDER(4.0f, 0.5f, 1.25f) },
+        .offset = {{0.0f, 1.0f, 0.0f}},
+        .rotation = {{0, 0, 0, 1}},
+        .mass_weight = 2.0f,
+    },
+    {
+        .collision = { BOX_COLLIDER(0.5f, 1.5f, 1.25f) },
+        .offset = {{-3.5f, -1.0f, 0.0f}},
+        .rotation = {{0, 0, 0, 1}},
+        .mass_weight = 1.0f,
+    },
+    {
+        .collision = { BOX_COLLIDER(0.5f, 1.5f, 1.25f) },
+        .offset = {{3.5f, -1.0f, 0.0f}},
+        .rotation = {{0, 0, 0, 1}},
+        .mass_weight = 1.0f,
+    },
+};
+
+static struct compound_collider bench_compound;
+
+static struct physics_object_collision_data bench_collision = {
+    COMPOUND_COLLIDER(&bench_compound),
+    .friction = 0.7f,
+    .bounce = 0.0f
+};
+
+/// @brief Moves the part transforms with the physics body, the crate model is a unit cube scaled to the child box
+static void bench_place_parts(struct bench* bench) {
+    for (int i = 0; i < BENCH_PART_COUNT; i++) {
+        struct compound_child* child = &bench_children[i];
+        Transform* part = &bench->part_transforms[i];
+
+        quatMultVector(&bench->transform.rotation, &child->offset, &part->position);
+        vector3AddToSelf(&part->position, &bench->transform.position);
+        quatMultiply(&bench->transform.rotation, &child->rotation, &part->rotation);
+        vector3Scale(&child->collision.shape_data.box.half_size, &part->scale, 2.0f);
+
+        renderable_mark_dirty(&bench->part_renderables[i]);
+    }
+}
+
+void bench_update(struct bench* bench) {
+    bool awake = !bench->physics._is_sleeping;
+
+    // the steps before the body fell asleep may still have moved it
+    if (awake || bench->was_awake) {
+        bench_place_parts(bench);
+    }
+
+    bench->was_awake = awake;
+}
+
+void bench_init(struct bench* bench, struct generic_object_pos_definition* def) {
+    entity_id entity_id = entity_id_new();
+    transformInitIdentity(&bench->transform);
+    bench->transform.position = def->position;
+
+    compound_collider_init(&bench_compound, bench_children, BENCH_PART_COUNT);
+
+    for (int i = 0; i < BENCH_PART_COUNT; i++) {
+        transformInitIdentity(&bench->part_transforms[i]);
+        renderable_init(&bench->part_renderables[i], &bench->part_transforms[i], "rom:/models/crate/crate.t3dm");
+        render_scene_add_renderable(&bench->part_renderables[i]);
+    }
+
+    physics_object_init(
+        entity_id,
+        &bench->physics,
+        &bench_collision,
+        COLLISION_LAYER_TANGIBLE,
+        &bench->transform.position,
+        &bench->transform.rotation,
+        gZeroVec,
+        120.0f
+    );
+    collision_scene_add(&bench->physics);
+
+    bench->was_awake = true;
+    bench_place_parts(bench);
+
+    update_add(bench, (update_callback)bench_update, UPDATE_PRIORITY_WORLD, UPDATE_LAYER_WORLD);
+}
+
+void bench_destroy(struct bench* bench) {
+    for (int i = 0; i < BENCH_PART_COUNT; i++) {
+        render_scene_remove(&bench->part_renderables[i]);
+        renderable_destroy(&bench->part_renderables[i]);
+    }
+    collision_scene_remove(&bench->physics);
+    update_remove(bench);
+}
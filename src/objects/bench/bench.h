@@ -0,0 +1,26 @@
+#ifndef __OBJECT_BENCH_H__
+#define __OBJECT_BENCH_H__
+
+#include "../../math/transform.h"
+#include "../../render/renderable.h"
+#include "../../collision/physics_object.h"
+#include "../../scene/scene_definition.h"
+
+#define BENCH_PART_COUNT 3 // the seat and two legs
+
+/// @brief A non-convex prop, one compound physics body with a box child per part.
+///
+/// Each part is drawn as its own crate model, placed from the physics transform after the physics steps of the frame.
+struct bench {
+    Transform transform; // the physics transform, at the center of mass
+    Transform part_transforms[BENCH_PART_COUNT];
+    struct renderable part_renderables[BENCH_PART_COUNT];
+    physics_object physics;
+    bool was_awake; // the physics object was awake when the parts were last placed
+};
+
+void bench_init(struct bench* bench, struct generic_object_pos_definition* def);
+
+void bench_destroy(struct bench* bench);
+
+#endif
@@ -24,7 +24,7 @@ void cone_init(struct cone* cone, struct generic_object_pos_definition* def){
 
     renderable_init(&cone->renderable, &cone->transform, "rom:/models/cone/cone.t3dm");
 
-    render_scene_add_renderable(&cone->renderable, 14.0f);
+    render_scene_add_renderable(&cone->renderable);
 
     physics_object_init(
         entity_id,
@@ -42,6 +42,7 @@ void cone_init(struct cone* cone, struct generic_object_pos_definition* def){
     cone->physics.constraints |= CONSTRAINTS_FREEZE_POSITION_ALL;
 
     collision_scene_add(&cone->physics);
+    renderable_set_physics(&cone->renderable, &cone->physics);
 }
 
 void cone_destroy(struct cone* cone){
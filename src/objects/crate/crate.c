@@ -23,7 +23,7 @@ void crate_init(struct crate* crate, struct generic_object_pos_definition* def){
 
     renderable_init(&crate->renderable, &crate->transform, "rom:/models/crate/crate.t3dm");
 
-    render_scene_add_renderable(&crate->renderable, 4.0f);
+    render_scene_add_renderable(&crate->renderable);
 
 
     physics_object_init(
@@ -37,6 +37,7 @@ void crate_init(struct crate* crate, struct generic_object_pos_definition* def){
         100.0f
     );
     collision_scene_add(&crate->physics);
+    renderable_set_physics(&crate->renderable, &crate->physics);
 }
 
 void crate_destroy(struct crate* crate){
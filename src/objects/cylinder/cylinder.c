@@ -26,7 +26,7 @@ void cylinder_init(struct cylinder* cylinder, struct generic_object_pos_definiti
 
     renderable_init(&cylinder->renderable, &cylinder->transform, "rom:/models/cylinder/cylinder.t3dm");
 
-    render_scene_add_renderable(&cylinder->renderable, 8.0f);
+    render_scene_add_renderable(&cylinder->renderable);
 
 
     physics_object_init(
@@ -45,6 +45,7 @@ void cylinder_init(struct cylinder* cylinder, struct generic_object_pos_definiti
     cylinder->physics.constraints |= CONSTRAINTS_FREEZE_POSITION_ALL;
 
     collision_scene_add(&cylinder->physics);
+    renderable_set_physics(&cylinder->renderable, &cylinder->physics);
 }
 
 void cylinder_destroy(struct cylinder* cylinder){
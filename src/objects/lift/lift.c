@@ -0,0 +1,63 @@
+#include "lift.h"
+
+#include <libdragon.h>
+#include "../../render/render_scene.h"
+#include "../../collision/collision_scene.h"
+#include "../../resource/mesh_collider.h"
+#include "../../time/time.h"
+#include "../../render/defs.h"
+
+#define LIFT_HALF_SIZE {{4.0f, 0.5f, 4.0f}}
+#define LIFT_TRAVEL 3.0f // distance from the start position to the top and bottom of the ride
+#define LIFT_PERIOD 6.0f
+
+static struct mesh_collider lift_mesh;
+static int lift_mesh_users;
+
+void lift_fixed_update(struct lift* lift) {
+    lift->elapsed_time += FIXED_DELTATIME;
+    if (lift->elapsed_time > LIFT_PERIOD) {
+        lift->elapsed_time -= LIFT_PERIOD;
+    }
+
+    Vector3 position = lift->start_position;
+    position.y += sinf((lift->elapsed_time / LIFT_PERIOD) * 2.0f * PI) * LIFT_TRAVEL;
+
+    collision_scene_move_mesh_instance(&lift->collision, &position, &lift->transform.rotation);
+    lift->transform.position = position;
+    renderable_mark_dirty(&lift->renderable);
+}
+
+void lift_init(struct lift* lift, struct generic_object_pos_definition* def) {
+    Vector3 half_size = LIFT_HALF_SIZE;
+
+    transformInitIdentity(&lift->transform);
+    vector3Scale(&half_size, &lift->transform.scale, 2.0f);
+    lift->transform.position = def->position;
+    lift->start_position = def->position;
+    lift->elapsed_time = 0.0f;
+
+    renderable_init(&lift->renderable, &lift->transform, "rom:/models/crate/crate.t3dm");
+
+    render_scene_add_renderable(&lift->renderable);
+
+    if (lift_mesh_users++ == 0) {
+        mesh_collider_load_box(&lift_mesh, &half_size);
+    }
+
+    mesh_instance_init(&lift->collision, &lift_mesh, &lift->transform.position, &lift->transform.rotation, 1.0f);
+    collision_scene_add_mesh_instance(&lift->collision);
+
+    fixed_update_add(lift, (update_callback)lift_fixed_update, UPDATE_PRIORITY_WORLD, UPDATE_LAYER_WORLD);
+}
+
+void lift_destroy(struct lift* lift) {
+    render_scene_remove(&lift->renderable);
+    renderable_destroy(&lift->renderable);
+    collision_scene_remove_mesh_instance(&lift->collision);
+    fixed_update_remove(lift);
+
+    if (--lift_mesh_users == 0) {
+        mesh_collider_release(&lift_mesh);
+    }
+}
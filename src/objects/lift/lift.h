@@ -0,0 +1,22 @@
+#ifndef __OBJECT_LIFT_H__
+#define __OBJECT_LIFT_H__
+
+#include "../../math/transform.h"
+#include "../../render/renderable.h"
+#include "../../collision/mesh_instance.h"
+#include "../../scene/scene_definition.h"
+
+/// @brief A slab that moves up and down, placed as an instance of a box mesh collider shared by all lifts
+struct lift {
+    Transform transform;
+    struct renderable renderable;
+    struct mesh_instance collision;
+    Vector3 start_position;
+    float elapsed_time;
+};
+
+void lift_init(struct lift* lift, struct generic_object_pos_definition* def);
+
+void lift_destroy(struct lift* lift);
+
+#endif
@@ -22,6 +22,7 @@ void platform_update(struct platform* platform){
     quatIdent(&rot);
     quatRotateAxisEuler(&rot, &gUp, T3D_DEG_TO_RAD(-45.0f), &rot);
     quatRotateAxisEuler(&rot, &gForward, platform->rot_y, &platform->transform.rotation);
+    renderable_mark_dirty(&platform->renderable);
     if(platform->rot_elapsed_time > ROTATION_DURATION){
         platform->rot_elapsed_time = 0.0f;
     }
@@ -37,7 +38,7 @@ void platform_init(struct platform* platform, struct generic_object_pos_definiti
 
     renderable_init(&platform->renderable, &platform->transform, "rom:/models/crate/crate.t3dm");
 
-    render_scene_add_renderable(&platform->renderable, 25.0f);
+    render_scene_add_renderable(&platform->renderable);
 
 
     physics_object_init(
@@ -61,6 +62,7 @@ void platform_init(struct platform* platform, struct generic_object_pos_definiti
 
     // update_add(platform, (update_callback)platform_update, UPDATE_PRIORITY_PLAYER, UPDATE_LAYER_WORLD);
     collision_scene_add(&platform->physics);
+    renderable_set_physics(&platform->renderable, &platform->physics);
 }
 
 void platform_destroy(struct platform* platform){
@@ -25,7 +25,7 @@ void pyramid_init(struct pyramid* pyramid, struct generic_object_pos_definition*
 
     renderable_init(&pyramid->renderable, &pyramid->transform, "rom:/models/pyramid/pyramid.t3dm");
 
-    render_scene_add_renderable(&pyramid->renderable, 14.0f);
+    render_scene_add_renderable(&pyramid->renderable);
 
     physics_object_init(
         entity_id,
@@ -43,6 +43,7 @@ void pyramid_init(struct pyramid* pyramid, struct generic_object_pos_definition*
     // pyramid->physics.constraints |= CONSTRAINTS_FREEZE_POSITION_ALL;
 
     collision_scene_add(&pyramid->physics);
+    renderable_set_physics(&pyramid->renderable, &pyramid->physics);
 }
 
 void pyramid_destroy(struct pyramid* pyramid){
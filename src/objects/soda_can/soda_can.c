@@ -8,6 +8,7 @@
 
 void soda_can_update(struct soda_can *soda_can){
     quatRotateAxisEuler(&soda_can->transform.rotation, &gUp, T3D_DEG_TO_RAD(0.5f), &soda_can->transform.rotation);
+    renderable_mark_dirty(&soda_can->renderable);
 }
 
 
@@ -18,7 +19,7 @@ void soda_can_init(struct soda_can* soda_can, struct generic_object_pos_definiti
 
     renderable_init(&soda_can->renderable, &soda_can->transform, "rom:/models/soda_can/can.t3dm");
 
-    render_scene_add_renderable(&soda_can->renderable, 2.0f);
+    render_scene_add_renderable(&soda_can->renderable);
 
     update_add(soda_can, (update_callback)soda_can_update, UPDATE_PRIORITY_PLAYER, UPDATE_LAYER_WORLD);
 
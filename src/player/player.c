@@ -30,26 +30,44 @@ static struct physics_object_collision_data player_collision = {
 };
 
 void player_handle_contacts(struct player* player){
-    contact *contact = player->physics.active_contacts;
-    while (contact)
+    // Triggers (collectables) are reported as overlaps, not contacts
+    struct collision_scene* scene = collision_scene_get_instance();
+    for (int i = 0; i < scene->trigger_overlap_count; i++)
     {
-        struct collectable *collectable = contact->other_object ? collectable_get(contact->other_object->entity_id) : NULL;
+        struct trigger_overlap* overlap = &scene->trigger_overlaps[i];
+
+        // removing a collectable only marks its overlaps as exited, so iterating here stays valid
+        if (overlap->other != &player->physics || !overlap->trigger || overlap->state == TRIGGER_OVERLAP_EXIT)
+        {
+            continue;
+        }
+
+        struct collectable *collectable = collectable_get(overlap->trigger->entity_id);
 
         if (collectable)
         {
             collectable_collected(collectable);
         }
+    }
 
-        if ((contact->other_object && contact->other_object->collision_layers & COLLISION_LAYER_TANGIBLE) || !contact->other_object)
+    for (int i = 0; i < scene->contact_event_count; i++)
+    {
+        const contact_event* event = &scene->contact_events[i];
+
+        if (event->type == CONTACT_EVENT_END || !contact_event_has_entity(event, player->physics.entity_id))
         {
-            if (contact->constraint->normal.y >= PLAYER_MAX_ANGLE_GROUND_DOT)
+            continue;
+        }
+
+        // the static mesh reports itself as tangible
+        if (contact_event_other_layers(event, player->physics.entity_id) & COLLISION_LAYER_TANGIBLE)
+        {
+            if (event->normal.y >= PLAYER_MAX_ANGLE_GROUND_DOT)
             {
                 player->is_on_ground = true;
-                vector3Add(&player->ground_normal, &contact->constraint->normal, &player->ground_normal);
+                vector3Add(&player->ground_normal, &event->normal, &player->ground_normal);
             }
         }
-
-        contact = contact->next;
     }
 }
 
@@ -128,26 +128,9 @@ void material_load(struct material* into, FILE* material_file) {
 
 
     // record the rspq_block for applying the material
+    // the textures are not part of the block, the render batch uploads them only if they are not already in tmem (see render_state_upload_textures)
     rspq_block_begin();
 
-    // check if the material is using auto layout tmem
-    bool autoLayoutTMem = into->tex1.sprite != 0 && into->tex1.params.tmem_addr == 0;
-    if (autoLayoutTMem) {
-        rdpq_tex_multi_begin();
-    }
-
-    // upload the textures to the RDP texture memory
-    if (into->tex0.sprite) {
-        rdpq_sprite_upload(TILE0, into->tex0.sprite, &into->tex0.params);
-    }
-    if (into->tex1.sprite) {
-        rdpq_sprite_upload(TILE1, into->tex1.sprite, &into->tex1.params);
-    }
-
-    if (autoLayoutTMem) {
-        rdpq_tex_multi_end();
-    }
-
     rdpq_mode_begin();
     //read the material commands from the file stream and apply them
     while (has_more) {
@@ -179,6 +162,11 @@ void material_load(struct material* into, FILE* material_file) {
                         into->flags |= MATERIAL_FLAGS_Z_WRITE;
                     }
 
+                    // the first blender cycle adds MEMORY * INV_MUX_A, additive and opaque modes do not depend on the draw order
+                    if (((blendMode >> 22) & 0x3) == 1 && ((blendMode >> 18) & 0x3) == 0) {
+                        into->flags |= MATERIAL_FLAGS_BLENDED;
+                    }
+
                     if ((blendMode & SOM_ALPHACOMPARE_MASK) != 0) {
                         if ((blendMode & SOM_ALPHACOMPARE_MASK) == SOM_ALPHACOMPARE_THRESHOLD) {
                             rdpq_mode_alphacompare(128);
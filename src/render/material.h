@@ -23,9 +23,10 @@ struct material_palette {
 
 #define MATERIAL_FLAGS_Z_WRITE  (1 << 0)
 #define MATERIAL_FLAGS_Z_READ   (1 << 1)
+#define MATERIAL_FLAGS_BLENDED  (1 << 2) // mixes with the framebuffer by alpha, the result depends on the draw order
 
 struct material {
-    rspq_block_t* block;
+    rspq_block_t* block; // sets the render mode and colors, the textures have to be uploaded separately
     struct material_tex tex0;
     struct material_tex tex1;
     struct material_palette palette;
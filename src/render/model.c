@@ -2,6 +2,9 @@
 
 #include <t3d/t3d.h>
 #include "../resource/sprite_cache.h"
+#include "../math/mathf.h"
+#include "defs.h"
+#include <math.h>
 
 /// @brief Load a T3D model from a file and store it in the model struct. Also load the skeleton if the model has one.
 /// Depending on if a Skeleton exists, the rspq_block will be generated to draw the model skinned or unskinned.
@@ -40,4 +43,20 @@ void model_release(struct model* model) {
         model->has_skeleton = false;
     }
     free(model);
-}
\ No newline at end of file
+}
+
+/// @brief Radius around the model origin that contains the model AABB at any rotation
+/// @param model
+/// @param scale the scale of the transform
+/// @return the radius in world units
+float model_bounding_radius(struct model* model, Vector3* scale) {
+    T3DModel* t3d_model = model->t3d_model;
+    Vector3 corner;
+
+    for (int axis = 0; axis < 3; ++axis) {
+        corner.v[axis] = maxf(fabsf(t3d_model->aabbMin[axis]), fabsf(t3d_model->aabbMax[axis]));
+    }
+
+    float max_scale = maxf(fabsf(scale->x), maxf(fabsf(scale->y), fabsf(scale->z)));
+    return sqrtf(vector3MagSqrd(&corner)) * max_scale * INV_MODEL_SCALE;
+}
@@ -5,6 +5,7 @@
 #include <t3d/t3dmodel.h>
 #include <t3d/t3dskeleton.h>
 #include <stdbool.h>
+#include "../math/vector3.h"
 
 
 struct model {
@@ -19,4 +20,6 @@ struct model {
 void model_load(struct model* into, const char* model_filename);
 void model_release(struct model* model);
 
+float model_bounding_radius(struct model* model, Vector3* scale);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "pvs.h"
+
+#include <string.h>
+#include <math.h>
+
+const uint8_t* pvs_visible_chunks(struct pvs* pvs, Vector3* position) {
+    if (!pvs->chunk_count) {
+        return NULL;
+    }
+
+    float inv_cell_size = 1.0f / pvs->cell_size;
+    int x = (int)floorf((position->x - pvs->origin.x) * inv_cell_size);
+    int y = (int)floorf((position->y - pvs->origin.y) * inv_cell_size);
+    int z = (int)floorf((position->z - pvs->origin.z) * inv_cell_size);
+
+    if (x < 0 || y < 0 || z < 0 || x >= pvs->cells_x || y >= pvs->cells_y || z >= pvs->cells_z) {
+        return NULL;
+    }
+
+    int row = pvs->cell_rows[x + pvs->cells_x * (z + pvs->cells_z * y)];
+    return &pvs->rows[row * pvs->row_size];
+}
+
+int pvs_find_chunk(struct pvs* pvs, const char* name) {
+    for (int i = 0; i < pvs->chunk_count; i++) {
+        if (strcmp(pvs->chunk_names[i], name) == 0) {
+            return i;
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,40 @@
+#ifndef __RENDER_PVS_H__
+#define __RENDER_PVS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../math/vector3.h"
+
+/// @brief Potentially visible set of the map chunks, baked offline over a grid of camera cells (see tools/collision_export/pvs_export.py)
+///
+/// Every cell stores the index of a row with one bit per chunk, cells that see the same chunks share a row.
+struct pvs {
+    Vector3 origin; // minimum corner of the grid
+    float cell_size;
+    uint16_t cells_x;
+    uint16_t cells_y;
+    uint16_t cells_z;
+    uint16_t chunk_count;
+    uint16_t row_size; // in bytes
+    uint16_t* cell_rows; // row index of every cell, cells are ordered along x, then z, then y
+    uint8_t* rows;
+    char** chunk_names; // the names of the objects in the map model
+};
+
+/// @brief Returns the visible chunks for a camera position
+/// @param pvs
+/// @param position the camera position
+/// @return a bitset with a bit per chunk or NULL if the position is outside of the grid
+const uint8_t* pvs_visible_chunks(struct pvs* pvs, Vector3* position);
+
+/// @brief Returns the index of a chunk by name
+/// @param pvs
+/// @param name
+/// @return the chunk index or -1 if no chunk has this name
+int pvs_find_chunk(struct pvs* pvs, const char* name);
+
+static inline bool pvs_is_chunk_visible(const uint8_t* visible_chunks, int chunk) {
+    return (visible_chunks[chunk >> 3] & (1 << (chunk & 7))) != 0;
+}
+
+#endif
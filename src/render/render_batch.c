@@ -4,15 +4,105 @@
 #include "../time/time.h"
 #include "../math/mathf.h"
 #include "material.h"
+#include "render_state.h"
 #include "defs.h"
 #include <stdbool.h>
+#include <assert.h>
 
 T3DVertPacked billboard_vertices[2];
 
-void render_batch_init(struct render_batch *batch, Transform *camera_transform, struct frame_memory_pool *pool)
+static struct render_state render_batch_state;
+
+static bool element_type_2d[] = {
+    [RENDER_BATCH_SKYBOX] = true,
+    [RENDER_BATCH_MODEL] = false,
+    [RENDER_BATCH_BILLBOARD] = true,
+    [RENDER_BATCH_CALLBACK] = false,
+    [RENDER_BATCH_EQUIDISTANT] = false,
+    
+};
+
+static uint8_t element_type_layer[] = {
+    [RENDER_BATCH_SKYBOX] = RENDER_BATCH_LAYER_BACKGROUND,
+    [RENDER_BATCH_MODEL] = RENDER_BATCH_LAYER_WORLD,
+    [RENDER_BATCH_BILLBOARD] = RENDER_BATCH_LAYER_WORLD,
+    [RENDER_BATCH_CALLBACK] = RENDER_BATCH_LAYER_WORLD,
+    [RENDER_BATCH_EQUIDISTANT] = RENDER_BATCH_LAYER_WORLD,
+};
+
+// distances from the camera beyond this all sort as the far end
+#define SORT_DEPTH_RANGE        256.0f
+#define SORT_DEPTH_BITS         16
+#define SORT_DEPTH_FAR          ((1 << SORT_DEPTH_BITS) - 1)
+#define SORT_MATERIAL_BITS      14
+#define SORT_TEXTURE_BITS       12
+#define SORT_TYPE_BITS          3
+#define SORT_PRIORITY_BITS      16
+
+void render_batch_init(struct render_batch *batch, Transform *camera_transform, struct render_fog_params *fog, struct frame_memory_pool *pool)
 {
     batch->element_count = 0;
     batch->pool = pool;
+    batch->camera_position = camera_transform->position;
+    batch->fog = fog;
+}
+
+// folds a pointer into a small id, distinct pointers may share an id which only costs a state change
+static inline uint64_t render_batch_sort_id(const void* pointer, int bits)
+{
+    uintptr_t value = (uintptr_t)pointer >> 3;
+    return (value ^ (value >> bits)) & ((1 << bits) - 1);
+}
+
+/**
+ * @brief Packs the draw order of an element into a 64 bit key, elements are drawn in ascending key order.
+ *
+ * Opaque elements, from the most significant bit:
+ * layer (2) | sort priority (16) | 2D (1) | texture (12) | type (3) | material (14) | depth (16)
+ * so elements sharing a texture are drawn together even across element types, keeping the texture resident in tmem,
+ * then grouped by material and drawn front to back within a group.
+ *
+ * Transparent elements (sort priority >= SORT_PRIORITY_TRANSPARENT):
+ * layer (2) | sort priority (16) | inverted depth (16) | 2D (1) | texture (12) | type (3) | material (14)
+ * so they are drawn back to front and only grouped by state at equal depth.
+ *
+ * @param batch
+ * @param element the element with type and material already set
+ * @param state_id identifies the render state of elements without a material, such as the block of a t3d model
+ * @param position the position used for depth, NULL sorts the element to the far end
+ */
+static uint64_t render_batch_sort_key(struct render_batch *batch, struct render_batch_element *element, const void *state_id, Vector3 *position)
+{
+    int priority = element->material ? element->material->sort_priority : SORT_PRIORITY_OPAQUE;
+
+    uint64_t depth = SORT_DEPTH_FAR;
+
+    if (position)
+    {
+        float distance = vector3Dist(position, &batch->camera_position) * (SORT_DEPTH_FAR / SORT_DEPTH_RANGE);
+        depth = distance < SORT_DEPTH_FAR ? (uint64_t)distance : SORT_DEPTH_FAR;
+    }
+
+    uint64_t texture = element->material ? render_batch_sort_id(element->material->tex0.sprite, SORT_TEXTURE_BITS) : 0;
+    uint64_t material = render_batch_sort_id(element->material ? element->material : state_id, SORT_MATERIAL_BITS);
+
+    uint64_t state = element_type_2d[element->type];
+    state = (state << SORT_TEXTURE_BITS) | texture;
+    state = (state << SORT_TYPE_BITS) | element->type;
+    state = (state << SORT_MATERIAL_BITS) | material;
+
+    uint64_t result = element_type_layer[element->type];
+    // bias the signed priority so it sorts correctly as unsigned
+    result = (result << SORT_PRIORITY_BITS) | (uint16_t)(priority + 0x8000);
+
+    if (priority >= SORT_PRIORITY_TRANSPARENT)
+    {
+        result = (result << SORT_DEPTH_BITS) | (SORT_DEPTH_FAR - depth);
+        return (result << (1 + SORT_TYPE_BITS + SORT_TEXTURE_BITS + SORT_MATERIAL_BITS)) | state;
+    }
+
+    result = (result << (1 + SORT_TYPE_BITS + SORT_TEXTURE_BITS + SORT_MATERIAL_BITS)) | state;
+    return (result << SORT_DEPTH_BITS) | depth;
 }
 
 static struct render_batch_element *render_batch_add_init(struct render_batch *batch)
@@ -29,11 +119,14 @@ static struct render_batch_element *render_batch_add_init(struct render_batch *b
     result->type = RENDER_BATCH_MODEL;
     result->model.block = 0;
     result->model.transform = NULL;
+    result->model.t3d_model = NULL;
+    result->model.filter = NULL;
+    result->model.filter_data = NULL;
 
     return result;
 }
 
-void render_batch_add_t3dmodel(struct render_batch *batch, struct model *model, T3DMat4FP *transform)
+void render_batch_add_t3dmodel(struct render_batch *batch, struct model *model, T3DMat4FP *transform, Vector3 *position)
 {
     struct render_batch_element *element = render_batch_add_init(batch);
 
@@ -46,6 +139,30 @@ void render_batch_add_t3dmodel(struct render_batch *batch, struct model *model,
     element->model.block = model->t3d_model->userBlock;
     element->material = NULL; // T3DModels have their own materials
     element->model.transform = transform;
+    // skinned models draw with the bone matrices of their own skeleton
+    element->model.t3d_model = model->has_skeleton ? NULL : model->t3d_model;
+    element->sort_key = render_batch_sort_key(batch, element, element->model.block, position);
+}
+
+void render_batch_add_t3dmodel_filtered(struct render_batch *batch, struct model *model, T3DMat4FP *transform, Vector3 *position, RenderObjectFilter filter, void *filter_data)
+{
+    assert(!model->has_skeleton);
+
+    struct render_batch_element *element = render_batch_add_init(batch);
+
+    if (!element)
+    {
+        return;
+    }
+
+    element->type = RENDER_BATCH_MODEL;
+    element->model.block = model->t3d_model->userBlock;
+    element->material = NULL;
+    element->model.transform = transform;
+    element->model.t3d_model = model->t3d_model;
+    element->model.filter = filter;
+    element->model.filter_data = filter_data;
+    element->sort_key = render_batch_sort_key(batch, element, element->model.block, position);
 }
 
 void render_batch_add_callback(struct render_batch *batch, struct material *material, RenderCallback callback, void *data)
@@ -61,19 +178,45 @@ void render_batch_add_callback(struct render_batch *batch, struct material *mate
     element->material = material;
     element->callback.callback = callback;
     element->callback.data = data;
+    element->sort_key = render_batch_sort_key(batch, element, callback, NULL);
 }
 
-struct render_batch_billboard_element *render_batch_add_particles(struct render_batch *batch, struct material *material, int count)
+struct render_batch_billboard_element *render_batch_add_particles(struct render_batch *batch, struct material *material, int count, Vector3 *position)
 {
     struct render_batch_element *result = render_batch_add_init(batch);
 
+    if (!result)
+    {
+        return NULL;
+    }
+
     result->type = RENDER_BATCH_BILLBOARD;
     result->material = material;
     result->billboard = render_batch_get_sprites(batch, count);
+    result->billboard.atlas = NULL;
+    result->sort_key = render_batch_sort_key(batch, result, NULL, position);
 
     return &result->billboard;
 }
 
+struct render_billboard_sprite *render_batch_add_impostor(struct render_batch *batch, struct material *material, sprite_t *atlas, Vector3 *position)
+{
+    struct render_batch_element *element = render_batch_add_init(batch);
+
+    if (!element)
+    {
+        return NULL;
+    }
+
+    element->type = RENDER_BATCH_BILLBOARD;
+    element->material = material;
+    element->billboard = render_batch_get_sprites(batch, 1);
+    element->billboard.atlas = atlas;
+    element->sort_key = render_batch_sort_key(batch, element, NULL, position);
+
+    return element->billboard.sprite_count ? element->billboard.sprites : NULL;
+}
+
 void render_batch_add_equidistant(struct render_batch* batch, rspq_block_t* block){
     struct render_batch_element* element = render_batch_add_init(batch);
 
@@ -87,6 +230,7 @@ void render_batch_add_equidistant(struct render_batch* batch, rspq_block_t* bloc
     element->material = NULL;
     element->model.block = block;
     element->model.transform = NULL;
+    element->sort_key = render_batch_sort_key(batch, element, block, NULL);
 }
 
 void render_batch_add_skybox_flat(struct render_batch* batch, surface_t* surface){
@@ -100,14 +244,20 @@ void render_batch_add_skybox_flat(struct render_batch* batch, surface_t* surface
     element->type = RENDER_BATCH_SKYBOX;
     element->material = NULL;
     element->skybox.surface = surface;
+    element->sort_key = render_batch_sort_key(batch, element, surface, NULL);
 }
 
 struct render_batch_billboard_element render_batch_get_sprites(struct render_batch *batch, int count)
 {
     struct render_batch_billboard_element result;
 
+    if (count > MAX_BILLBOARD_SPRITES)
+    {
+        count = MAX_BILLBOARD_SPRITES;
+    }
+
     result.sprites = frame_malloc(batch->pool, count * sizeof(struct render_billboard_sprite));
-    result.sprite_count = count;
+    result.sprite_count = result.sprites ? count : 0;
 
     return result;
 }
@@ -122,67 +272,79 @@ T3DMat4FP *render_batch_get_transformfp(struct render_batch *batch)
     return UncachedAddr(frame_malloc(batch->pool, sizeof(T3DMat4FP)));
 }
 
-/**
- * @brief Compares two elements in a render batch.
- *
- * This function compares two elements in a render batch based on their materials and types.
- * It is used to determine the order of elements for rendering.
- *
- * @param batch Pointer to the render batch containing the elements.
- * @param a_index Index of the first element to compare.
- * @param b_index Index of the second element to compare.
- * @return An integer less than, equal to, or greater than zero if the first element is considered
- *         to be respectively less than, equal to, or greater than the second element.
- *
- * The comparison is performed as follows:
- * - If both elements are the same, return 0.
- * - If the first element has no material and the second element has a material, return the negative sort priority of the second element's material.
- * - If the second element has no material and the first element has a material, return the sort priority of the first element's material.
- * - If both elements have materials and their sort priorities differ, return the difference between their sort priorities.
- * - If both elements have materials but they are different, return the difference between their material pointers.
- * - If all previous checks are equal, return the difference between their types.
- */
-int render_batch_compare_element(struct render_batch *batch, uint16_t a_index, uint16_t b_index)
+// returns how many elements starting at order[start] draw the same model and can be drawn instanced
+static int render_batch_instance_count(struct render_batch *batch, uint16_t *order, int start)
 {
-    struct render_batch_element *a = &batch->elements[a_index];
-    struct render_batch_element *b = &batch->elements[b_index];
+    struct render_batch_element *first = &batch->elements[order[start]];
 
-    if (a == b)
+    if (!first->model.t3d_model || !first->model.transform || first->model.filter)
     {
-        return 0;
+        return 1;
     }
 
-    if (!a->material && b->material)
-    {
-        return -b->material->sort_priority;
+    int end = start + 1;
 
-    }
-    if (!b->material && a->material)
+    while (end < batch->element_count)
     {
-        return a->material->sort_priority;
+        struct render_batch_element *element = &batch->elements[order[end]];
 
+        if (element->type != RENDER_BATCH_MODEL || element->model.t3d_model != first->model.t3d_model || !element->model.transform || element->model.filter)
+        {
+            break;
+        }
+
+        ++end;
     }
 
-    if ((a->material && b->material) && a->material->sort_priority != b->material->sort_priority)
+    return end - start;
+}
+
+/// @brief Draws several instances of the same model, every material is set once and followed by the object of every instance
+/// @param batch
+/// @param order the sorted element indices, starting at the first instance
+/// @param count the number of instances
+static void render_batch_draw_instanced(struct render_batch *batch, uint16_t *order, int count)
+{
+    T3DModel *model = batch->elements[order[0]].model.t3d_model;
+
+    T3DModelState model_state = t3d_model_state_create();
+    T3DModelIter it = t3d_model_iter_create(model, T3D_CHUNK_TYPE_OBJECT);
+
+    while (t3d_model_iter_next(&it))
     {
-        return a->material->sort_priority - b->material->sort_priority;
+        if (it.object->material)
+        {
+            t3d_model_draw_material(it.object->material, &model_state);
+        }
+
+        t3d_matrix_push(batch->elements[order[0]].model.transform);
+        t3d_model_draw_object(it.object, NULL);
+
+        for (int i = 1; i < count; ++i)
+        {
+            // replace the top of the matrix stack instead of a push and pop per instance
+            t3d_matrix_set(batch->elements[order[i]].model.transform, true);
+            t3d_model_draw_object(it.object, NULL);
+        }
+
+        t3d_matrix_pop(1);
     }
 
-    if (a->material != b->material)
+    if (model_state.lastVertFXFunc != T3D_VERTEX_FX_NONE)
     {
-        return (int)a->material - (int)b->material;
+        t3d_state_set_vertex_fx(T3D_VERTEX_FX_NONE, 0, 0);
     }
-
-    return a->type - b->type;
 }
 
-void render_batch_check_texture_scroll(int tile, struct material_tex *tex)
+void render_batch_check_texture_scroll(struct render_state *state, int tile, struct material_tex *tex)
 {
     if (!tex->sprite || (!tex->scroll_x && !tex->scroll_y))
     {
         return;
     }
 
+    render_state_set_tile_scrolled(state, tile);
+
     int w = tex->sprite->width << 2;
     int h = tex->sprite->height << 2;
 
@@ -206,15 +368,197 @@ void render_batch_check_texture_scroll(int tile, struct material_tex *tex)
         y_offset + h);
 }
 
-static bool element_type_2d[] = {
-    [RENDER_BATCH_SKYBOX] = true,
-    [RENDER_BATCH_MODEL] = false,
-    [RENDER_BATCH_BILLBOARD] = true,
-    [RENDER_BATCH_CALLBACK] = false,
-    [RENDER_BATCH_EQUIDISTANT] = false,
-    
+/// @brief Uploads the textures of the material unless they are still in tmem from a previous element and runs its block
+/// @param state
+/// @param material
+static void render_batch_apply_material(struct render_state* state, struct material* material)
+{
+    // the textures go first, a sprite upload also loads the palette of the sprite and would overwrite the one the block uploads
+    render_state_upload_textures(state, &material->tex0, &material->tex1);
+
+    rspq_block_run(material->block);
+    render_state_invalidate_material(state, RENDER_STATE_MODE_UNKNOWN);
+
+    // the palette of the block replaces the one a ci sprite brought along, the sprite has to be uploaded again for other materials
+    if (material->palette.tlut) {
+        render_state_invalidate_tlut(state, material->palette.idx, material->palette.size);
+    }
+}
+
+// sprite depths are quantized so sprites close to each other share the z override
+#define BILLBOARD_DEPTH_BUCKETS 4096
+
+struct render_batch_projected_sprite {
+    int16_t x0, y0, x1, y1;
+    color_t color;
+    uint16_t depth; // depth bucket, 0 is the near plane
+    uint8_t frame;
 };
 
+// the sprites of one billboard element are projected and sorted here before drawing
+static struct render_batch_projected_sprite projected_sprites[MAX_BILLBOARD_SPRITES];
+static uint32_t projected_keys[MAX_BILLBOARD_SPRITES];
+static uint16_t projected_order[MAX_BILLBOARD_SPRITES];
+
+static struct render_batch_billboard_stats render_batch_billboard_stats;
+
+/// @brief Draws one projected sprite, the z override, prim color and atlas frame are only emitted when they change
+/// @param state
+/// @param element
+/// @param sprite
+/// @param atlas_surface the pixels of the atlas, unused if the element has none
+/// @param uploaded_frame the atlas frame currently in tmem, -1 if none
+static void render_batch_draw_projected_sprite(struct render_state* state, struct render_batch_element* element, struct render_batch_projected_sprite* sprite, surface_t* atlas_surface, int* uploaded_frame)
+{
+    // Override Z-buffer with sprite depth
+    render_state_set_zoverride(state, true, sprite->depth * (1.0f / (BILLBOARD_DEPTH_BUCKETS - 1)));
+
+    // Default image dimensions
+    int image_s = 0;
+    int image_w = 1;
+    int image_h = 1;
+
+    sprite_t* atlas = element->billboard.atlas;
+
+    if (atlas)
+    {
+        // only the frame is uploaded, the whole atlas would not fit into tmem
+        image_h = atlas->height;
+        image_s = sprite->frame * image_h;
+        image_w = image_s + image_h;
+
+        if (sprite->frame != *uploaded_frame)
+        {
+            render_state_upload_sub(state, TILE0, atlas_surface, image_s, 0, image_w, image_h);
+            *uploaded_frame = sprite->frame;
+        }
+    }
+    // Update image dimensions if material has a sprite
+    else if (element->material->tex0.sprite)
+    {
+        image_w = element->material->tex0.sprite->width;
+        image_h = element->material->tex0.sprite->height;
+    }
+
+    // Set sprite color
+    render_state_set_prim_color(state, sprite->color);
+
+    // Draw the sprite
+    rdpq_texture_rectangle_scaled(
+        TILE0,
+        sprite->x0,
+        sprite->y0,
+        sprite->x1,
+        sprite->y1,
+        image_s,
+        0,
+        image_w,
+        image_h);
+}
+
+/// @brief Projects the sprites of a billboard element and draws them as textured rectangles.
+/// Sprites of blended materials are sorted back to front once, sprites in the same depth bucket are ordered by color so the
+/// z override and prim color are only emitted when they change. Other materials don't depend on the order and are drawn as they are projected
+/// @param state
+/// @param element
+/// @param view_proj_matrix
+/// @param viewport
+/// @param scale_x the scale from sprite radius to screen width
+/// @param scale_y the scale from sprite radius to screen height
+/// @return the number of sprites drawn
+static int render_batch_draw_sprites(struct render_state* state, struct render_batch_element* element, Matrix4x4* view_proj_matrix, T3DViewport* viewport, float scale_x, float scale_y)
+{
+    bool depth_sort = (element->material->flags & MATERIAL_FLAGS_BLENDED) != 0;
+
+    surface_t atlas_surface;
+
+    if (element->billboard.atlas)
+    {
+        atlas_surface = sprite_get_pixels(element->billboard.atlas);
+    }
+
+    int uploaded_frame = -1;
+    int count = 0;
+
+    for (int sprite_index = 0; sprite_index < element->billboard.sprite_count; ++sprite_index)
+    {
+        struct render_billboard_sprite* sprite = &element->billboard.sprites[sprite_index];
+
+        // Transform sprite position to view projection space
+        Vector4 transformed;
+        matrix4Vec3Mul(view_proj_matrix, &sprite->position, &transformed);
+
+        // w is the homogeneous coordinate, if it is less than 0 the point is behind the camera
+        if (transformed.w < 0.0f)
+        {
+            continue; // Skip if behind the camera
+        }
+
+        // the inverse of the homogeneous coordinate is used to calculate the screen space coordinates
+        float wInv = 1.0f / transformed.w;
+
+        // Calculate screen space coordinates
+        float x = (transformed.x * wInv + 1.0f) * 0.5f;
+        float y = (-transformed.y * wInv + 1.0f) * 0.5f;
+        float z = (transformed.z * wInv + 1.0f) * 0.5f;
+        float billboard_size = sprite->radius * wInv;
+
+        if (z < 0.0f || z > 1.0f)
+        {
+            continue; // Skip if outside the depth range
+        }
+
+        // Convert to screen space coordinates
+        int screen_x = (int)(x * (viewport->size[0])) + viewport->offset[0];
+        int screen_y = (int)(y * (viewport->size[1])) + viewport->offset[1];
+
+        // Calculate half dimensions of the sprite on screen
+        int half_screen_width = (int)(billboard_size * scale_x * viewport->size[0] * 0.25f);
+        int half_screen_height = (int)(billboard_size * scale_y * viewport->size[1] * 0.25f);
+
+        struct render_batch_projected_sprite projected;
+        projected.x0 = screen_x - half_screen_width;
+        projected.y0 = screen_y - half_screen_height;
+        projected.x1 = screen_x + half_screen_width;
+        projected.y1 = screen_y + half_screen_height;
+        projected.color = sprite->color;
+        projected.depth = (uint16_t)(z * (BILLBOARD_DEPTH_BUCKETS - 1) + 0.5f);
+        projected.frame = element->billboard.atlas ? sprite->frame : 0;
+
+        if (!depth_sort)
+        {
+            render_batch_draw_projected_sprite(state, element, &projected, &atlas_surface, &uploaded_frame);
+            ++count;
+            continue;
+        }
+
+        // far sprites first, within a bucket sprites with the same color end up next to each other.
+        // the color is reduced to 4 bits per channel and 8 bits of alpha to fit the key, similar colors may still interleave
+        projected_keys[count] = ((uint32_t)(BILLBOARD_DEPTH_BUCKETS - 1 - projected.depth) << 20) |
+                                ((uint32_t)(projected.color.r >> 4) << 16) |
+                                ((uint32_t)(projected.color.g >> 4) << 12) |
+                                ((uint32_t)(projected.color.b >> 4) << 8) |
+                                projected.color.a;
+        projected_sprites[count] = projected;
+        projected_order[count] = count;
+        ++count;
+    }
+
+    if (!depth_sort)
+    {
+        return count;
+    }
+
+    sort_indices_radix32(projected_order, count, projected_keys);
+
+    for (int i = 0; i < count; ++i)
+    {
+        render_batch_draw_projected_sprite(state, element, &projected_sprites[projected_order[i]], &atlas_surface, &uploaded_frame);
+    }
+
+    return count;
+}
+
 void render_batch_execute(struct render_batch *batch, Matrix4x4 view_proj_matrix, T3DViewport *viewport, struct render_fog_params *fog)
 {
     uint16_t order[RENDER_BATCH_MAX_SIZE];
@@ -237,12 +581,22 @@ void render_batch_execute(struct render_batch *batch, Matrix4x4 view_proj_matrix
                         view_proj_matrix.m[1][2] * view_proj_matrix.m[1][2]) *
                     0.5f * 4;
 
-    sort_indices(order, batch->element_count, batch, (sort_compare)render_batch_compare_element);
+    uint64_t keys[RENDER_BATCH_MAX_SIZE];
+
+    for (int i = 0; i < batch->element_count; ++i)
+    {
+        keys[i] = batch->elements[i].sort_key;
+    }
+
+    sort_indices_radix(order, batch->element_count, keys);
+
+    struct render_state* state = &render_batch_state;
+    render_state_reset(state);
+    render_batch_billboard_stats.sprites = 0;
+    render_batch_billboard_stats.ticks = 0;
 
     bool is_sprite_mode = false;
-    bool z_write = true;
-    bool z_read = true;
-    rdpq_mode_persp(true);
+    render_state_set_persp(state, true);
     for (int i = 0; i < batch->element_count; ++i)
     {
         int index = order[i];
@@ -254,21 +608,13 @@ void render_batch_execute(struct render_batch *batch, Matrix4x4 view_proj_matrix
         {
             if (should_sprite_mode)
             {
-                rdpq_set_mode_standard();
-                rdpq_mode_persp(false);
+                render_state_set_mode_standard(state);
+                render_state_set_persp(state, false);
             }
             else
             {
-                if(fog && fog->enabled){
-                    rdpq_mode_fog(RDPQ_FOG_STANDARD);
-                    rdpq_set_fog_color(fog->color);
-                    t3d_fog_set_enabled(true);
-                    t3d_fog_set_range(fog->start, fog->end);
-                } else {
-                    t3d_fog_set_enabled(false);
-                }
-                rdpq_mode_zoverride(false, 0, 0);
-                
+                render_state_set_fog(state, fog);
+                render_state_set_zoverride(state, false, 0);
             }
 
             is_sprite_mode = should_sprite_mode;
@@ -276,33 +622,54 @@ void render_batch_execute(struct render_batch *batch, Matrix4x4 view_proj_matrix
         // -------- Model Element ----------
         if (element->type == RENDER_BATCH_MODEL)
         {
-            rdpq_set_mode_standard();
-            rdpq_mode_persp(true);
-            if(fog && fog->enabled){
-                rdpq_mode_fog(RDPQ_FOG_STANDARD);
-                rdpq_set_fog_color(fog->color);
-                t3d_fog_set_enabled(true);
-                t3d_fog_set_range(fog->start, fog->end);
-            } else {
-                t3d_fog_set_enabled(false);
-            }
-            rdpq_mode_zoverride(false, 0, 0);
-            rdpq_mode_zbuf(true, true);
-            t3d_state_set_drawflags(T3D_FLAG_DEPTH | T3D_FLAG_SHADED | T3D_FLAG_TEXTURED | T3D_FLAG_CULL_BACK);
+            // only the state that differs from the previous element is emitted
+            render_state_set_mode_model(state);
+            render_state_set_persp(state, true);
+            render_state_set_fog(state, fog);
+            render_state_set_zoverride(state, false, 0);
+            render_state_set_zbuf(state, true, true);
+            render_state_set_drawflags(state, T3D_FLAG_DEPTH | T3D_FLAG_SHADED | T3D_FLAG_TEXTURED | T3D_FLAG_CULL_BACK);
             // Skip if no rspq block
             if (!element->model.block)
             {
                 continue;
             }
 
+            int instance_count = render_batch_instance_count(batch, order, i);
+
+            if (instance_count > 1)
+            {
+                render_batch_draw_instanced(batch, &order[i], instance_count);
+                render_state_invalidate_material(state, RENDER_STATE_MODE_MODEL);
+                render_state_invalidate_tmem(state);
+                i += instance_count - 1;
+                continue;
+            }
+
             // Push transform if it exists
             if (element->model.transform)
             {
                 t3d_matrix_push(element->model.transform);
             }
 
-            // Run the rspq block rendering the model
-            rspq_block_run(element->model.block);
+            if (element->model.filter)
+            {
+                T3DModelDrawConf conf = {
+                    .userData = element->model.filter_data,
+                    .tileCb = NULL,
+                    .filterCb = element->model.filter,
+                    .matrices = NULL,
+                };
+                t3d_model_draw_custom(element->model.t3d_model, conf);
+            }
+            else
+            {
+                // Run the rspq block rendering the model
+                rspq_block_run(element->model.block);
+            }
+            // t3d materials upload their own textures
+            render_state_invalidate_material(state, RENDER_STATE_MODE_MODEL);
+            render_state_invalidate_tmem(state);
 
             // Pop transform if it exists
             if (element->model.transform)
@@ -318,99 +685,36 @@ void render_batch_execute(struct render_batch *batch, Matrix4x4 view_proj_matrix
                 continue; // Skip if no material since that indicates there is also no texture to be rendered
             }
 
-            rspq_block_run(element->material->block);
+            render_batch_apply_material(state, element->material);
 
-            render_batch_check_texture_scroll(TILE0, &element->material->tex0);
-            render_batch_check_texture_scroll(TILE1, &element->material->tex1);
+            render_batch_check_texture_scroll(state, TILE0, &element->material->tex0);
+            render_batch_check_texture_scroll(state, TILE1, &element->material->tex1);
 
             bool need_z_write = (element->material->flags & MATERIAL_FLAGS_Z_WRITE) != 0;
             bool need_z_read = (element->material->flags & MATERIAL_FLAGS_Z_READ) != 0;
+            render_state_set_zbuf(state, need_z_read, need_z_write);
 
-            if (need_z_write != z_write || need_z_read != z_read)
+            // the impostor material blends between the fog color in env and the texture by the sprite color
+            if (element->billboard.atlas && fog && fog->enabled)
             {
-                rdpq_mode_zbuf(need_z_read, need_z_write);
-                z_write = need_z_write;
-                z_read = need_z_read;
+                rdpq_set_env_color(fog->color);
             }
 
-            // Loop through each sprite in the billboard
-            for (int sprite_index = 0; sprite_index < element->billboard.sprite_count; ++sprite_index)
-            {
-                struct render_billboard_sprite sprite = element->billboard.sprites[sprite_index];
-
-                // Transform sprite position to view projection space
-                Vector4 transformed;
-                matrix4Vec3Mul(&view_proj_matrix, &sprite.position, &transformed);
+            uint64_t start_ticks = get_ticks();
+            render_batch_billboard_stats.sprites += render_batch_draw_sprites(state, element, &view_proj_matrix, viewport, billboard_scale_x, billboard_scale_y);
+            render_batch_billboard_stats.ticks += get_ticks() - start_ticks;
 
-                // w is the homogeneous coordinate, if it is less than 0 the point is behind the camera
-                
-                if (transformed.w < 0.0f)
-                {
-                    continue; // Skip if behind the camera
-                }
-
-                // the inverse of the homogeneous coordinate is used to calculate the screen space coordinates
-                float wInv = 1.0f / transformed.w;
-
-                // Calculate screen space coordinates
-                float x = (transformed.x * wInv + 1.0f) * 0.5f ;
-                float y = (-transformed.y * wInv + 1.0f) * 0.5f ;
-                float z = (transformed.z * wInv + 1.0f) * 0.5f; // Corrected z calculation
-                float billboard_size = sprite.radius * wInv;
-
-                if (z < 0.0f || z > 1.0f)
-                {
-                    continue; // Skip if outside the depth range
-                }
-
-                // Override Z-buffer with sprite depth
-                rdpq_mode_zoverride(true, z, 0);
-
-                // Convert to screen space coordinates
-                int screen_x = (int)(x * (viewport->size[0])) + viewport->offset[0];
-                int screen_y = (int)(y * (viewport->size[1])) + viewport->offset[1];
-
-                // Calculate half dimensions of the sprite on screen
-                int half_screen_width = (int)(billboard_size * billboard_scale_x * viewport->size[0] * 0.25f);
-                int half_screen_height = (int)(billboard_size * billboard_scale_y * viewport->size[1] * 0.25f);
-
-                // Default image dimensions
-                int image_w = 1;
-                int image_h = 1;
-
-                // Update image dimensions if material has a sprite
-                if (element->material && element->material->tex0.sprite)
-                {
-                    image_w = element->material->tex0.sprite->width;
-                    image_h = element->material->tex0.sprite->height;
-                }
-
-                // Set sprite color
-                rdpq_set_prim_color(sprite.color);
-
-                // Draw the sprite
-                rdpq_texture_rectangle_scaled(
-                    TILE0,
-                    screen_x - half_screen_width,
-                    screen_y - half_screen_height,
-                    screen_x + half_screen_width,
-                    screen_y + half_screen_height,
-                    0,
-                    0,
-                    image_w,
-                    image_h);
-            }
-            rdpq_mode_zoverride(false, 0, 0);
+            render_state_set_zoverride(state, false, 0);
         }
         // skybox rendered as a physical object
         else if (element->type == RENDER_BATCH_EQUIDISTANT){
             if(!element->model.block){
                 continue;
             }
-            rdpq_mode_persp(true);
-            rdpq_mode_zbuf(true, true);
-            t3d_state_set_drawflags(T3D_FLAG_DEPTH | T3D_FLAG_SHADED | T3D_FLAG_TEXTURED);
-            rdpq_mode_zoverride(true, 1, 0);
+            render_state_set_persp(state, true);
+            render_state_set_zbuf(state, true, true);
+            render_state_set_drawflags(state, T3D_FLAG_DEPTH | T3D_FLAG_SHADED | T3D_FLAG_TEXTURED);
+            render_state_set_zoverride(state, true, 1);
             T3DMat4FP *mtxfp = render_batch_get_transformfp(batch);
 
             if (!mtxfp)
@@ -434,6 +738,8 @@ void render_batch_execute(struct render_batch *batch, Matrix4x4 view_proj_matrix
             t3d_mat4_to_fixed_3x4(mtxfp, &mtx);
             t3d_matrix_set(mtxfp, false);
             rspq_block_run(element->model.block);
+            render_state_invalidate_material(state, RENDER_STATE_MODE_MODEL);
+            render_state_invalidate_tmem(state);
         }
         // -------- Skybox Flat Element ----------
         else if (element->type == RENDER_BATCH_SKYBOX)
@@ -482,8 +788,8 @@ void render_batch_execute(struct render_batch *batch, Matrix4x4 view_proj_matrix
             texOffsetY = ((texOffsetY) < (0) ? (0) : ((texOffsetY) > (off_max) ? (off_max) : (texOffsetY)));
             // texOffsetY = clampi(texOffsetY, 0, element->skybox.surface->height - 1 - section_height);
 
-            rdpq_set_mode_standard();
-            rdpq_mode_zoverride(true, 1, 0);
+            render_state_set_mode_standard(state);
+            render_state_set_zoverride(state, true, 1);
 
             // if the window is within the bounds of the texture, just blit it
             if (texOffsetX + section_width < element->skybox.surface->width)
@@ -528,7 +834,10 @@ void render_batch_execute(struct render_batch *batch, Matrix4x4 view_proj_matrix
                                                                 });
                 }
             }
-            rdpq_mode_zoverride(false, 0, 0);
+            render_state_set_zoverride(state, false, 0);
+            // the blits upload the texture and may change the combiner
+            render_state_invalidate_material(state, RENDER_STATE_MODE_UNKNOWN);
+            render_state_invalidate_tmem(state);
         }
         // -------- Callback Element ----------
         else if (element->type == RENDER_BATCH_CALLBACK)
@@ -538,8 +847,25 @@ void render_batch_execute(struct render_batch *batch, Matrix4x4 view_proj_matrix
             {
                 continue;
             }
-            rdpq_set_mode_standard();
+            render_state_set_mode_standard(state);
+
+            if (element->material && element->material->block)
+            {
+                render_batch_apply_material(state, element->material);
+            }
+
             element->callback.callback(element->callback.data, batch);
+            render_state_invalidate(state);
         }
     }
-}
\ No newline at end of file
+}
+
+const struct render_state_counters* render_batch_get_state_counters()
+{
+    return &render_batch_state.counters;
+}
+
+const struct render_batch_billboard_stats* render_batch_get_billboard_stats()
+{
+    return &render_batch_billboard_stats;
+}
@@ -9,6 +9,7 @@
 #include "model.h"
 #include "material.h"
 #include "frame_alloc.h"
+#include "render_state.h"
 
 #include "../math/matrix.h"
 #include "../math/transform.h"
@@ -16,12 +17,13 @@
 
 #define RENDER_BATCH_MAX_SIZE   256
 #define RENDER_BATCH_TRANSFORM_COUNT    64
-#define MAX_BILLBOARD_SPRITES           128
+#define MAX_BILLBOARD_SPRITES           512 // per billboard element
 
 struct render_billboard_sprite {
     Vector3 position;
     float radius;
     color_t color;
+    uint8_t frame; // square frame of the atlas, only used if the billboard element has one
 };
 
 struct render_fog_params {
@@ -31,6 +33,12 @@ struct render_fog_params {
     color_t color;
 };
 
+// coarse draw order, every element of a layer is drawn before the next layer
+enum render_batch_layer {
+    RENDER_BATCH_LAYER_BACKGROUND, // drawn over the whole framebuffer without depth
+    RENDER_BATCH_LAYER_WORLD,
+};
+
 enum render_batch_type {
     RENDER_BATCH_SKYBOX, // Skybox consisting of a sub-texture that is blit to the framebuffer
     RENDER_BATCH_MODEL, // Tiny3D model
@@ -43,13 +51,17 @@ enum render_batch_type {
 struct render_batch_billboard_element {
     struct render_billboard_sprite* sprites;
     uint16_t sprite_count;
+    sprite_t* atlas; // one row of square frames, the frame of each sprite is uploaded before drawing it. NULL draws the material texture
 };
 
 struct render_batch;
 
 typedef void (*RenderCallback)(void* data, struct render_batch* batch);
+// returns false for objects of a model that should not be drawn
+typedef bool (*RenderObjectFilter)(void* data, const T3DObject* object);
 
 struct render_batch_element {
+    uint64_t sort_key; // see render_batch_sort_key
     struct material* material;
     uint16_t type;
     union {
@@ -59,6 +71,9 @@ struct render_batch_element {
         struct {
             rspq_block_t* block;
             T3DMat4FP* transform;
+            T3DModel* t3d_model; // set if consecutive elements of the same model can be drawn instanced
+            RenderObjectFilter filter; // if set the model is drawn object by object instead of with the block
+            void* filter_data;
         } model;
         struct render_batch_billboard_element billboard;
         struct {
@@ -70,18 +85,37 @@ struct render_batch_element {
 
 struct render_batch {
     struct frame_memory_pool* pool;
+    Vector3 camera_position;
+    struct render_fog_params* fog; // may be NULL
     struct render_batch_element elements[RENDER_BATCH_MAX_SIZE];
     short element_count;
 };
 
-void render_batch_init(struct render_batch* batch, Transform* camera_transform, struct frame_memory_pool* pool);
+void render_batch_init(struct render_batch* batch, Transform* camera_transform, struct render_fog_params* fog, struct frame_memory_pool* pool);
+
+/// @brief Returns true if an object at this distance from the camera is completely hidden by the fog
+/// @param batch
+/// @param distance the distance of the point of the object closest to the camera
+/// @return
+static inline bool render_batch_is_fogged_out(struct render_batch* batch, float distance) {
+    return batch->fog && batch->fog->enabled && distance > batch->fog->end;
+}
 
-void render_batch_add_t3dmodel(struct render_batch* batch, struct model* model, T3DMat4FP* transform);
+// position is used for depth sorting, NULL sorts the model as if it was at the far end
+void render_batch_add_t3dmodel(struct render_batch* batch, struct model* model, T3DMat4FP* transform, Vector3* position);
+
+// draws only the objects of the model that pass the filter, the filter data must stay valid until the batch is executed
+void render_batch_add_t3dmodel_filtered(struct render_batch* batch, struct model* model, T3DMat4FP* transform, Vector3* position, RenderObjectFilter filter, void* filter_data);
 
 void render_batch_add_callback(struct render_batch* batch, struct material* material, RenderCallback callback, void* data);
 // caller is responsible for populating sprite list
-// the sprite count returned may be less than the sprite count requested
-struct render_batch_billboard_element* render_batch_add_particles(struct render_batch* batch, struct material* material, int count);
+// the sprite count returned may be less than the sprite count requested, returns NULL if the batch is full
+// position is the center used for depth sorting
+struct render_batch_billboard_element* render_batch_add_particles(struct render_batch* batch, struct material* material, int count, Vector3* position);
+
+// adds a single billboard sprite showing a frame of the atlas, the caller fills in the sprite
+// returns NULL if the batch is full
+struct render_billboard_sprite* render_batch_add_impostor(struct render_batch* batch, struct material* material, sprite_t* atlas, Vector3* position);
 
 void render_batch_add_equidistant(struct render_batch* batch, rspq_block_t* block);
 
@@ -93,4 +127,14 @@ T3DMat4FP* render_batch_get_transformfp(struct render_batch* batch);
 
 void render_batch_execute(struct render_batch* batch, Matrix4x4 view_proj, T3DViewport* viewport, struct render_fog_params* fog);
 
+// state commands emitted and skipped as redundant by the last render_batch_execute
+const struct render_state_counters* render_batch_get_state_counters();
+
+struct render_batch_billboard_stats {
+    uint16_t sprites; // sprites drawn by the last render_batch_execute
+    uint32_t ticks; // cpu time spent projecting, sorting and submitting them
+};
+
+const struct render_batch_billboard_stats* render_batch_get_billboard_stats();
+
 #endif
\ No newline at end of file
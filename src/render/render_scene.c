@@ -3,14 +3,51 @@
 #include "../util/blist.h"
 #include <malloc.h>
 #include <stdbool.h>
+#include <libdragon.h>
 #include "defs.h"
+#include "../math/mathf.h"
+#include <math.h>
 
 #define MIN_RENDER_SCENE_SIZE   64
+#define RENDER_SCENE_ALL_PLANES ((1 << 6) - 1)
 
 struct render_scene r_scene_3d;
 
 void render_scene_reset() {
     callback_list_reset(&r_scene_3d.callbacks, sizeof(struct render_scene_element), MIN_RENDER_SCENE_SIZE, NULL);
+
+    for (int i = 0; i < r_scene_3d.culled_element_count; ++i) {
+        free(r_scene_3d.culled_elements[i]);
+    }
+    free(r_scene_3d.culled_elements);
+
+    r_scene_3d.culled_elements = malloc(sizeof(struct render_scene_element*) * MIN_RENDER_SCENE_SIZE);
+    r_scene_3d.culled_element_count = 0;
+    r_scene_3d.culled_element_capacity = MIN_RENDER_SCENE_SIZE;
+
+    AABB_tree_free(&r_scene_3d.culling_tree);
+    AABB_tree_init(&r_scene_3d.culling_tree, MIN_RENDER_SCENE_SIZE);
+}
+
+static AABB render_scene_element_bounds(struct render_scene_element* element) {
+    AABB result;
+    vector3Add(element->center, &element->local_bounds.min, &result.min);
+    vector3Add(element->center, &element->local_bounds.max, &result.max);
+    return result;
+}
+
+static void render_scene_add_culled(struct render_scene_element* element) {
+    if (r_scene_3d.culled_element_count == r_scene_3d.culled_element_capacity) {
+        r_scene_3d.culled_element_capacity *= 2;
+        r_scene_3d.culled_elements = realloc(r_scene_3d.culled_elements, sizeof(struct render_scene_element*) * r_scene_3d.culled_element_capacity);
+    }
+
+    element->index = r_scene_3d.culled_element_count;
+    element->last_center = *element->center;
+    element->node = AABB_tree_create_node(&r_scene_3d.culling_tree, render_scene_element_bounds(element), element);
+
+    r_scene_3d.culled_elements[r_scene_3d.culled_element_count] = element;
+    ++r_scene_3d.culled_element_count;
 }
 
 /// @brief Add a callback to the render scene that will be executed on every render
@@ -22,10 +59,59 @@ void render_scene_add_callback(Vector3* center, float radius, render_scene_callb
     struct render_scene_element element;
 
     element.data = data;
+    element.callback = callback;
     element.center = center;
-    element.radius = radius;
+    element.local_bounds = (AABB){{{-radius, -radius, -radius}}, {{radius, radius, radius}}};
+    element.motion = NULL;
+    element.node = AABB_TREE_NULL_NODE;
+
+    if (!center) {
+        callback_list_insert_with_id(&r_scene_3d.callbacks, callback, &element, (callback_id)data);
+        return;
+    }
+
+    struct render_scene_element* culled = malloc(sizeof(struct render_scene_element));
+    *culled = element;
+    render_scene_add_culled(culled);
+}
+
+static void render_scene_add_model(Vector3* center, float radius, struct renderable_matrix_cache* motion, render_scene_callback callback, void* data) {
+    struct render_scene_element* element = malloc(sizeof(struct render_scene_element));
+
+    element->data = data;
+    element->callback = callback;
+    element->center = center;
+    element->local_bounds = (AABB){{{-radius, -radius, -radius}}, {{radius, radius, radius}}};
+    element->motion = motion;
+
+    render_scene_add_culled(element);
+}
+
+/// @brief Adds the baked view of the renderable closest to the camera direction as a billboard
+/// @param renderable
+/// @param batch
+/// @param distance the distance of the renderable to the camera
+static void render_scene_render_impostor(struct renderable* renderable, struct render_batch* batch, float distance) {
+    struct render_billboard_sprite* sprite = render_batch_add_impostor(batch, renderable->impostor_material, renderable->impostor, &renderable->transform->position);
+
+    if (!sprite) {
+        return;
+    }
+
+    // the views are baked with the bounding radius filling the frame
+    sprite->position = renderable->transform->position;
+    sprite->radius = model_bounding_radius(renderable->model, &renderable->transform->scale);
+    sprite->frame = renderable_impostor_frame(renderable, &batch->camera_position);
+
+    // billboards skip the t3d fog, the sprite color blends towards the fog color instead
+    uint8_t visibility = 255;
+
+    if (batch->fog && batch->fog->enabled && distance > batch->fog->start) {
+        float fog = (distance - batch->fog->start) / (batch->fog->end - batch->fog->start);
+        visibility = (uint8_t)(255.0f * (1.0f - minf(fog, 1.0f)));
+    }
 
-    callback_list_insert_with_id(&r_scene_3d.callbacks, callback, &element, (callback_id)data);
+    sprite->color = RGBA32(visibility, visibility, visibility, 255);
 }
 
 /// @brief premade callback for adding a renderable consisting of a transform and a t3d model to a batch that will then be rendered in bulk
@@ -34,18 +120,26 @@ void render_scene_add_callback(Vector3* center, float radius, render_scene_callb
 void render_scene_render_renderable(void* data, struct render_batch* batch) {
     struct renderable* renderable = (struct renderable*)data;
 
-    T3DMat4FP* mtxfp = render_batch_get_transformfp(batch);
+    float distance = vector3Dist(&renderable->transform->position, &batch->camera_position);
 
-    if (!mtxfp) {
+    // past the fog end the model has the same color as the background, as long as its near side is past it as well
+    float radius = model_bounding_radius(renderable->model, &renderable->transform->scale);
+    if (render_batch_is_fogged_out(batch, distance - radius)) {
         return;
     }
 
-    Matrix4x4 mtx;
-    transformToMatrix(renderable->transform, &mtx);
+    if (renderable->impostor && distance > renderable->impostor_distance) {
+        render_scene_render_impostor(renderable, batch, distance);
+        return;
+    }
+
+    // the matrix is only recalculated if the transform changed since the last render
+    T3DMat4FP* mtxfp = renderable_get_matrix(renderable);
 
-    t3d_mat4_to_fixed_3x4(mtxfp, (T3DMat4*)mtx.m);
+    // the level of detail is picked by the size of the model on screen
+    struct model* model = renderable_select_lod(renderable, distance);
 
-    render_batch_add_t3dmodel(batch, renderable->model, mtxfp);
+    render_batch_add_t3dmodel(batch, model, mtxfp, &renderable->transform->position);
 }
 
 /// @brief premade callback for adding a single axis renderable consisting of a transform and a t3d model to a batch that will then be rendered in bulk
@@ -54,42 +148,154 @@ void render_scene_render_renderable(void* data, struct render_batch* batch) {
 void render_scene_render_renderable_single_axis(void* data, struct render_batch* batch) {
     struct renderable_single_axis* renderable = (struct renderable_single_axis*)data;
 
-    T3DMat4FP* mtxfp = render_batch_get_transformfp(batch);
-
-    if (!mtxfp) {
-        return;
-    }
-
-    Matrix4x4 mtx;
-    transformSAToMatrix(renderable->transform, mtx.m);
-
-    t3d_mat4_to_fixed_3x4(mtxfp, (T3DMat4*)mtx.m);
+    T3DMat4FP* mtxfp = renderable_single_axis_get_matrix(renderable);
 
-    render_batch_add_t3dmodel(batch, renderable->model, mtxfp);
+    render_batch_add_t3dmodel(batch, renderable->model, mtxfp, &renderable->transform->position);
 }
 
-/// @brief Add the render_renderable callback to the list of callbacks with the renderable position as the culling center
-/// and the renderable as data
+/// @brief Add the render_renderable callback to the render scene with the renderable as data.
+/// It is culled with bounds from the model AABB, which are only updated while the transform changes
 /// @param renderable 
-/// @param radius 
-void render_scene_add_renderable(struct renderable* renderable, float radius) {
-    render_scene_add_callback(&renderable->transform->position, radius, render_scene_render_renderable, renderable);
+void render_scene_add_renderable(struct renderable* renderable) {
+    float radius = model_bounding_radius(renderable->model, &renderable->transform->scale);
+    render_scene_add_model(&renderable->transform->position, radius, &renderable->_matrix_cache, render_scene_render_renderable, renderable);
 }
 
-/// @brief Add the render_renderable_single_axis callback to the list of callbacks with the renderable position as the culling center
-/// and the renderable as data
+/// @brief Add the render_renderable_single_axis callback to the render scene with the renderable as data.
+/// It is culled with bounds from the model AABB, which are only updated while the transform changes
 /// @param renderable 
-/// @param radius 
-void render_scene_add_renderable_single_axis(struct renderable_single_axis* renderable, float radius) {
-    render_scene_add_callback(&renderable->transform->position, radius, render_scene_render_renderable_single_axis, renderable);
+void render_scene_add_renderable_single_axis(struct renderable_single_axis* renderable) {
+    float radius = model_bounding_radius(renderable->model, &renderable->transform->scale);
+    render_scene_add_model(&renderable->transform->position, radius, &renderable->_matrix_cache, render_scene_render_renderable_single_axis, renderable);
 }
 
 /// @brief remove a callback from the render scene
 /// @param data the pointer to the data that was passed with the callback when adding it
 void render_scene_remove(void* data) {
+    for (int i = 0; i < r_scene_3d.culled_element_count; ++i) {
+        struct render_scene_element* element = r_scene_3d.culled_elements[i];
+
+        if (element->data != data) {
+            continue;
+        }
+
+        AABB_tree_remove_leaf_node(&r_scene_3d.culling_tree, element->node, true);
+
+        --r_scene_3d.culled_element_count;
+        struct render_scene_element* last = r_scene_3d.culled_elements[r_scene_3d.culled_element_count];
+        r_scene_3d.culled_elements[i] = last;
+        last->index = i;
+
+        free(element);
+        return;
+    }
+
     callback_list_remove(&r_scene_3d.callbacks, (callback_id)data);
 }
 
+/// @brief Moves the tree nodes of elements that may have moved since the last frame
+static void render_scene_update_bounds() {
+    for (int i = 0; i < r_scene_3d.culled_element_count; ++i) {
+        struct render_scene_element* element = r_scene_3d.culled_elements[i];
+
+        // sleeping and static renderables keep their node, renderables that moved while culled stay dirty until they are drawn
+        if (element->motion && !renderable_matrix_cache_track_motion(element->motion)) {
+            continue;
+        }
+
+        Vector3 displacement;
+        vector3Sub(element->center, &element->last_center, &displacement);
+        element->last_center = *element->center;
+
+        AABB_tree_move_node(&r_scene_3d.culling_tree, element->node, render_scene_element_bounds(element), &displacement);
+    }
+}
+
+/// @brief Tests a box against the frustum planes in plane_mask
+/// @param frustum
+/// @param box
+/// @param plane_mask the planes the parent box was not fully inside of
+/// @return -1 if the box is outside, otherwise the planes the box is not fully inside of
+static int render_scene_cull_box(const T3DFrustum* frustum, const AABB* box, int plane_mask) {
+    for (int i = 0; i < 6; ++i) {
+        int bit = 1 << i;
+
+        if (!(plane_mask & bit)) {
+            continue;
+        }
+
+        const float* plane = frustum->planes[i].v;
+
+        // the corners furthest along and against the plane normal
+        Vector3 positive;
+        Vector3 negative;
+
+        for (int axis = 0; axis < 3; ++axis) {
+            positive.v[axis] = plane[axis] >= 0.0f ? box->max.v[axis] : box->min.v[axis];
+            negative.v[axis] = plane[axis] >= 0.0f ? box->min.v[axis] : box->max.v[axis];
+        }
+
+        if (vector3Dot((Vector3*)plane, &positive) + plane[3] < 0.0f) {
+            return -1;
+        }
+
+        if (vector3Dot((Vector3*)plane, &negative) + plane[3] >= 0.0f) {
+            plane_mask &= ~bit;
+        }
+    }
+
+    return plane_mask;
+}
+
+/// @brief Executes the callbacks of all elements in the culling tree that intersect the frustum.
+///
+/// Planes a node is fully inside of are not tested for its children, subtrees fully inside the frustum are not tested at all.
+/// @param frustum
+/// @param batch
+static void render_scene_render_culled(const T3DFrustum* frustum, struct render_batch* batch) {
+    AABB_tree* tree = &r_scene_3d.culling_tree;
+
+    if (tree->root == AABB_TREE_NULL_NODE) {
+        return;
+    }
+
+    node_proxy node_stack[AABB_TREE_NODE_QUERY_STACK_SIZE];
+    uint8_t mask_stack[AABB_TREE_NODE_QUERY_STACK_SIZE];
+    int top = 1;
+
+    node_stack[0] = tree->root;
+    mask_stack[0] = RENDER_SCENE_ALL_PLANES;
+
+    while (top > 0) {
+        --top;
+        AABB_tree_node* node = &tree->nodes[node_stack[top]];
+        int plane_mask = mask_stack[top];
+
+        if (plane_mask) {
+            plane_mask = render_scene_cull_box(frustum, &node->bounds, plane_mask);
+
+            if (plane_mask < 0) {
+                continue;
+            }
+        }
+
+        if (AABB_tree_node_isLeaf(node)) {
+            struct render_scene_element* element = node->data;
+            element->callback(element->data, batch);
+            continue;
+        }
+
+        // each level adds at most one entry, the rotations on insert keep the tree far shallower than the stack
+        assertf(top + 2 <= AABB_TREE_NODE_QUERY_STACK_SIZE, "culling tree is deeper than the query stack (%d)", AABB_TREE_NODE_QUERY_STACK_SIZE);
+
+        node_stack[top] = node->_right;
+        mask_stack[top] = plane_mask;
+        ++top;
+        node_stack[top] = node->_left;
+        mask_stack[top] = plane_mask;
+        ++top;
+    }
+}
 
 /// @brief Render the scene
 ///
@@ -102,7 +308,7 @@ void render_scene_remove(void* data) {
 void render_scene_render(struct camera* camera, T3DViewport* viewport, struct frame_memory_pool* pool, struct render_fog_params* fog) {
     struct render_batch batch;
 
-    render_batch_init(&batch, &camera->transform, pool);
+    render_batch_init(&batch, &camera->transform, fog, pool);
 
     struct callback_element* current = callback_list_get(&r_scene_3d.callbacks, 0);
 
@@ -111,19 +317,14 @@ void render_scene_render(struct camera* camera, T3DViewport* viewport, struct fr
     for (int i = 0; i < r_scene_3d.callbacks.count; ++i) {
         struct render_scene_element* el = callback_element_get_data(current);
 
-        // Skip elements outside the frustum, only check if center of Boundingsphere is set
-        if(el->center) {
-            if (!t3d_frustum_vs_sphere(&viewport->viewFrustum, (T3DVec3*)el->center, el->radius))
-            {
-                current = callback_list_next(&r_scene_3d.callbacks, current);
-                continue;
-            }
-        }
-
         ((render_scene_callback)current->callback)(el->data, &batch);
         current = callback_list_next(&r_scene_3d.callbacks, current);
     }
 
+    // Elements with bounds are only executed if they are in the frustum
+    render_scene_update_bounds();
+    render_scene_render_culled(&viewport->viewFrustum, &batch);
+
     // Execute drawing of batch elements
     render_batch_execute(&batch, viewport->matCamProj, viewport, fog);
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "render_batch.h"
 #include "camera.h"
 #include "../util/callback_list.h"
+#include "../collision/aabb_tree.h"
 #include "frame_alloc.h"
 #include <t3d/t3d.h>
 
@@ -15,19 +16,28 @@ typedef int render_id;
 
 struct render_scene_element {
     void* data;
-    Vector3* center;
-    float radius;
+    render_scene_callback callback;
+    Vector3* center; // NULL for elements that are never culled
+    Vector3 last_center; // center when the tree node was last updated
+    AABB local_bounds; // bounds relative to center
+    struct renderable_matrix_cache* motion; // the bounds are only updated while the cache needs an update, NULL updates them every frame
+    node_proxy node; // node in the culling tree
+    uint16_t index; // index in render_scene.culled_elements
 };
 
 struct render_scene {
-    struct callback_list callbacks;
+    struct callback_list callbacks; // elements without a center, executed every frame
+    AABB_tree culling_tree; // leaves point to the culled elements
+    struct render_scene_element** culled_elements;
+    uint16_t culled_element_count;
+    uint16_t culled_element_capacity;
 };
 
 void render_scene_reset();
 
 void render_scene_add_callback(Vector3* center, float radius, render_scene_callback callback, void* data);
-void render_scene_add_renderable(struct renderable* renderable, float radius);
-void render_scene_add_renderable_single_axis(struct renderable_single_axis* renderable, float radius);
+void render_scene_add_renderable(struct renderable* renderable);
+void render_scene_add_renderable_single_axis(struct renderable_single_axis* renderable);
 void render_scene_remove(void* data);
 void render_scene_render_renderable(void* data, struct render_batch* batch);
 void render_scene_render_renderable_single_axis(void* data, struct render_batch* batch);
@@ -0,0 +1,289 @@
+#include "render_state.h"
+
+#include "render_batch.h"
+#include <string.h>
+
+static inline bool render_state_should_emit(struct render_state* state, bool changed) {
+    if (changed) {
+        ++state->counters.emitted;
+    } else {
+        ++state->counters.skipped;
+    }
+
+    return changed;
+}
+
+void render_state_reset(struct render_state* state) {
+    render_state_invalidate(state);
+    state->counters.emitted = 0;
+    state->counters.skipped = 0;
+    state->counters.tmem_bytes_uploaded = 0;
+}
+
+void render_state_invalidate(struct render_state* state) {
+    state->mode = RENDER_STATE_MODE_UNKNOWN;
+    state->persp = RENDER_STATE_UNKNOWN;
+    state->fog_mode_valid = false;
+    state->t3d_fog_enabled = RENDER_STATE_UNKNOWN;
+    state->z_read = RENDER_STATE_UNKNOWN;
+    state->z_write = RENDER_STATE_UNKNOWN;
+    state->z_override = RENDER_STATE_UNKNOWN;
+    state->tlut = RENDER_STATE_UNKNOWN;
+    state->fog_color_valid = false;
+    state->fog_range_valid = false;
+    state->drawflags_valid = false;
+    state->prim_color_valid = false;
+    render_state_invalidate_tmem(state);
+}
+
+void render_state_invalidate_tmem(struct render_state* state) {
+    for (int tile = 0; tile < RENDER_STATE_TMEM_TILES; ++tile) {
+        state->tmem[tile].sprite = NULL;
+    }
+}
+
+static bool render_state_ranges_overlap(int start_a, int end_a, int start_b, int end_b) {
+    return start_a < end_b && start_b < end_a;
+}
+
+void render_state_invalidate_tmem_range(struct render_state* state, int start, int end) {
+    for (int tile = 0; tile < RENDER_STATE_TMEM_TILES; ++tile) {
+        struct render_state_tmem_slot* slot = &state->tmem[tile];
+
+        if (render_state_ranges_overlap(slot->tmem_start, slot->tmem_end, start, end) ||
+            render_state_ranges_overlap(slot->tlut_start, slot->tlut_end, start, end)) {
+            slot->sprite = NULL;
+        }
+    }
+}
+
+void render_state_invalidate_tlut(struct render_state* state, int color_idx, int color_count) {
+    int start = RENDER_STATE_TLUT_ADDR + color_idx * RENDER_STATE_TLUT_COLOR_SIZE;
+    render_state_invalidate_tmem_range(state, start, start + color_count * RENDER_STATE_TLUT_COLOR_SIZE);
+}
+
+void render_state_invalidate_material(struct render_state* state, enum render_state_mode mode) {
+    // materials may set their own z-buffer, fog, draw flags, prim color and tlut mode, the fog color and range stay untouched
+    state->mode = mode;
+    state->tlut = RENDER_STATE_UNKNOWN;
+    state->fog_mode_valid = false;
+    state->t3d_fog_enabled = RENDER_STATE_UNKNOWN;
+    state->z_read = RENDER_STATE_UNKNOWN;
+    state->z_write = RENDER_STATE_UNKNOWN;
+    state->drawflags_valid = false;
+    state->prim_color_valid = false;
+}
+
+void render_state_set_mode_standard(struct render_state* state) {
+    if (!render_state_should_emit(state, state->mode != RENDER_STATE_MODE_STANDARD)) {
+        return;
+    }
+
+    rdpq_set_mode_standard();
+    state->mode = RENDER_STATE_MODE_STANDARD;
+    state->persp = false;
+    state->fog_mode = 0;
+    state->fog_mode_valid = true;
+    state->z_read = false;
+    state->z_write = false;
+    state->z_override = false;
+    state->tlut = TLUT_NONE;
+}
+
+void render_state_set_mode_model(struct render_state* state) {
+    if (state->mode == RENDER_STATE_MODE_MODEL) {
+        ++state->counters.skipped;
+        return;
+    }
+
+    render_state_set_mode_standard(state);
+}
+
+void render_state_set_persp(struct render_state* state, bool enabled) {
+    if (render_state_should_emit(state, state->persp != enabled)) {
+        rdpq_mode_persp(enabled);
+        state->persp = enabled;
+    }
+}
+
+void render_state_set_zbuf(struct render_state* state, bool read, bool write) {
+    if (render_state_should_emit(state, state->z_read != read || state->z_write != write)) {
+        rdpq_mode_zbuf(read, write);
+        state->z_read = read;
+        state->z_write = write;
+    }
+}
+
+void render_state_set_zoverride(struct render_state* state, bool enabled, float z) {
+    // the depth only matters while the override is enabled
+    bool changed = state->z_override != enabled || (enabled && state->z_override_value != z);
+    if (render_state_should_emit(state, changed)) {
+        rdpq_mode_zoverride(enabled, z, 0);
+        state->z_override = enabled;
+        state->z_override_value = z;
+    }
+}
+
+void render_state_set_drawflags(struct render_state* state, enum T3DDrawFlags flags) {
+    if (render_state_should_emit(state, !state->drawflags_valid || state->drawflags != flags)) {
+        t3d_state_set_drawflags(flags);
+        state->drawflags = flags;
+        state->drawflags_valid = true;
+    }
+}
+
+void render_state_set_prim_color(struct render_state* state, color_t color) {
+    if (render_state_should_emit(state, !state->prim_color_valid || color_to_packed32(state->prim_color) != color_to_packed32(color))) {
+        rdpq_set_prim_color(color);
+        state->prim_color = color;
+        state->prim_color_valid = true;
+    }
+}
+
+static void render_state_set_tlut(struct render_state* state, rdpq_tlut_t tlut) {
+    if (render_state_should_emit(state, state->tlut != (int8_t)tlut)) {
+        rdpq_mode_tlut(tlut);
+        state->tlut = tlut;
+    }
+}
+
+static bool render_state_is_resident(struct render_state* state, rdpq_tile_t tile, struct material_tex* tex) {
+    struct render_state_tmem_slot* slot = &state->tmem[tile];
+
+    if (slot->scrolled && !tex->scroll_x && !tex->scroll_y) {
+        return false;
+    }
+
+    return slot->sprite == tex->sprite && memcmp(&slot->params, &tex->params, sizeof(rdpq_texparms_t)) == 0;
+}
+
+/// @brief Uploads the sprite of a material texture and records the tmem it occupies
+/// @param state
+/// @param tile
+/// @param tex
+/// @param tmem_addr where the texels end up, rdpq places the textures of a multi upload one after another
+/// @return the number of bytes the texels take in tmem
+static int render_state_upload_sprite(struct render_state* state, rdpq_tile_t tile, struct material_tex* tex, int tmem_addr) {
+    int tmem_bytes = rdpq_sprite_upload(tile, tex->sprite, &tex->params);
+
+    // the upload also loads the palette of the sprite, ci4 sprites use one of the 16 color palettes
+    int tlut_start = 0;
+    int tlut_end = 0;
+    tex_format_t format = sprite_get_format(tex->sprite);
+
+    if (sprite_get_palette(tex->sprite) && (format == FMT_CI4 || format == FMT_CI8)) {
+        int color_idx = format == FMT_CI4 ? tex->params.palette * 16 : 0;
+        int color_count = format == FMT_CI4 ? 16 : 256;
+        tlut_start = RENDER_STATE_TLUT_ADDR + color_idx * RENDER_STATE_TLUT_COLOR_SIZE;
+        tlut_end = tlut_start + color_count * RENDER_STATE_TLUT_COLOR_SIZE;
+    }
+
+    render_state_invalidate_tmem_range(state, tmem_addr, tmem_addr + tmem_bytes);
+    if (tlut_end > tlut_start) {
+        render_state_invalidate_tmem_range(state, tlut_start, tlut_end);
+    }
+
+    struct render_state_tmem_slot* slot = &state->tmem[tile];
+    slot->sprite = tex->sprite;
+    slot->params = tex->params;
+    slot->tmem_start = tmem_addr;
+    slot->tmem_end = tmem_addr + tmem_bytes;
+    slot->tlut_start = tlut_start;
+    slot->tlut_end = tlut_end;
+    slot->scrolled = false;
+    // the upload also switches the tlut mode to the format of the sprite
+    state->tlut = rdpq_tlut_from_format(sprite_get_format(tex->sprite));
+    state->counters.tmem_bytes_uploaded += TEX_FORMAT_PIX2BYTES(format, tex->sprite->width * tex->sprite->height);
+
+    return tmem_bytes;
+}
+
+void render_state_upload_textures(struct render_state* state, struct material_tex* tex0, struct material_tex* tex1) {
+    bool tex0_resident = !tex0->sprite || render_state_is_resident(state, TILE0, tex0);
+    bool tex1_resident = !tex1->sprite || render_state_is_resident(state, TILE1, tex1);
+
+    if (render_state_should_emit(state, !tex0_resident || !tex1_resident)) {
+        // the same check material_load used to do when the uploads were part of the material block
+        bool auto_layout = tex1->sprite && tex1->params.tmem_addr == 0;
+
+        if (auto_layout) {
+            rdpq_tex_multi_begin();
+        }
+
+        int multi_addr = 0;
+
+        if (tex0->sprite && (auto_layout || !tex0_resident)) {
+            multi_addr += render_state_upload_sprite(state, TILE0, tex0, auto_layout ? multi_addr : tex0->params.tmem_addr);
+        }
+        if (tex1->sprite && (auto_layout || !tex1_resident)) {
+            render_state_upload_sprite(state, TILE1, tex1, auto_layout ? multi_addr : tex1->params.tmem_addr);
+        }
+
+        if (auto_layout) {
+            rdpq_tex_multi_end();
+        }
+    }
+
+    // the sprite uploaded last decides the tlut mode, a mode reset since then turns it off even if the textures are resident
+    sprite_t* last_sprite = tex1->sprite ? tex1->sprite : tex0->sprite;
+    if (last_sprite) {
+        render_state_set_tlut(state, rdpq_tlut_from_format(sprite_get_format(last_sprite)));
+    }
+}
+
+void render_state_set_tile_scrolled(struct render_state* state, rdpq_tile_t tile) {
+    if (tile < RENDER_STATE_TMEM_TILES) {
+        state->tmem[tile].scrolled = true;
+    }
+}
+
+void render_state_upload_sub(struct render_state* state, rdpq_tile_t tile, surface_t* surface, int s0, int t0, int s1, int t1) {
+    int tmem_bytes = rdpq_tex_upload_sub(tile, surface, NULL, s0, t0, s1, t1);
+
+    render_state_invalidate_tmem_range(state, 0, tmem_bytes);
+    if (tile < RENDER_STATE_TMEM_TILES) {
+        state->tmem[tile].sprite = NULL;
+    }
+    state->counters.tmem_bytes_uploaded += TEX_FORMAT_PIX2BYTES(surface_get_format(surface), (s1 - s0) * (t1 - t0));
+}
+
+static void render_state_set_fog_mode(struct render_state* state, rdpq_blender_t mode) {
+    if (render_state_should_emit(state, !state->fog_mode_valid || state->fog_mode != mode)) {
+        rdpq_mode_fog(mode);
+        state->fog_mode = mode;
+        state->fog_mode_valid = true;
+    }
+}
+
+static void render_state_set_t3d_fog_enabled(struct render_state* state, bool enabled) {
+    if (render_state_should_emit(state, state->t3d_fog_enabled != enabled)) {
+        t3d_fog_set_enabled(enabled);
+        state->t3d_fog_enabled = enabled;
+    }
+}
+
+void render_state_set_fog(struct render_state* state, const struct render_fog_params* fog) {
+    if (!fog || !fog->enabled) {
+        render_state_set_t3d_fog_enabled(state, false);
+        return;
+    }
+
+    render_state_set_fog_mode(state, RDPQ_FOG_STANDARD);
+
+    bool color_changed = !state->fog_color_valid || color_to_packed32(state->fog_color) != color_to_packed32(fog->color);
+    if (render_state_should_emit(state, color_changed)) {
+        rdpq_set_fog_color(fog->color);
+        state->fog_color = fog->color;
+        state->fog_color_valid = true;
+    }
+
+    render_state_set_t3d_fog_enabled(state, true);
+
+    bool range_changed = !state->fog_range_valid || state->fog_start != fog->start || state->fog_end != fog->end;
+    if (render_state_should_emit(state, range_changed)) {
+        t3d_fog_set_range(fog->start, fog->end);
+        state->fog_start = fog->start;
+        state->fog_end = fog->end;
+        state->fog_range_valid = true;
+    }
+}
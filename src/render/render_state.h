@@ -0,0 +1,144 @@
+#ifndef __RENDER_RENDER_STATE_H__
+#define __RENDER_RENDER_STATE_H__
+
+#include <libdragon.h>
+#include <t3d/t3d.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "material.h"
+
+struct render_fog_params;
+
+// the base render mode the rdp was last left in
+enum render_state_mode {
+    RENDER_STATE_MODE_UNKNOWN, // after custom callbacks and rspq blocks that may change anything
+    RENDER_STATE_MODE_STANDARD, // right after rdpq_set_mode_standard
+    RENDER_STATE_MODE_MODEL, // after a t3d model block, its materials set combiner, blender and alpha compare
+};
+
+#define RENDER_STATE_UNKNOWN -1 // value of a tri-state field that is not known
+
+#define RENDER_STATE_TMEM_TILES 2 // material textures are uploaded to TILE0 and TILE1
+#define RENDER_STATE_TLUT_ADDR 0x800 // palettes are loaded into the upper half of tmem
+#define RENDER_STATE_TLUT_COLOR_SIZE 8 // bytes of tmem a palette color takes
+
+// number of state commands that were sent to the rdp/rsp and that were skipped as redundant
+struct render_state_counters {
+    uint16_t emitted;
+    uint16_t skipped;
+    uint32_t tmem_bytes_uploaded; // bytes loaded into tmem by the uploads the tracker knows about
+};
+
+// the texture last uploaded for a tile, the tile descriptor and tmem contents match it as long as sprite is set
+// any upload that overlaps the texels or the palette of the slot clears it
+struct render_state_tmem_slot {
+    sprite_t* sprite; // NULL if unknown
+    rdpq_texparms_t params;
+    uint16_t tmem_start; // tmem bytes the texels were loaded to
+    uint16_t tmem_end;
+    uint16_t tlut_start; // tmem bytes the palette of the sprite was loaded to, empty if the sprite has none
+    uint16_t tlut_end;
+    bool scrolled; // the tile size was moved after the upload, only textures that scroll themselves can reuse the tile
+};
+
+/// @brief Shadow of the render state set while executing a render batch.
+///
+/// Every setter compares against the shadow and only emits the command if the value changes.
+/// Blocks that change state the tracker can't see have to invalidate the affected fields.
+struct render_state {
+    uint8_t mode; // enum render_state_mode
+    int8_t persp;
+    int8_t t3d_fog_enabled;
+    int8_t z_read;
+    int8_t z_write;
+    int8_t z_override;
+    int8_t tlut; // rdpq_tlut_t
+    bool fog_mode_valid;
+    bool fog_color_valid;
+    bool fog_range_valid;
+    bool drawflags_valid;
+    bool prim_color_valid;
+    float z_override_value;
+    rdpq_blender_t fog_mode; // RDPQ_FOG_STANDARD or 0
+    color_t fog_color;
+    float fog_start;
+    float fog_end;
+    enum T3DDrawFlags drawflags;
+    color_t prim_color;
+    struct render_state_tmem_slot tmem[RENDER_STATE_TMEM_TILES];
+    struct render_state_counters counters;
+};
+
+/// @brief Marks all state as unknown and clears the counters, call before the first command of a frame
+/// @param state
+void render_state_reset(struct render_state* state);
+
+/// @brief Marks all state as unknown, used after callbacks that may set any state
+/// @param state
+void render_state_invalidate(struct render_state* state);
+
+/// @brief Marks the contents of tmem as unknown, needed after anything that uploads textures without the tracker such as t3d models and blits
+/// @param state
+void render_state_invalidate_tmem(struct render_state* state);
+
+/// @brief Marks the textures that overlap a part of tmem as unknown, needed after uploads the tracker did not make itself
+/// @param state
+/// @param start first byte of tmem that was written
+/// @param end the byte after the last one that was written
+void render_state_invalidate_tmem_range(struct render_state* state, int start, int end);
+
+/// @brief Marks the textures whose palette overlaps colors of the tlut as unknown, needed after material blocks that upload a palette
+/// @param state
+/// @param color_idx the first color that was written
+/// @param color_count
+void render_state_invalidate_tlut(struct render_state* state, int color_idx, int color_count);
+
+/// @brief Marks the state that t3d model and material blocks set themselves as unknown
+/// @param state
+/// @param mode the base render mode the block leaves behind
+void render_state_invalidate_material(struct render_state* state, enum render_state_mode mode);
+
+/// @brief Resets the rdp to the standard mode, the mode also resets perspective correction, fog and the z-buffer settings
+/// @param state
+void render_state_set_mode_standard(struct render_state* state);
+
+/// @brief Makes sure the rdp mode is either standard or a mode left by a t3d model, models set their material modes themselves
+/// @param state
+void render_state_set_mode_model(struct render_state* state);
+
+void render_state_set_persp(struct render_state* state, bool enabled);
+void render_state_set_zbuf(struct render_state* state, bool read, bool write);
+void render_state_set_zoverride(struct render_state* state, bool enabled, float z);
+void render_state_set_drawflags(struct render_state* state, enum T3DDrawFlags flags);
+void render_state_set_prim_color(struct render_state* state, color_t color);
+
+/// @brief Uploads the textures of a material to TILE0 and TILE1, unless the same sprites were the last ones uploaded to those tiles.
+/// Textures with an automatic tmem layout are placed next to each other, so they are only skipped if both are resident.
+/// The tlut mode an upload sets is restored when the upload is skipped, a mode reset since the upload clears it
+/// @param state
+/// @param tex0
+/// @param tex1
+void render_state_upload_textures(struct render_state* state, struct material_tex* tex0, struct material_tex* tex1);
+
+/// @brief Notes that the tile size of a resident texture was changed to scroll it
+/// @param state
+/// @param tile
+void render_state_set_tile_scrolled(struct render_state* state, rdpq_tile_t tile);
+
+/// @brief Uploads part of a surface to a tile at tmem address 0, the tile is not resident afterwards since only part of the texture is in tmem.
+/// Textures of other tiles the upload overlaps are not resident either
+/// @param state
+/// @param tile
+/// @param surface
+/// @param s0
+/// @param t0
+/// @param s1
+/// @param t1
+void render_state_upload_sub(struct render_state* state, rdpq_tile_t tile, surface_t* surface, int s0, int t0, int s1, int t1);
+
+/// @brief Sets up the rdp fog mode and color and the t3d fog, disables t3d fog if fog is NULL or disabled
+/// @param state
+/// @param fog
+void render_state_set_fog(struct render_state* state, const struct render_fog_params* fog);
+
+#endif
@@ -1,12 +1,105 @@
 #include "renderable.h"
 
+#include <t3d/t3d.h>
+#include <stdio.h>
+#include <string.h>
+#include "defs.h"
+#include "../math/mathf.h"
+#include "../resource/sprite_cache.h"
+#include "../resource/material_cache.h"
+
+static void renderable_matrix_cache_init(struct renderable_matrix_cache* cache) {
+    cache->matrices = malloc_uncached(sizeof(T3DMat4FP) * FRAMEBUFFER_COUNT);
+    cache->physics = NULL;
+    cache->current = 0;
+    cache->dirty = true;
+    cache->physics_awake = false;
+}
+
+static void renderable_matrix_cache_destroy(struct renderable_matrix_cache* cache) {
+    free_uncached(cache->matrices);
+    cache->matrices = NULL;
+}
+
+/// @brief Writes a new matrix into the slot that was used the longest time ago and makes it the current one
+/// @param cache
+/// @param mtx the floating point matrix of the transform
+/// @return the new current matrix
+static T3DMat4FP* renderable_matrix_cache_update(struct renderable_matrix_cache* cache, Matrix4x4* mtx) {
+    cache->current = (cache->current + 1) % FRAMEBUFFER_COUNT;
+    cache->dirty = false;
+
+    T3DMat4FP* result = &cache->matrices[cache->current];
+    t3d_mat4_to_fixed_3x4(result, (T3DMat4*)mtx->m);
+    return result;
+}
+
+/// @brief Loads the decimated models next to the model, name.t3dm has the levels name.lod1.t3dm and name.lod2.t3dm.
+/// The levels are optional (see LOD_MODELS in the Makefile), the first missing level ends the chain
+/// @param renderable
+/// @param model_filename
+static void renderable_load_lods(struct renderable* renderable, const char* model_filename) {
+    renderable->lods[0] = renderable->model;
+    renderable->lod_count = 1;
+    renderable->lod = 0;
+
+    // skinned models would need a skeleton per level
+    if (renderable->model->has_skeleton) {
+        return;
+    }
+
+    const char* extension = strrchr(model_filename, '.');
+    int base_length = extension ? extension - model_filename : strlen(model_filename);
+    char lod_filename[base_length + sizeof(".lod0.t3dm")];
+
+    for (int lod = 1; lod < RENDERABLE_MAX_LODS; ++lod) {
+        sprintf(lod_filename, "%.*s.lod%d.t3dm", base_length, model_filename, lod);
+
+        FILE* file = fopen(lod_filename, "rb");
+        if (!file) {
+            break;
+        }
+        fclose(file);
+
+        // shared through the model cache like the full detail model
+        renderable->lods[lod] = model_cache_load(lod_filename);
+        renderable->lod_count = lod + 1;
+    }
+}
+
+/// @brief Loads the views of the model baked by tools/mesh_export/impostor_export.py, name.t3dm has them in name.impostor.sprite
+/// @param renderable
+/// @param model_filename
+static void renderable_load_impostor(struct renderable* renderable, const char* model_filename) {
+    renderable->impostor = NULL;
+    renderable->impostor_material = NULL;
+    renderable->impostor_distance = RENDERABLE_IMPOSTOR_DISTANCE;
+
+    const char* extension = strrchr(model_filename, '.');
+    int base_length = extension ? extension - model_filename : strlen(model_filename);
+    char impostor_filename[base_length + sizeof(".impostor.sprite")];
+    sprintf(impostor_filename, "%.*s.impostor.sprite", base_length, model_filename);
+
+    FILE* file = fopen(impostor_filename, "rb");
+    if (!file) {
+        return;
+    }
+    fclose(file);
+
+    renderable->impostor = sprite_cache_load(impostor_filename);
+    renderable->impostor_material = material_cache_load(RENDERABLE_IMPOSTOR_MATERIAL);
+}
+
 /// @brief initializes a renderable object with a given transform and T3D model path
 /// @param renderable pointer to the renderable
 /// @param transform pointer to the transform
-/// @param model_filename path string to the model in the rom file system
+/// @param model_filename path string to the model in the rom file system, decimated levels of detail next to it are loaded as well
 void renderable_init(struct renderable* renderable, Transform* transform, const char* model_filename) {
     renderable->transform = transform;
     renderable->model = model_cache_load(model_filename);
+    renderable_load_lods(renderable, model_filename);
+    renderable_load_impostor(renderable, model_filename);
+    renderable_matrix_cache_init(&renderable->_matrix_cache);
 }
 
 /// @brief free the memory of a renderable object.
@@ -14,13 +107,86 @@ void renderable_init(struct renderable* renderable, Transform* transform, const
 /// @param renderable 
 void renderable_destroy(struct renderable* renderable) {
     if(!renderable->model) return;
+    for (int lod = 1; lod < renderable->lod_count; ++lod) {
+        model_cache_release(renderable->lods[lod]);
+        renderable->lods[lod] = NULL;
+    }
+    renderable->lod_count = 0;
+    if (renderable->impostor) {
+        sprite_cache_release(renderable->impostor);
+        material_cache_release(renderable->impostor_material);
+        renderable->impostor = NULL;
+        renderable->impostor_material = NULL;
+    }
     model_cache_release(renderable->model);
     renderable->model = NULL;
+    renderable_matrix_cache_destroy(&renderable->_matrix_cache);
+}
+
+struct model* renderable_select_lod(struct renderable* renderable, float distance) {
+    if (renderable->lod_count < 2) {
+        return renderable->model;
+    }
+
+    static const float screen_sizes[RENDERABLE_MAX_LODS] = RENDERABLE_LOD_SCREEN_SIZES;
+
+    // compares radius / distance against the thresholds without dividing
+    float radius = model_bounding_radius(renderable->model, &renderable->transform->scale);
+    int lod = renderable->lod;
+
+    while (lod + 1 < renderable->lod_count && radius < screen_sizes[lod + 1] * distance) {
+        ++lod;
+    }
+
+    while (lod > 0 && radius > screen_sizes[lod] * RENDERABLE_LOD_HYSTERESIS * distance) {
+        --lod;
+    }
+
+    renderable->lod = lod;
+    return renderable->lods[lod];
+}
+
+int renderable_impostor_frame(struct renderable* renderable, Vector3* camera_position) {
+    int frame_count = renderable->impostor->width / renderable->impostor->height;
+
+    // the direction to the camera in model space, frame 0 was baked looking down the -z axis
+    Vector3 offset;
+    vector3Sub(camera_position, &renderable->transform->position, &offset);
+    Quaternion inverse_rotation;
+    quatConjugate(&renderable->transform->rotation, &inverse_rotation);
+    quatMultVector(&inverse_rotation, &offset, &offset);
+
+    float angle = atan2f(offset.x, offset.z);
+    int frame = (int)floorf(angle * (frame_count / TWO_PI) + 0.5f);
+
+    return (frame + frame_count) % frame_count;
+}
+
+void renderable_mark_dirty(struct renderable* renderable) {
+    renderable->_matrix_cache.dirty = true;
+}
+
+void renderable_set_physics(struct renderable* renderable, physics_object* physics) {
+    renderable->_matrix_cache.physics = physics;
+    renderable->_matrix_cache.dirty = true;
+}
+
+T3DMat4FP* renderable_get_matrix(struct renderable* renderable) {
+    struct renderable_matrix_cache* cache = &renderable->_matrix_cache;
+
+    if (!renderable_matrix_cache_needs_update(cache)) {
+        return &cache->matrices[cache->current];
+    }
+
+    Matrix4x4 mtx;
+    transformToMatrix(renderable->transform, &mtx);
+    return renderable_matrix_cache_update(cache, &mtx);
 }
 
 void renderable_single_axis_init(struct renderable_single_axis* renderable, TransformSingleAxis* transform, const char* model_filename) {
     renderable->transform = transform;
     renderable->model = model_cache_load(model_filename);
+    renderable_matrix_cache_init(&renderable->_matrix_cache);
 }
 
 /// @brief free the memory of a renderable single axis object.
@@ -29,4 +195,26 @@ void renderable_single_axis_init(struct renderable_single_axis* renderable, Tran
 void renderable_single_axis_destroy(struct renderable_single_axis* renderable) {
     model_cache_release(renderable->model);
     renderable->model = NULL;
-}
\ No newline at end of file
+    renderable_matrix_cache_destroy(&renderable->_matrix_cache);
+}
+
+void renderable_single_axis_mark_dirty(struct renderable_single_axis* renderable) {
+    renderable->_matrix_cache.dirty = true;
+}
+
+void renderable_single_axis_set_physics(struct renderable_single_axis* renderable, physics_object* physics) {
+    renderable->_matrix_cache.physics = physics;
+    renderable->_matrix_cache.dirty = true;
+}
+
+T3DMat4FP* renderable_single_axis_get_matrix(struct renderable_single_axis* renderable) {
+    struct renderable_matrix_cache* cache = &renderable->_matrix_cache;
+
+    if (!renderable_matrix_cache_needs_update(cache)) {
+        return &cache->matrices[cache->current];
+    }
+
+    Matrix4x4 mtx;
+    transformSAToMatrix(renderable->transform, mtx.m);
+    return renderable_matrix_cache_update(cache, &mtx);
+}
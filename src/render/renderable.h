@@ -7,21 +7,105 @@
 #include <t3d/t3dskeleton.h>
 #include "../resource/model_cache.h"
 #include "../render/model.h"
+#include "../collision/physics_object.h"
+
+/// @brief Fixed point model matrices that are only recalculated when the transform changed.
+///
+/// The rsp may still read the matrix of a previous frame, so there is one matrix per framebuffer
+/// and an update always writes the one that was used the longest time ago.
+struct renderable_matrix_cache {
+    T3DMat4FP* matrices; // FRAMEBUFFER_COUNT matrices in uncached memory
+    physics_object* physics; // the matrix is recalculated every frame while this object is awake, may be NULL
+    uint8_t current; // index of the up to date matrix
+    bool dirty;
+    bool physics_awake; // the physics object was awake when the motion was last tracked
+};
+
+/// @brief Returns true if the transform may have changed since the cached matrix was calculated
+/// @param cache
+/// @return
+static inline bool renderable_matrix_cache_needs_update(struct renderable_matrix_cache* cache) {
+    return cache->dirty || (cache->physics && !cache->physics->_is_sleeping);
+}
+
+/// @brief Keeps the cache dirty until the next update while the physics object is awake, call once per frame whether the renderable is drawn or not.
+/// The frame after the object fell asleep counts as awake, the steps before it went to sleep may still have moved it
+/// @param cache
+/// @return true if the transform may have changed since the cached matrix was calculated
+static inline bool renderable_matrix_cache_track_motion(struct renderable_matrix_cache* cache) {
+    bool awake = cache->physics && !cache->physics->_is_sleeping;
+
+    if (awake || cache->physics_awake) {
+        cache->dirty = true;
+    }
+
+    cache->physics_awake = awake;
+    return cache->dirty;
+}
+
+#define RENDERABLE_MAX_LODS 3 // the model itself and the decimated name.lod1.t3dm and name.lod2.t3dm
+
+// angular radius of the model (radius / distance) below which a level of detail is used, index 0 is unused
+#define RENDERABLE_LOD_SCREEN_SIZES {0.0f, 0.1f, 0.04f}
+// a finer level is only picked again once the model is this much larger than the threshold, so it does not flicker at the boundary
+#define RENDERABLE_LOD_HYSTERESIS 1.25f
+
+// distance from the camera past which models with baked views are drawn as an impostor billboard
+#define RENDERABLE_IMPOSTOR_DISTANCE 50.0f
+#define RENDERABLE_IMPOSTOR_MATERIAL "rom:/materials/impostor/impostor.mat"
 
 struct renderable {
     Transform* transform; //the transform of the object
-    struct model* model; //the model of the object
+    struct model* model; //the model of the object, always the full detail model
+    struct model* lods[RENDERABLE_MAX_LODS]; // lods[0] is model, coarser models follow
+    uint8_t lod_count;
+    uint8_t lod; // the level of detail that was rendered last
+    sprite_t* impostor; // name.impostor.sprite, views around the up axis baked into one row of square frames. NULL if there is none
+    struct material* impostor_material;
+    float impostor_distance;
+    struct renderable_matrix_cache _matrix_cache;
 };
 
 void renderable_init(struct renderable* renderable, Transform* transform, const char* model_filename);
 void renderable_destroy(struct renderable* renderable);
 
+/// @brief Picks the level of detail from the projected size of the model
+/// @param renderable
+/// @param distance the distance of the model to the camera
+/// @return the model to render
+struct model* renderable_select_lod(struct renderable* renderable, float distance);
+
+/// @brief Returns the frame of the impostor atlas baked closest to the direction the camera looks at the model from
+/// @param renderable
+/// @param camera_position
+/// @return
+int renderable_impostor_frame(struct renderable* renderable, Vector3* camera_position);
+
+/// @brief Recalculate the matrix on the next render, needed after changing the transform outside of the physics simulation
+/// @param renderable
+void renderable_mark_dirty(struct renderable* renderable);
+
+/// @brief Reuse the cached matrix while the physics object sleeps, the physics object has to share the transform
+/// @param renderable
+/// @param physics
+void renderable_set_physics(struct renderable* renderable, physics_object* physics);
+
+/// @brief Returns the fixed point matrix of the transform, only recalculated if the transform changed
+/// @param renderable
+/// @return
+T3DMat4FP* renderable_get_matrix(struct renderable* renderable);
+
 struct renderable_single_axis {
     TransformSingleAxis* transform;
     struct model* model;
+    struct renderable_matrix_cache _matrix_cache;
 };
 
 void renderable_single_axis_init(struct renderable_single_axis* renderable, TransformSingleAxis* transform, const char* model_filename);
 void renderable_single_axis_destroy(struct renderable_single_axis* renderable);
 
+void renderable_single_axis_mark_dirty(struct renderable_single_axis* renderable);
+void renderable_single_axis_set_physics(struct renderable_single_axis* renderable, physics_object* physics);
+T3DMat4FP* renderable_single_axis_get_matrix(struct renderable_single_axis* renderable);
+
 #endif
\ No newline at end of file
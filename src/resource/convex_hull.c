@@ -0,0 +1,55 @@
+#include "convex_hull.h"
+
+#include <malloc.h>
+#include <string.h>
+#include <assert.h>
+#include <libdragon.h>
+
+
+// CHUL
+#define EXPECTED_HEADER 0x4348554C
+
+void convex_hull_load(struct convex_hull* into, const char* filename, float scale) {
+    int header;
+    FILE *file = asset_fopen(filename, NULL);
+    fread(&header, 1, 4, file);
+    assert(header == EXPECTED_HEADER);
+
+    uint16_t vertex_count;
+    uint16_t adjacency_count;
+    fread(&vertex_count, 2, 1, file);
+    fread(&adjacency_count, 2, 1, file);
+    assert(vertex_count > 0 && vertex_count <= HULL_MAX_VERTICES);
+
+    fread(&into->center, sizeof(Vector3), 1, file);
+    fread(&into->unit_inertia, sizeof(Vector3), 1, file);
+
+    into->vertex_count = vertex_count;
+    into->vertices = malloc(sizeof(Vector3) * vertex_count);
+    fread(into->vertices, sizeof(Vector3), vertex_count, file);
+
+    into->adjacency_offsets = malloc(sizeof(uint16_t) * (vertex_count + 1));
+    fread(into->adjacency_offsets, sizeof(uint16_t), vertex_count + 1, file);
+
+    into->adjacency = malloc(adjacency_count);
+    fread(into->adjacency, 1, adjacency_count, file);
+    fclose(file);
+
+    for (int i = 0; i < vertex_count; i++) {
+        vector3Scale(&into->vertices[i], &into->vertices[i], scale);
+    }
+    vector3Scale(&into->center, &into->center, scale);
+    vector3Scale(&into->unit_inertia, &into->unit_inertia, scale * scale);
+
+    memset(into->_support_cache, 0, sizeof(into->_support_cache));
+}
+
+void convex_hull_release(struct convex_hull* hull) {
+    free(hull->vertices);
+    free(hull->adjacency_offsets);
+    free(hull->adjacency);
+    hull->vertices = NULL;
+    hull->adjacency_offsets = NULL;
+    hull->adjacency = NULL;
+    hull->vertex_count = 0;
+}
@@ -0,0 +1,14 @@
+#ifndef __RESOURCE_CONVEX_HULL_H__
+#define __RESOURCE_CONVEX_HULL_H__
+
+#include "../collision/shapes/hull.h"
+#include <stdio.h>
+
+/// @brief Loads a convex hull exported from blender
+/// @param into 
+/// @param filename 
+/// @param scale 
+void convex_hull_load(struct convex_hull* into, const char* filename, float scale);
+void convex_hull_release(struct convex_hull* hull);
+
+#endif
@@ -0,0 +1,45 @@
+#include "heightfield.h"
+
+#include <malloc.h>
+#include <assert.h>
+#include <libdragon.h>
+
+
+// CHFD
+#define EXPECTED_HEADER 0x43484644
+
+bool heightfield_load(struct heightfield* into, const char* filename, float scale) {
+    int header;
+    FILE *file = asset_fopen(filename, NULL);
+    fread(&header, 1, 4, file);
+    assert(header == EXPECTED_HEADER);
+
+    uint16_t cells_x;
+    uint16_t cells_z;
+    fread(&cells_x, 2, 1, file);
+    fread(&cells_z, 2, 1, file);
+
+    Vector3 origin;
+    float cell_size;
+    float height_scale;
+    fread(&origin, sizeof(Vector3), 1, file);
+    fread(&cell_size, sizeof(float), 1, file);
+    fread(&height_scale, sizeof(float), 1, file);
+
+    int sample_count = (cells_x + 1) * (cells_z + 1);
+    int16_t* heights = malloc(sizeof(int16_t) * sample_count);
+    fread(heights, sizeof(int16_t), sample_count, file);
+    fclose(file);
+
+    vector3Scale(&origin, &origin, scale);
+    heightfield_init(into, heights, cells_x, cells_z, &origin, cell_size * scale, height_scale * scale);
+
+    return cells_x > 0 && cells_z > 0;
+}
+
+void heightfield_release(struct heightfield* heightfield) {
+    free(heightfield->heights);
+    heightfield->heights = NULL;
+    heightfield->cells_x = 0;
+    heightfield->cells_z = 0;
+}
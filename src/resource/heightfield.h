@@ -0,0 +1,15 @@
+#ifndef __RESOURCE_HEIGHTFIELD_H__
+#define __RESOURCE_HEIGHTFIELD_H__
+
+#include "../collision/heightfield.h"
+#include <stdio.h>
+
+/// @brief Loads a heightfield exported from blender
+/// @param into 
+/// @param filename 
+/// @param scale 
+/// @return false if the map has no heightfield (the file holds an empty grid)
+bool heightfield_load(struct heightfield* into, const char* filename, float scale);
+void heightfield_release(struct heightfield* heightfield);
+
+#endif
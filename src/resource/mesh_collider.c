@@ -8,9 +8,32 @@
 
 // CMSH
 #define EXPECTED_HEADER 0x434D5348
+// CMSQ, int16 vertices and octahedral normals
+#define EXPECTED_HEADER_COMPACT 0x434D5351
+
+/// @brief Build the BVH and the precomputed triangles of a mesh collider.
+/// The vertex data is only needed while building, the triangles and normals are reordered into BVH leaf order.
+static void mesh_collider_build(struct mesh_collider* into, const Vector3* vertices, struct mesh_triangle_indices* triangles, Vector3* normals, int triangle_count) {
+    into->triangle_count = triangle_count;
+    into->compact_triangles = NULL;
+    into->compact_vertices = NULL;
+    mesh_bvh_build(&into->bvh, vertices, triangles, normals, sizeof(Vector3), triangle_count);
+
+    into->triangles = malloc(sizeof(struct mesh_triangle) * triangle_count);
+    for (int i = 0; i < triangle_count; i++)
+    {
+        struct mesh_triangle_indices* triangle = &triangles[i];
+        mesh_triangle_init(
+            &into->triangles[i],
+            &vertices[triangle->indices[0]],
+            &vertices[triangle->indices[1]],
+            &vertices[triangle->indices[2]],
+            &normals[i]
+        );
+    }
+}
 
 void mesh_collider_load_test(struct mesh_collider* into){
-    int vertex_count = 8;
     int triangle_count = 10;
     Vector3 vertices[] = {
         {{-40.0f, 0.0f, -40.0f}},
@@ -24,9 +47,6 @@ void mesh_collider_load_test(struct mesh_collider* into){
 
     };
 
-    into->vertices = malloc(sizeof(Vector3) * vertex_count);
-    memcpy(into->vertices, vertices, sizeof(Vector3) * vertex_count);
-
     struct mesh_triangle_indices triangles[triangle_count];
     Vector3 normals[triangle_count];
     triangles[0].indices[0] = 0;
@@ -78,46 +98,58 @@ void mesh_collider_load_test(struct mesh_collider* into){
     triangles[9].indices[1] = 4;
     triangles[9].indices[2] = 1;
     normals[9] = (Vector3){{0, 0, 1}};
-    into->triangles = malloc(sizeof(struct mesh_triangle_indices) * triangle_count);
-    memcpy(into->triangles, triangles, sizeof(struct mesh_triangle_indices) * triangle_count);
-
-    into->normals = malloc(sizeof(Vector3) * triangle_count);
-    memcpy(into->normals, normals, sizeof(Vector3) * triangle_count);
-
-    into->triangle_count = triangle_count;
+    mesh_collider_build(into, vertices, triangles, normals, triangle_count);
+}
 
-    AABB_tree_init(&into->aabbtree, (2 * triangle_count) + 1);
-    AABB triangleAABB;
-    for (int i = 0; i < triangle_count; i++)
+void mesh_collider_load_box(struct mesh_collider* into, const Vector3* half_size){
+    // corner i has the positive extent on x for bit 0, y for bit 1 and z for bit 2
+    Vector3 vertices[8];
+    for (int i = 0; i < 8; i++)
     {
-        struct mesh_triangle_indices* triangle = &into->triangles[i];
-        Vector3* v0 = &into->vertices[triangle->indices[0]];
-        Vector3* v1 = &into->vertices[triangle->indices[1]];
-        Vector3* v2 = &into->vertices[triangle->indices[2]];
-
-        triangleAABB = AABBFromTriangle(v0, v1, v2);
+        vertices[i] = (Vector3){{
+            (i & 1) ? half_size->x : -half_size->x,
+            (i & 2) ? half_size->y : -half_size->y,
+            (i & 4) ? half_size->z : -half_size->z,
+        }};
+    }
 
-        AABB_tree_create_node(&into->aabbtree, triangleAABB, (void *)i);
+    struct mesh_triangle_indices triangles[12];
+    Vector3 normals[12];
+    for (int axis = 0; axis < 3; axis++)
+    {
+        int u = 1 << ((axis + 1) % 3);
+        int v = 1 << ((axis + 2) % 3);
+
+        for (int side = 0; side < 2; side++)
+        {
+            int base = side ? (1 << axis) : 0;
+            int face = axis * 2 + side;
+            Vector3 normal = gZeroVec;
+            normal.v[axis] = side ? 1.0f : -1.0f;
+
+            triangles[face * 2] = (struct mesh_triangle_indices){{base, base + u, base + u + v}};
+            triangles[face * 2 + 1] = (struct mesh_triangle_indices){{base, base + u + v, base + v}};
+            normals[face * 2] = normal;
+            normals[face * 2 + 1] = normal;
+        }
     }
-}
 
-void mesh_collider_load(struct mesh_collider* into, const char* filename, float scale, Vector3* offset) {
-    int header;
-    FILE *file = asset_fopen(filename, NULL);
-    fread(&header, 1, 4, file);
-    assert(header == EXPECTED_HEADER);
+    mesh_collider_build(into, vertices, triangles, normals, 12);
+}
 
+/// @brief Loads the float variant, triangles are precomputed
+/// @return the vertex count of the file
+static int mesh_collider_load_float(struct mesh_collider* into, FILE* file, float scale) {
     uint16_t vertex_count;
     fread(&vertex_count, 2, 1, file);
-    into->vertex_count = vertex_count;
 
-    into->vertices = malloc(sizeof(Vector3) * vertex_count);
-    fread(into->vertices, sizeof(Vector3), vertex_count, file);
+    Vector3* vertices = malloc(sizeof(Vector3) * vertex_count);
+    fread(vertices, sizeof(Vector3), vertex_count, file);
 
     for (int i = 0; i < vertex_count; i++)
     {
 
-        Vector3* vert = &into->vertices[i];
+        Vector3* vert = &vertices[i];
 
         vert->x *= scale;
         vert->y *= scale;
@@ -126,34 +158,101 @@ void mesh_collider_load(struct mesh_collider* into, const char* filename, float
 
     uint16_t triangle_count;
     fread(&triangle_count, 2, 1, file);
-    into->triangle_count = triangle_count;
 
-    into->triangles = malloc(sizeof(struct mesh_triangle_indices) * triangle_count);
-    fread(into->triangles, sizeof(struct mesh_triangle_indices), triangle_count, file);
+    struct mesh_triangle_indices* triangles = malloc(sizeof(struct mesh_triangle_indices) * triangle_count);
+    fread(triangles, sizeof(struct mesh_triangle_indices), triangle_count, file);
 
-    into->normals = malloc(sizeof(Vector3) * triangle_count);
-    fread(into->normals, sizeof(Vector3), triangle_count, file);
-    fclose(file);
+    Vector3* normals = malloc(sizeof(Vector3) * triangle_count);
+    fread(normals, sizeof(Vector3), triangle_count, file);
+    // the optional CADJ adjacency section written by the exporter follows here and is not needed at runtime
 
-    AABB_tree_init(&into->aabbtree, (2 * triangle_count) + 1);
-    AABB triangleAABB;
-    for (int i = 0; i < triangle_count; i++)
-    {
+    mesh_collider_build(into, vertices, triangles, normals, triangle_count);
 
-        struct mesh_triangle_indices* triangle = &into->triangles[i];
-        
-        Vector3* v0 = &into->vertices[triangle->indices[0]];
-        Vector3* v1 = &into->vertices[triangle->indices[1]];
-        Vector3* v2 = &into->vertices[triangle->indices[2]];
+    free(vertices);
+    free(triangles);
+    free(normals);
 
-        triangleAABB = AABBFromTriangle(v0, v1, v2);
+    return vertex_count;
+}
+
+/// @brief Loads the compact variant, the quantized vertices are kept and triangles are decoded on demand
+/// @return the vertex count of the file
+static int mesh_collider_load_compact(struct mesh_collider* into, FILE* file, float scale) {
+    Vector3 origin;
+    Vector3 quantized_scale;
+    fread(&origin, sizeof(Vector3), 1, file);
+    fread(&quantized_scale, sizeof(Vector3), 1, file);
+    vector3Scale(&origin, &into->compact_origin, scale);
+    vector3Scale(&quantized_scale, &into->compact_scale, scale);
+
+    uint16_t vertex_count;
+    fread(&vertex_count, 2, 1, file);
+
+    into->compact_vertices = malloc(sizeof(struct mesh_compact_vertex) * vertex_count);
+    fread(into->compact_vertices, sizeof(struct mesh_compact_vertex), vertex_count, file);
+
+    uint16_t triangle_count;
+    fread(&triangle_count, 2, 1, file);
+
+    struct mesh_triangle_indices* triangles = malloc(sizeof(struct mesh_triangle_indices) * triangle_count);
+    fread(triangles, sizeof(struct mesh_triangle_indices), triangle_count, file);
+
+    uint16_t* encoded_normals = malloc(sizeof(uint16_t) * triangle_count);
+    fread(encoded_normals, sizeof(uint16_t), triangle_count, file);
+
+    // the BVH is built from the decoded data so its bounds match the triangles used at runtime
+    Vector3* vertices = malloc(sizeof(Vector3) * vertex_count);
+    for (int i = 0; i < vertex_count; i++) {
+        mesh_collider_decode_vertex(into, i, &vertices[i]);
+    }
 
-        AABB_tree_create_node(&into->aabbtree, triangleAABB, (void *)i);
+    // the encoded normals are moved along with the triangles, so they stay exactly as exported
+    into->triangle_count = triangle_count;
+    into->triangles = NULL;
+    mesh_bvh_build(&into->bvh, vertices, triangles, encoded_normals, sizeof(uint16_t), triangle_count);
+
+    into->compact_triangles = malloc(sizeof(struct mesh_compact_triangle) * triangle_count);
+    for (int i = 0; i < triangle_count; i++) {
+        struct mesh_compact_triangle* triangle = &into->compact_triangles[i];
+        memcpy(triangle->indices, triangles[i].indices, sizeof(triangle->indices));
+        triangle->normal = encoded_normals[i];
     }
+
+    free(vertices);
+    free(triangles);
+    free(encoded_normals);
+
+    return vertex_count;
+}
+
+void mesh_collider_load(struct mesh_collider* into, const char* filename, float scale, Vector3* offset) {
+    int header;
+    FILE *file = asset_fopen(filename, NULL);
+    fread(&header, 1, 4, file);
+    assert(header == EXPECTED_HEADER || header == EXPECTED_HEADER_COMPACT);
+
+    int vertex_count;
+    int triangle_bytes;
+    if (header == EXPECTED_HEADER_COMPACT) {
+        vertex_count = mesh_collider_load_compact(into, file, scale);
+        triangle_bytes = into->triangle_count * sizeof(struct mesh_compact_triangle) + vertex_count * sizeof(struct mesh_compact_vertex);
+    } else {
+        vertex_count = mesh_collider_load_float(into, file, scale);
+        triangle_bytes = into->triangle_count * sizeof(struct mesh_triangle);
+    }
+
+    fclose(file);
+
+    // the indexed layout kept the vertices and the indices and normal of every triangle
+    int indexed_bytes = vertex_count * sizeof(Vector3) + into->triangle_count * (sizeof(struct mesh_triangle_indices) + sizeof(Vector3));
+    debugf("%s: %d triangles, %d vertices, %d bytes of triangle data (%d bytes indexed)\n",
+        filename, into->triangle_count, vertex_count, triangle_bytes, indexed_bytes);
 }
 
 void mesh_collider_release(struct mesh_collider* mesh){
-    free(mesh->vertices);
     free(mesh->triangles);
-    AABB_tree_free(&mesh->aabbtree);
+    free(mesh->compact_triangles);
+    free(mesh->compact_vertices);
+    mesh_collider_clear_decode_cache(mesh);
+    mesh_bvh_free(&mesh->bvh);
 }
\ No newline at end of file
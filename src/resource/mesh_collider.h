@@ -5,6 +5,10 @@
 #include <stdio.h>
 
 void mesh_collider_load_test(struct mesh_collider* into);
+/// @brief Builds a closed box mesh centered on the origin, for props that are placed as mesh instances
+/// @param into
+/// @param half_size
+void mesh_collider_load_box(struct mesh_collider* into, const Vector3* half_size);
 void mesh_collider_load(struct mesh_collider* into, const char* filename, float scale, Vector3* offset);
 void mesh_collider_release(struct mesh_collider* mesh);
 
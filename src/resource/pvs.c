@@ -0,0 +1,65 @@
+#include "pvs.h"
+
+#include <malloc.h>
+#include <string.h>
+#include <assert.h>
+#include <libdragon.h>
+
+
+// CPVS
+#define EXPECTED_HEADER 0x43505653
+
+bool pvs_load(struct pvs* into, const char* filename, float scale) {
+    int header;
+    FILE *file = asset_fopen(filename, NULL);
+    fread(&header, 1, 4, file);
+    assert(header == EXPECTED_HEADER);
+
+    uint16_t row_count;
+    fread(&into->chunk_count, 2, 1, file);
+    fread(&into->cells_x, 2, 1, file);
+    fread(&into->cells_y, 2, 1, file);
+    fread(&into->cells_z, 2, 1, file);
+    fread(&row_count, 2, 1, file);
+
+    fread(&into->origin, sizeof(Vector3), 1, file);
+    fread(&into->cell_size, sizeof(float), 1, file);
+
+    into->chunk_names = malloc(sizeof(char*) * into->chunk_count);
+
+    for (int i = 0; i < into->chunk_count; i++) {
+        uint8_t length;
+        char name[256];
+        fread(&length, 1, 1, file);
+        fread(name, 1, length, file);
+        name[length] = '\0';
+        into->chunk_names[i] = strdup(name);
+    }
+
+    int cell_count = into->cells_x * into->cells_y * into->cells_z;
+    into->cell_rows = malloc(sizeof(uint16_t) * cell_count);
+    fread(into->cell_rows, sizeof(uint16_t), cell_count, file);
+
+    into->row_size = (into->chunk_count + 7) >> 3;
+    into->rows = malloc(into->row_size * row_count);
+    fread(into->rows, into->row_size, row_count, file);
+    fclose(file);
+
+    vector3Scale(&into->origin, &into->origin, scale);
+    into->cell_size *= scale;
+
+    return into->chunk_count > 0;
+}
+
+void pvs_release(struct pvs* pvs) {
+    for (int i = 0; i < pvs->chunk_count; i++) {
+        free(pvs->chunk_names[i]);
+    }
+    free(pvs->chunk_names);
+    free(pvs->cell_rows);
+    free(pvs->rows);
+    pvs->chunk_names = NULL;
+    pvs->cell_rows = NULL;
+    pvs->rows = NULL;
+    pvs->chunk_count = 0;
+}
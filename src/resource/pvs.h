@@ -0,0 +1,15 @@
+#ifndef __RESOURCE_PVS_H__
+#define __RESOURCE_PVS_H__
+
+#include "../render/pvs.h"
+#include <stdio.h>
+
+/// @brief Loads a potentially visible set baked from blender
+/// @param into 
+/// @param filename 
+/// @param scale 
+/// @return false if the map has no chunks (the file holds an empty grid)
+bool pvs_load(struct pvs* into, const char* filename, float scale);
+void pvs_release(struct pvs* pvs);
+
+#endif
@@ -37,4 +37,116 @@ void sort_array_recurse(uint16_t* array, uint16_t* tmp, int start, int end, void
 void sort_indices(uint16_t* array, int element_count, void* data, sort_compare compare) {
     uint16_t tmp[element_count];
     sort_array_recurse(array, tmp, 0, element_count, data, compare);
-}
\ No newline at end of file
+}
+
+#define RADIX_BITS      8
+#define RADIX_BUCKETS   (1 << RADIX_BITS)
+
+void sort_indices_radix(uint16_t* array, int element_count, const uint64_t* keys) {
+    if (element_count < 2) {
+        return;
+    }
+
+    uint16_t tmp[element_count];
+    uint16_t* from = array;
+    uint16_t* to = tmp;
+
+    for (int shift = 0; shift < 64; shift += RADIX_BITS) {
+        uint16_t offsets[RADIX_BUCKETS] = {0};
+
+        for (int i = 0; i < element_count; ++i) {
+            ++offsets[(keys[from[i]] >> shift) & (RADIX_BUCKETS - 1)];
+        }
+
+        // all keys have the same byte, the order doesn't change
+        if (offsets[(keys[from[0]] >> shift) & (RADIX_BUCKETS - 1)] == element_count) {
+            continue;
+        }
+
+        int start = 0;
+        for (int bucket = 0; bucket < RADIX_BUCKETS; ++bucket) {
+            int count = offsets[bucket];
+            offsets[bucket] = start;
+            start += count;
+        }
+
+        for (int i = 0; i < element_count; ++i) {
+            uint16_t index = from[i];
+            to[offsets[(keys[index] >> shift) & (RADIX_BUCKETS - 1)]++] = index;
+        }
+
+        uint16_t* swap = from;
+        from = to;
+        to = swap;
+    }
+
+    if (from != array) {
+        for (int i = 0; i < element_count; ++i) {
+            array[i] = from[i];
+        }
+    }
+}
+
+// below this count the bucket setup of a radix pass costs more than comparing the keys
+#define INSERTION_SORT_MAX  32
+
+void sort_indices_radix32(uint16_t* array, int element_count, const uint32_t* keys) {
+    if (element_count < 2) {
+        return;
+    }
+
+    if (element_count <= INSERTION_SORT_MAX) {
+        for (int i = 1; i < element_count; ++i) {
+            uint16_t index = array[i];
+            uint32_t key = keys[index];
+            int j = i;
+
+            while (j > 0 && keys[array[j - 1]] > key) {
+                array[j] = array[j - 1];
+                --j;
+            }
+
+            array[j] = index;
+        }
+        return;
+    }
+
+    uint16_t tmp[element_count];
+    uint16_t* from = array;
+    uint16_t* to = tmp;
+
+    for (int shift = 0; shift < 32; shift += RADIX_BITS) {
+        uint16_t offsets[RADIX_BUCKETS] = {0};
+
+        for (int i = 0; i < element_count; ++i) {
+            ++offsets[(keys[from[i]] >> shift) & (RADIX_BUCKETS - 1)];
+        }
+
+        // all keys have the same byte, the order doesn't change
+        if (offsets[(keys[from[0]] >> shift) & (RADIX_BUCKETS - 1)] == element_count) {
+            continue;
+        }
+
+        int start = 0;
+        for (int bucket = 0; bucket < RADIX_BUCKETS; ++bucket) {
+            int count = offsets[bucket];
+            offsets[bucket] = start;
+            start += count;
+        }
+
+        for (int i = 0; i < element_count; ++i) {
+            uint16_t index = from[i];
+            to[offsets[(keys[index] >> shift) & (RADIX_BUCKETS - 1)]++] = index;
+        }
+
+        uint16_t* swap = from;
+        from = to;
+        to = swap;
+    }
+
+    if (from != array) {
+        for (int i = 0; i < element_count; ++i) {
+            array[i] = from[i];
+        }
+    }
+}
@@ -7,4 +7,20 @@ typedef int (*sort_compare)(void* data, uint16_t a, uint16_t b);
 
 void sort_indices(uint16_t* array, int element_count, void* data, sort_compare compare);
 
+/// @brief Stable LSD radix sort of indices by 64 bit keys, a byte at a time.
+///
+/// Passes where all keys share the same byte are skipped.
+/// @param array the indices to sort, each one indexes keys
+/// @param element_count
+/// @param keys
+void sort_indices_radix(uint16_t* array, int element_count, const uint64_t* keys);
+
+/// @brief Stable sort of indices by 32 bit keys.
+///
+/// Small arrays are sorted by insertion, larger ones with the same radix sort as sort_indices_radix.
+/// @param array the indices to sort, each one indexes keys
+/// @param element_count
+/// @param keys
+void sort_indices_radix32(uint16_t* array, int element_count, const uint32_t* keys);
+
 #endif
\ No newline at end of file
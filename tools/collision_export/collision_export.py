@@ -2,76 +2,452 @@ import bpy
 import struct
 import sys
 
-def write_collision_data(output_path, base_scale):
-    # Ensure the collection exists
-    collection = bpy.data.collections.get("collision")
-    if not collection:
-        print("Collection 'collision' not found.")
-        return
-    
+# Mesh optimization settings (in exported units, after base_scale)
+WELD_DISTANCE = 0.001 # vertices closer than this are merged
+SLIVER_MIN_ALTITUDE = 0.001 # triangles thinner than this are removed
+COPLANAR_MIN_NORMAL_DOT = 0.9999 # neighbors with a more similar normal are merged
+COPLANAR_MAX_DISTANCE = 0.001 # maximum distance of a merged vertex from the plane
+
+# Compact variant, int16 vertices quantized over the mesh bounds and octahedral normals
+COMPACT_QUANTIZED_MAX = 32767
+
+# Triangle adjacency, written after the normals
+ADJACENCY_TAG = b"CADJ"
+NO_NEIGHBOR = 0xFFFF
+# 2 bits per edge, edge i (v[i] -> v[(i + 1) % 3]) uses bits 2i and 2i + 1
+EDGE_BOUNDARY = 0
+EDGE_CONVEX = 1
+EDGE_CONCAVE = 2
+EDGE_FLAT = 3
+
+
+def vec_sub(a, b):
+    return (a[0] - b[0], a[1] - b[1], a[2] - b[2])
+
+def vec_dot(a, b):
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]
+
+def vec_cross(a, b):
+    return (a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0])
+
+def vec_length(a):
+    return vec_dot(a, a) ** 0.5
+
+def vec_normalize(a):
+    magnitude = vec_length(a)
+    if magnitude == 0:
+        return (0.0, 0.0, 0.0)
+    return (a[0] / magnitude, a[1] / magnitude, a[2] / magnitude)
+
+
+def triangle_normal(vertices, tri):
+    v0, v1, v2 = (vertices[i] for i in tri)
+    return vec_normalize(vec_cross(vec_sub(v1, v0), vec_sub(v2, v0)))
+
+
+def encode_octahedral(normal):
+    """Encode a unit vector as two signed 8 bit octahedral coordinates, x in the high byte"""
+    l1 = abs(normal[0]) + abs(normal[1]) + abs(normal[2])
+    if l1 == 0:
+        return 0
+
+    x = normal[0] / l1
+    y = normal[1] / l1
+    if normal[2] < 0:
+        x, y = (1 - abs(y)) * (1 if x >= 0 else -1), (1 - abs(x)) * (1 if y >= 0 else -1)
+
+    encoded_x = int(round(max(-1.0, min(1.0, x)) * 127)) & 0xFF
+    encoded_y = int(round(max(-1.0, min(1.0, y)) * 127)) & 0xFF
+    return (encoded_x << 8) | encoded_y
+
+
+def quantize_vertices(vertices):
+    """Quantize vertices to int16 over the mesh bounds, returns the origin, the scale per quantized unit and the vertices"""
+    origin = []
+    scale = []
+    for axis in range(3):
+        low = min(vert[axis] for vert in vertices)
+        high = max(vert[axis] for vert in vertices)
+        origin.append((low + high) * 0.5)
+        half_extent = (high - low) * 0.5
+        scale.append(half_extent / COMPACT_QUANTIZED_MAX if half_extent > 0 else 1.0)
+
+    quantized = [tuple(int(round((vert[axis] - origin[axis]) / scale[axis])) for axis in range(3)) for vert in vertices]
+    return tuple(origin), tuple(scale), quantized
+
+
+def collect_triangles(collection, base_scale):
     vertices = []
     triangles = []
-    normals = []
+    source_triangle_count = 0
 
     for obj in collection.objects:
         if obj.type != 'MESH':
             continue  # Skip non-mesh objects
 
         mesh = obj.data
-        mesh.calc_normals_split()  # Ensure the normals are calculated
+        mesh.calc_loop_triangles()  # Quads and n-gons are triangulated instead of skipped
         vert_offset = len(vertices)  # Keep track of vertex indices offset for each object
 
-
         # Collect and scale vertices
-        # vertices.extend([tuple(vert.co * scale) for vert in mesh.vertices])
         vertices.extend([(vert.co.x * base_scale, vert.co.z * base_scale, -vert.co.y * base_scale) for vert in mesh.vertices])
 
-        # Collect triangles and normals
-        for poly in mesh.polygons:
-            if len(poly.vertices) != 3:
-                continue  # Skip non-triangular faces
-            
-            triangles.append([vert_offset + poly.vertices[i] for i in range(3)])
-            normal = poly.normal
-            # Normalize the normal vector
-            magnitude = (normal.x**2 + normal.y**2 + normal.z**2)**0.5
-            if magnitude > 0:  # Avoid division by zero
-                normal_x = normal.x / magnitude
-                normal_y = normal.y / magnitude
-                normal_z = normal.z / magnitude
-                normals.append((normal_x, normal_z, -normal_y))
+        source_triangle_count += sum(1 for poly in mesh.polygons if len(poly.vertices) == 3)
+
+        for tri in mesh.loop_triangles:
+            triangles.append(tuple(vert_offset + tri.vertices[i] for i in range(3)))
+
+    return vertices, triangles, source_triangle_count
+
+
+def weld_vertices(vertices, triangles):
+    """Merge vertices closer than WELD_DISTANCE using a hash grid"""
+    cell_size = WELD_DISTANCE
+    grid = {}
+    welded = []
+    remap = []
+
+    for vert in vertices:
+        cell = tuple(int(vert[i] // cell_size) for i in range(3))
+        match = None
+
+        for dx in (-1, 0, 1):
+            for dy in (-1, 0, 1):
+                for dz in (-1, 0, 1):
+                    for candidate in grid.get((cell[0] + dx, cell[1] + dy, cell[2] + dz), ()):
+                        if vec_length(vec_sub(welded[candidate], vert)) <= WELD_DISTANCE:
+                            match = candidate
+                            break
+                    if match is not None:
+                        break
+                if match is not None:
+                    break
+
+        if match is None:
+            match = len(welded)
+            welded.append(vert)
+            grid.setdefault(cell, []).append(match)
+
+        remap.append(match)
+
+    return welded, [tuple(remap[i] for i in tri) for tri in triangles]
+
+
+def remove_degenerates(vertices, triangles):
+    """Remove triangles with collapsed corners, slivers thinner than SLIVER_MIN_ALTITUDE and duplicates"""
+    result = []
+    seen = set()
+
+    for tri in triangles:
+        if len(set(tri)) != 3:
+            continue
+
+        v0, v1, v2 = (vertices[i] for i in tri)
+        double_area = vec_length(vec_cross(vec_sub(v1, v0), vec_sub(v2, v0)))
+        longest_edge = max(vec_length(vec_sub(v1, v0)), vec_length(vec_sub(v2, v1)), vec_length(vec_sub(v0, v2)))
+        if longest_edge == 0 or double_area / longest_edge < SLIVER_MIN_ALTITUDE:
+            continue
+
+        key = tuple(sorted(tri))
+        if key in seen:
+            continue
+        seen.add(key)
+
+        result.append(tri)
+
+    return result
+
+
+def build_edge_map(triangles):
+    """Map each directed edge (a, b) to the triangles using it"""
+    edges = {}
+    for index, tri in enumerate(triangles):
+        for i in range(3):
+            edges.setdefault((tri[i], tri[(i + 1) % 3]), []).append(index)
+    return edges
+
+
+def find_coplanar_regions(vertices, triangles, normals, edges):
+    """Flood fill regions of coplanar triangles connected by manifold edges with consistent winding"""
+    region_of = [-1] * len(triangles)
+    regions = []
+
+    for start in range(len(triangles)):
+        if region_of[start] != -1:
+            continue
+
+        region = [start]
+        region_of[start] = len(regions)
+        normal = normals[start]
+        plane_d = vec_dot(normal, vertices[triangles[start][0]])
+        stack = [start]
+
+        while stack:
+            current = stack.pop()
+            tri = triangles[current]
+            for i in range(3):
+                a, b = tri[i], tri[(i + 1) % 3]
+                if len(edges.get((a, b), ())) != 1:
+                    continue
+                neighbors = edges.get((b, a), ())
+                if len(neighbors) != 1:
+                    continue
+
+                neighbor = neighbors[0]
+                if region_of[neighbor] != -1:
+                    continue
+                if vec_dot(normals[neighbor], normal) < COPLANAR_MIN_NORMAL_DOT:
+                    continue
+                if any(abs(vec_dot(normal, vertices[v]) - plane_d) > COPLANAR_MAX_DISTANCE for v in triangles[neighbor]):
+                    continue
+
+                region_of[neighbor] = len(regions)
+                region.append(neighbor)
+                stack.append(neighbor)
+
+        regions.append(region)
+
+    return regions
+
+
+def region_boundary_loop(triangles, region):
+    """Returns the boundary of a region as a single vertex loop, or None if it has holes or pinched vertices"""
+    directed = set()
+    for index in region:
+        tri = triangles[index]
+        for i in range(3):
+            directed.add((tri[i], tri[(i + 1) % 3]))
+
+    next_vertex = {}
+    for a, b in directed:
+        if (b, a) in directed:
+            continue
+        if a in next_vertex:
+            return None  # pinched vertex
+        next_vertex[a] = b
+
+    if not next_vertex:
+        return None
+
+    start = next(iter(next_vertex))
+    loop = [start]
+    current = next_vertex[start]
+    while current != start:
+        if current not in next_vertex or len(loop) > len(next_vertex):
+            return None
+        loop.append(current)
+        current = next_vertex[current]
+
+    if len(loop) != len(next_vertex):
+        return None  # more than one loop, the region has holes
+
+    return loop
+
+
+def remove_collinear(vertices, loop):
+    """Drop loop vertices that lie on the line between their neighbors"""
+    changed = True
+    while changed and len(loop) > 3:
+        changed = False
+        for i in range(len(loop)):
+            prev_v = vertices[loop[i - 1]]
+            cur_v = vertices[loop[i]]
+            next_v = vertices[loop[(i + 1) % len(loop)]]
+            edge = vec_sub(next_v, prev_v)
+            edge_length = vec_length(edge)
+            if edge_length == 0:
+                continue
+            distance = vec_length(vec_cross(vec_sub(cur_v, prev_v), edge)) / edge_length
+            if distance < WELD_DISTANCE:
+                del loop[i]
+                changed = True
+                break
+    return loop
+
+
+def ear_clip(vertices, loop, normal):
+    """Triangulate a simple planar polygon, returns None if no ear could be found"""
+    # project onto the plane of the largest normal component
+    axis = max(range(3), key=lambda i: abs(normal[i]))
+    u_axis, v_axis = [i for i in range(3) if i != axis]
+    points = {v: (vertices[v][u_axis], vertices[v][v_axis]) for v in loop}
+
+    def cross2(o, a, b):
+        return (a[0] - o[0]) * (b[1] - o[1]) - (a[1] - o[1]) * (b[0] - o[0])
+
+    area = sum(cross2((0.0, 0.0), points[loop[i - 1]], points[loop[i]]) for i in range(len(loop)))
+    orientation = 1.0 if area > 0 else -1.0
+
+    def inside(p, a, b, c):
+        return (cross2(a, b, p) * orientation >= 0 and
+                cross2(b, c, p) * orientation >= 0 and
+                cross2(c, a, p) * orientation >= 0)
+
+    remaining = list(loop)
+    result = []
+    while len(remaining) > 3:
+        for i in range(len(remaining)):
+            a = remaining[i - 1]
+            b = remaining[i]
+            c = remaining[(i + 1) % len(remaining)]
+            if cross2(points[a], points[b], points[c]) * orientation <= 0:
+                continue  # reflex corner
+            if any(inside(points[v], points[a], points[b], points[c]) for v in remaining if v not in (a, b, c)):
+                continue
+            result.append((a, b, c))
+            del remaining[i]
+            break
+        else:
+            return None
+
+    result.append(tuple(remaining))
+    return result
+
+
+def merge_coplanar(vertices, triangles):
+    """Re-triangulate connected coplanar regions with as few triangles as possible"""
+    normals = [triangle_normal(vertices, tri) for tri in triangles]
+    edges = build_edge_map(triangles)
+    result = []
+
+    for region in find_coplanar_regions(vertices, triangles, normals, edges):
+        if len(region) > 1:
+            loop = region_boundary_loop(triangles, region)
+            if loop is not None:
+                loop = remove_collinear(vertices, loop)
+                merged = ear_clip(vertices, loop, normals[region[0]]) if len(loop) >= 3 else None
+                if merged is not None and len(merged) < len(region):
+                    result.extend(merged)
+                    continue
+
+        result.extend(triangles[index] for index in region)
+
+    return result
+
+
+def compact_vertices(vertices, triangles):
+    """Drop vertices that are no longer referenced"""
+    remap = {}
+    compacted = []
+    for tri in triangles:
+        for v in tri:
+            if v not in remap:
+                remap[v] = len(compacted)
+                compacted.append(vertices[v])
+    return compacted, [tuple(remap[v] for v in tri) for tri in triangles]
+
+
+def build_adjacency(vertices, triangles, normals):
+    """Neighbor triangle and convexity flag of every triangle edge"""
+    edges = build_edge_map(triangles)
+    adjacency = []
+    edge_flags = []
+
+    for index, tri in enumerate(triangles):
+        neighbors = []
+        flags = 0
+        for i in range(3):
+            a, b = tri[i], tri[(i + 1) % 3]
+            candidates = edges.get((b, a), ())
+            if len(candidates) != 1 or len(edges.get((a, b), ())) != 1:
+                neighbors.append(NO_NEIGHBOR)
+                continue
+
+            neighbor = candidates[0]
+            neighbors.append(neighbor)
+
+            opposite = next(v for v in triangles[neighbor] if v != a and v != b)
+            side = vec_dot(normals[index], vec_sub(vertices[opposite], vertices[a]))
+            if side < -COPLANAR_MAX_DISTANCE:
+                edge_type = EDGE_CONVEX
+            elif side > COPLANAR_MAX_DISTANCE:
+                edge_type = EDGE_CONCAVE
             else:
-                # Fallback for degenerate normals
-                normals.append((0.0, 0.0, 0.0))
+                edge_type = EDGE_FLAT
+            flags |= edge_type << (2 * i)
+
+        adjacency.append(neighbors)
+        edge_flags.append(flags)
+
+    return adjacency, edge_flags
+
+
+def write_collision_data(output_path, base_scale, compact=False):
+    # Ensure the collection exists
+    collection = bpy.data.collections.get("collision")
+    if not collection:
+        print("Collection 'collision' not found.")
+        return
+
+    vertices, triangles, source_triangle_count = collect_triangles(collection, base_scale)
+    source_vertex_count = len(vertices)
+    triangulated_count = len(triangles)
+
+    vertices, triangles = weld_vertices(vertices, triangles)
+    triangles = remove_degenerates(vertices, triangles)
+    cleaned_count = len(triangles)
+    triangles = merge_coplanar(vertices, triangles)
+    vertices, triangles = compact_vertices(vertices, triangles)
 
-    print(f"Vertices: {len(vertices)}")
-    print(f"Triangles: {len(triangles)}")
+    normals = [triangle_normal(vertices, tri) for tri in triangles]
+    adjacency, edge_flags = build_adjacency(vertices, triangles, normals)
+
+    print(f"Vertices: {source_vertex_count} -> {len(vertices)}")
+    print(f"Triangles: {source_triangle_count} source triangles, {triangulated_count} after triangulation, "
+          f"{cleaned_count} after welding and degenerate removal, {len(triangles)} after coplanar merging")
+
+    if compact:
+        origin, scale, quantized = quantize_vertices(vertices)
+        max_error = max(
+            abs(origin[axis] + q[axis] * scale[axis] - vert[axis])
+            for vert, q in zip(vertices, quantized) for axis in range(3)
+        )
+        print(f"Compact: {len(vertices) * 6 + len(triangles) * 8} bytes of vertex and triangle data "
+              f"instead of {len(vertices) * 12 + len(triangles) * 18}, max vertex error {max_error}")
 
     # Write data to the binary file
     with open(output_path, 'wb') as f:
         # Write header
-        f.write(b"CMSH")
-        
+        f.write(b"CMSQ" if compact else b"CMSH")
+
+        if compact:
+            f.write(struct.pack('>fff', *origin))
+            f.write(struct.pack('>fff', *scale))
+
         # Write vertex count
         vertex_count = len(vertices)
         f.write(struct.pack('>H', vertex_count))
-        
+
         # Write vertices
-        for vert in vertices:
-            f.write(struct.pack('>fff', *vert))
-        
+        if compact:
+            for vert in quantized:
+                f.write(struct.pack('>hhh', *vert))
+        else:
+            for vert in vertices:
+                f.write(struct.pack('>fff', *vert))
+
         # Write triangle count
         triangle_count = len(triangles)
         f.write(struct.pack('>H', triangle_count))
-        
+
         # Write triangle indices
         for tri in triangles:
             f.write(struct.pack('>HHH', *tri))
-        
+
         # Write normals
         for normal in normals:
-            f.write(struct.pack('>fff', *normal))
-    
+            if compact:
+                f.write(struct.pack('>H', encode_octahedral(normal)))
+            else:
+                f.write(struct.pack('>fff', *normal))
+
+        # Write adjacency (neighbor triangle per edge, then the packed edge flags)
+        f.write(ADJACENCY_TAG)
+        for neighbors in adjacency:
+            f.write(struct.pack('>HHH', *neighbors))
+        for flags in edge_flags:
+            f.write(struct.pack('>B', flags))
+
     print(f"Collision data successfully written to {output_path}")
 
 # Entry point for the script
@@ -85,17 +461,19 @@ if __name__ == "__main__":
 
     if len(argv) < 1:
         print(bpy.data.filepath)
-        print("Usage: blender -b <source_file> --python <script.py> -- <output_path> [base_scale]")
+        print("Usage: blender -b <source_file> --python <script.py> -- <output_path> [base_scale] [float|compact]")
         sys.exit(1)
 
     source_file = bpy.data.filepath
     output_path = argv[0]
     base_scale = int(argv[1]) if len(argv) > 1 else 1  # Default base_scale to 1 if not provided
-    
+    compact = len(argv) > 2 and argv[2] == "compact"  # Default to float vertices and normals
+
     # Print out the arguments
     print(f"Source file: {source_file}")
     print(f"Output path: {output_path}")
     print(f"Base scale: {base_scale}")
-    
+    print(f"Format: {'compact' if compact else 'float'}")
+
     # Write the collision data
-    write_collision_data(output_path, base_scale)
\ No newline at end of file
+    write_collision_data(output_path, base_scale, compact)
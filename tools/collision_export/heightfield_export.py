@@ -0,0 +1,132 @@
+import bpy
+import struct
+import sys
+import math
+from mathutils import Vector
+from mathutils.bvhtree import BVHTree
+
+# Terrain meshes are placed in this collection instead of 'collision'.
+# Walls, overhangs and anything else that isn't a heightmap stays in the 'collision' collection.
+HEIGHTFIELD_COLLECTION = "heightfield"
+DEFAULT_CELL_SIZE = 2.0 # in exported units (after base_scale)
+HEIGHT_QUANTIZED_MAX = 32767
+HOLE = -32768 # samples where no terrain was found
+
+
+def build_trees(collection):
+    depsgraph = bpy.context.evaluated_depsgraph_get()
+    trees = []
+
+    for obj in collection.objects:
+        if obj.type != 'MESH':
+            continue  # Skip non-mesh objects
+
+        evaluated = obj.evaluated_get(depsgraph)
+        mesh = evaluated.to_mesh()
+        # object transforms are ignored like in collision_export.py, so both line up
+        vertices = [vert.co.copy() for vert in mesh.vertices]
+        polygons = [tuple(poly.vertices) for poly in mesh.polygons]
+        trees.append(BVHTree.FromPolygons(vertices, polygons))
+        evaluated.to_mesh_clear()
+
+    return trees
+
+
+def sample_heights(trees, min_x, max_x, min_z, max_z, top, cell_size):
+    """Cast a ray down at every grid sample, returns the samples in game space (y up, z = -blender y)"""
+    cells_x = max(1, math.ceil((max_x - min_x) / cell_size))
+    cells_z = max(1, math.ceil((max_z - min_z) / cell_size))
+    heights = []
+
+    for z in range(cells_z + 1):
+        for x in range(cells_x + 1):
+            game_x = min_x + x * cell_size
+            game_z = min_z + z * cell_size
+            origin = Vector((game_x, -game_z, top + 1.0))
+
+            best = None
+            for tree in trees:
+                location, normal, index, distance = tree.ray_cast(origin, Vector((0.0, 0.0, -1.0)))
+                if location is not None and (best is None or location.z > best):
+                    best = location.z
+            heights.append(best)
+
+    return cells_x, cells_z, heights
+
+
+def write_heightfield(output_path, base_scale, cell_size):
+    collection = bpy.data.collections.get(HEIGHTFIELD_COLLECTION)
+
+    cells_x = 0
+    cells_z = 0
+    origin = (0.0, 0.0, 0.0)
+    height_scale = 1.0
+    samples = [0]
+
+    trees = build_trees(collection) if collection else []
+    if trees:
+        # bounds of the terrain in blender units, the grid is sampled in game space orientation
+        corners = [Vector(corner) for obj in collection.objects if obj.type == 'MESH' for corner in obj.bound_box]
+        min_x = min(c.x for c in corners)
+        max_x = max(c.x for c in corners)
+        min_z = min(-c.y for c in corners)
+        max_z = max(-c.y for c in corners)
+        top = max(c.z for c in corners)
+
+        blender_cell_size = cell_size / base_scale
+        cells_x, cells_z, heights = sample_heights(trees, min_x, max_x, min_z, max_z, top, blender_cell_size)
+
+        found = [h for h in heights if h is not None]
+        low = min(found) if found else 0.0
+        high = max(found) if found else 0.0
+        mid = (low + high) * 0.5
+        height_scale = max((high - low) * 0.5 / HEIGHT_QUANTIZED_MAX, 1e-6) * base_scale
+
+        origin = (min_x * base_scale, mid * base_scale, min_z * base_scale)
+        samples = [HOLE if h is None else max(-HEIGHT_QUANTIZED_MAX, min(HEIGHT_QUANTIZED_MAX, round((h - mid) * base_scale / height_scale))) for h in heights]
+
+        holes = sum(1 for h in heights if h is None)
+        print(f"Heightfield: {cells_x} x {cells_z} cells of size {cell_size}, {holes} hole samples, height step {height_scale}")
+    else:
+        print(f"Collection '{HEIGHTFIELD_COLLECTION}' not found or empty, writing an empty heightfield.")
+
+    with open(output_path, 'wb') as f:
+        # Write header
+        f.write(b"CHFD")
+
+        # Write grid size
+        f.write(struct.pack('>HH', cells_x, cells_z))
+
+        # Write placement
+        f.write(struct.pack('>fff', *origin))
+        f.write(struct.pack('>ff', cell_size, height_scale))
+
+        # Write samples, row major along x
+        for sample in samples:
+            f.write(struct.pack('>h', sample))
+
+    print(f"Heightfield successfully written to {output_path}")
+
+# Entry point for the script
+if __name__ == "__main__":
+    # Retrieve arguments
+    argv = sys.argv
+    if "--" in argv:
+        argv = argv[argv.index("--") + 1:]  # Get all arguments after "--"
+    else:
+        argv = []  # No arguments provided
+
+    if len(argv) < 1:
+        print("Usage: blender -b <source_file> --python <script.py> -- <output_path> [base_scale] [cell_size]")
+        sys.exit(1)
+
+    output_path = argv[0]
+    base_scale = int(argv[1]) if len(argv) > 1 else 1  # Default base_scale to 1 if not provided
+    cell_size = float(argv[2]) if len(argv) > 2 else DEFAULT_CELL_SIZE
+
+    print(f"Source file: {bpy.data.filepath}")
+    print(f"Output path: {output_path}")
+    print(f"Base scale: {base_scale}")
+    print(f"Cell size: {cell_size}")
+
+    write_heightfield(output_path, base_scale, cell_size)
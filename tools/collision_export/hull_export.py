@@ -0,0 +1,152 @@
+import bpy
+import bmesh
+import struct
+import sys
+
+# Meshes in this collection form the hull, if the collection doesn't exist all meshes in the file are used
+HULL_COLLECTION = "hull"
+# The runtime stores neighbor indices in 8 bits
+MAX_HULL_VERTICES = 255
+WELD_DISTANCE = 0.001 # in exported units (after base_scale)
+
+
+def vec_sub(a, b):
+    return (a[0] - b[0], a[1] - b[1], a[2] - b[2])
+
+def vec_dot(a, b):
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]
+
+def vec_cross(a, b):
+    return (a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0])
+
+
+def collect_points(base_scale):
+    collection = bpy.data.collections.get(HULL_COLLECTION)
+    objects = collection.objects if collection else bpy.data.objects
+    depsgraph = bpy.context.evaluated_depsgraph_get()
+    points = []
+
+    for obj in objects:
+        if obj.type != 'MESH':
+            continue  # Skip non-mesh objects
+
+        evaluated = obj.evaluated_get(depsgraph)
+        mesh = evaluated.to_mesh()
+        # object transforms are ignored like in collision_export.py, blender z up is game y up
+        points.extend([(vert.co.x * base_scale, vert.co.z * base_scale, -vert.co.y * base_scale) for vert in mesh.vertices])
+        evaluated.to_mesh_clear()
+
+    return points
+
+
+def build_hull(points):
+    """Returns the hull vertices and triangles, vertices that are not part of the hull are dropped"""
+    bm = bmesh.new()
+    for point in points:
+        bm.verts.new(point)
+    bmesh.ops.remove_doubles(bm, verts=bm.verts, dist=WELD_DISTANCE)
+
+    result = bmesh.ops.convex_hull(bm, input=bm.verts)
+    bmesh.ops.delete(bm, geom=[elem for elem in result["geom_interior"] + result["geom_unused"] if isinstance(elem, bmesh.types.BMVert)], context='VERTS')
+    # merge coplanar triangles, so the vertex graph has no redundant edges across flat faces
+    bmesh.ops.dissolve_limit(bm, angle_limit=0.0001, verts=bm.verts, edges=bm.edges)
+    bmesh.ops.triangulate(bm, faces=bm.faces)
+
+    bm.verts.index_update()
+    vertices = [tuple(vert.co) for vert in bm.verts]
+    triangles = [tuple(vert.index for vert in face.verts) for face in bm.faces]
+    # the edges of the n-gons before triangulation would be enough, but the extra diagonals only add shortcuts
+    neighbors = [sorted(edge.other_vert(vert).index for edge in vert.link_edges) for vert in bm.verts]
+    bm.free()
+
+    return vertices, triangles, neighbors
+
+
+def mass_properties(vertices, triangles):
+    """Volume, centroid and inertia diagonal per unit mass of a closed triangle mesh, by signed tetrahedra"""
+    volume = 0.0
+    centroid = [0.0, 0.0, 0.0]
+    # second moments integral x^2, y^2, z^2 over the volume
+    moments = [0.0, 0.0, 0.0]
+
+    for tri in triangles:
+        a, b, c = (vertices[i] for i in tri)
+        tet_volume = vec_dot(a, vec_cross(b, c)) / 6.0
+        volume += tet_volume
+        for axis in range(3):
+            centroid[axis] += tet_volume * (a[axis] + b[axis] + c[axis]) / 4.0
+            # integral of x^2 over a tetrahedron with one vertex at the origin
+            moments[axis] += tet_volume / 10.0 * (a[axis] * a[axis] + b[axis] * b[axis] + c[axis] * c[axis] +
+                                                  a[axis] * b[axis] + b[axis] * c[axis] + c[axis] * a[axis])
+
+    if abs(volume) < 1e-9:
+        return 0.0, (0.0, 0.0, 0.0), (1.0, 1.0, 1.0)
+
+    centroid = tuple(value / volume for value in centroid)
+    # per unit mass and moved to the centroid
+    second = [moments[axis] / volume - centroid[axis] * centroid[axis] for axis in range(3)]
+    inertia = (second[1] + second[2], second[0] + second[2], second[0] + second[1])
+    return volume, centroid, inertia
+
+
+def write_hull(output_path, base_scale):
+    points = collect_points(base_scale)
+    vertices, triangles, neighbors = build_hull(points) if len(points) >= 4 else ([], [], [])
+
+    if len(vertices) > MAX_HULL_VERTICES:
+        raise ValueError(f"Hull has {len(vertices)} vertices, the limit is {MAX_HULL_VERTICES}")
+
+    volume, centroid, inertia = mass_properties(vertices, triangles)
+    # vertices are stored around the centroid, the centroid is the center offset of the physics object
+    vertices = [vec_sub(vert, centroid) for vert in vertices]
+    adjacency_count = sum(len(vert_neighbors) for vert_neighbors in neighbors)
+
+    print(f"Hull: {len(points)} source vertices, {len(vertices)} hull vertices, {adjacency_count} neighbor entries, volume {volume}")
+
+    with open(output_path, 'wb') as f:
+        # Write header
+        f.write(b"CHUL")
+
+        f.write(struct.pack('>HH', len(vertices), adjacency_count))
+
+        # Write mass properties
+        f.write(struct.pack('>fff', *centroid))
+        f.write(struct.pack('>fff', *inertia))
+
+        # Write vertices
+        for vert in vertices:
+            f.write(struct.pack('>fff', *vert))
+
+        # Write adjacency, the neighbors of vertex i are adjacency[offsets[i]:offsets[i + 1]]
+        offset = 0
+        for vert_neighbors in neighbors:
+            f.write(struct.pack('>H', offset))
+            offset += len(vert_neighbors)
+        f.write(struct.pack('>H', offset))
+
+        for vert_neighbors in neighbors:
+            f.write(struct.pack(f'>{len(vert_neighbors)}B', *vert_neighbors))
+
+    print(f"Convex hull successfully written to {output_path}")
+
+# Entry point for the script
+if __name__ == "__main__":
+    # Retrieve arguments
+    argv = sys.argv
+    if "--" in argv:
+        argv = argv[argv.index("--") + 1:]  # Get all arguments after "--"
+    else:
+        argv = []  # No arguments provided
+
+    if len(argv) < 1:
+        print("Usage: blender -b <source_file> --python <script.py> -- <output_path> [base_scale]")
+        sys.exit(1)
+
+    output_path = argv[0]
+    base_scale = int(argv[1]) if len(argv) > 1 else 1  # Default base_scale to 1 if not provided
+
+    print(f"Source file: {bpy.data.filepath}")
+    print(f"Output path: {output_path}")
+    print(f"Base scale: {base_scale}")
+
+    write_hull(output_path, base_scale)
@@ -0,0 +1,282 @@
+import bpy
+import struct
+import sys
+import math
+import random
+from mathutils import Vector
+from mathutils.bvhtree import BVHTree
+
+# Meshes in these collections are collision only, every other mesh is a chunk of the visible map
+COLLISION_COLLECTIONS = ["collision", "heightfield"]
+DEFAULT_CELL_SIZE = 16.0 # in exported units (after base_scale)
+TARGET_SAMPLES = 64 # points sampled on the surface of every chunk
+DILATE_CELLS = 1 # every cell also sees what the cells this close to it see, covers the gaps between the camera samples
+CEILING_CELLS = 2 # the camera can go this many cells above the highest geometry
+RAY_EPSILON = 0.001 # in blender units
+RANDOM_SEED = 1 # the bake is deterministic so unchanged maps produce the same file
+
+
+def blender_to_game(co):
+    # blender z up is game y up
+    return Vector((co.x, co.z, -co.y))
+
+def game_to_blender(co):
+    return Vector((co.x, -co.z, co.y))
+
+
+def collect_chunks():
+    """Returns (name, vertices, triangles) of every visible mesh, vertices in blender space"""
+    skip = set()
+    for collection_name in COLLISION_COLLECTIONS:
+        collection = bpy.data.collections.get(collection_name)
+        if collection:
+            skip.update(obj.name for obj in collection.all_objects)
+
+    depsgraph = bpy.context.evaluated_depsgraph_get()
+    chunks = []
+
+    for obj in sorted(bpy.data.objects, key=lambda obj: obj.name):
+        if obj.type != 'MESH' or obj.name in skip:
+            continue  # Skip non-mesh and collision objects
+
+        evaluated = obj.evaluated_get(depsgraph)
+        mesh = evaluated.to_mesh()
+        mesh.calc_loop_triangles()
+        # unlike the collision meshes the visible meshes keep their object transform, as in the gltf export
+        vertices = [obj.matrix_world @ vert.co for vert in mesh.vertices]
+        triangles = [tuple(tri.vertices) for tri in mesh.loop_triangles]
+        evaluated.to_mesh_clear()
+
+        if triangles:
+            chunks.append((obj.name, vertices, triangles))
+
+    return chunks
+
+
+def build_occluders(chunks):
+    """One tree over all chunks, along with the chunk of every triangle in it"""
+    vertices = []
+    triangles = []
+    triangle_chunks = []
+
+    for chunk_index, (name, chunk_vertices, chunk_triangles) in enumerate(chunks):
+        offset = len(vertices)
+        vertices.extend(chunk_vertices)
+        triangles.extend(tuple(index + offset for index in tri) for tri in chunk_triangles)
+        triangle_chunks.extend([chunk_index] * len(chunk_triangles))
+
+    return BVHTree.FromPolygons(vertices, triangles), triangle_chunks
+
+
+def sample_surface(vertices, triangles, count, rng):
+    """Area weighted random points on the triangles"""
+    areas = []
+    total = 0.0
+    for a, b, c in triangles:
+        total += (vertices[b] - vertices[a]).cross(vertices[c] - vertices[a]).length * 0.5
+        areas.append(total)
+
+    if total <= 0.0:
+        return [vertices[triangles[0][0]].copy()]
+
+    points = []
+    for _ in range(count):
+        pick = rng.random() * total
+        tri = next(i for i, area in enumerate(areas) if area >= pick)
+        a, b, c = (vertices[index] for index in triangles[tri])
+        u = rng.random()
+        v = rng.random()
+        if u + v > 1.0:
+            u = 1.0 - u
+            v = 1.0 - v
+        points.append(a + (b - a) * u + (c - a) * v)
+
+    return points
+
+
+def is_inside_geometry(tree, point):
+    """A point is inside closed geometry if the first face above it is seen from behind"""
+    location, normal, index, distance = tree.ray_cast(point, Vector((0.0, 0.0, 1.0)))
+    return location is not None and normal.z > 0.0
+
+
+def is_point_visible(tree, triangle_chunks, camera, target, chunk_index):
+    direction = target - camera
+    length = direction.length
+    if length < RAY_EPSILON:
+        return True
+
+    location, normal, index, distance = tree.ray_cast(camera, direction / length, length - RAY_EPSILON)
+    # a hit on the chunk itself still means the chunk is seen
+    return location is None or triangle_chunks[index] == chunk_index
+
+
+def camera_samples():
+    """The corners, the face centers and the center of a cell, relative to its size"""
+    samples = [Vector((x, y, z)) for x in (0.0, 1.0) for y in (0.0, 1.0) for z in (0.0, 1.0)]
+
+    for axis in range(3):
+        for side in (0.0, 1.0):
+            face = Vector((0.5, 0.5, 0.5))
+            face[axis] = side
+            samples.append(face)
+
+    samples.append(Vector((0.5, 0.5, 0.5)))
+    return samples
+
+
+def bake_cell(tree, triangle_chunks, chunk_targets, chunk_bounds, cell_min, cell_size):
+    """Returns the visibility of every chunk from the samples of the cell, in blender space"""
+    cameras = []
+    for sample in camera_samples():
+        camera = game_to_blender(cell_min + sample * cell_size)
+        if not is_inside_geometry(tree, camera):
+            cameras.append(camera)
+
+    # the camera should never be inside the map, but stay conservative if it ever is
+    if not cameras:
+        return [True] * len(chunk_targets)
+
+    cell_center = cell_min + Vector((0.5, 0.5, 0.5)) * cell_size
+    visible = []
+
+    for chunk_index, targets in enumerate(chunk_targets):
+        bounds_min, bounds_max = chunk_bounds[chunk_index]
+        if all(bounds_min[axis] <= cell_center[axis] <= bounds_max[axis] for axis in range(3)):
+            visible.append(True)
+            continue
+
+        visible.append(any(is_point_visible(tree, triangle_chunks, camera, target, chunk_index) for camera in cameras for target in targets))
+
+    return visible
+
+
+def dilate_cells(cell_visible, cells):
+    """Adds the chunks seen from the neighbouring cells to every cell"""
+    def cell_index(x, y, z):
+        return x + cells[0] * (z + cells[2] * y)
+
+    dilated = []
+    for y in range(cells[1]):
+        for z in range(cells[2]):
+            for x in range(cells[0]):
+                visible = list(cell_visible[cell_index(x, y, z)])
+
+                for ny in range(max(0, y - DILATE_CELLS), min(cells[1], y + DILATE_CELLS + 1)):
+                    for nz in range(max(0, z - DILATE_CELLS), min(cells[2], z + DILATE_CELLS + 1)):
+                        for nx in range(max(0, x - DILATE_CELLS), min(cells[0], x + DILATE_CELLS + 1)):
+                            neighbour = cell_visible[cell_index(nx, ny, nz)]
+                            visible = [a or b for a, b in zip(visible, neighbour)]
+
+                dilated.append(visible)
+
+    return dilated
+
+
+def write_pvs(output_path, base_scale, cell_size):
+    rng = random.Random(RANDOM_SEED)
+    chunks = collect_chunks()
+
+    names = [name for name, vertices, triangles in chunks]
+    # bounds in unscaled game space, only used by the bake
+    chunk_bounds = []
+    for name, vertices, triangles in chunks:
+        game_vertices = [blender_to_game(vert) for vert in vertices]
+        chunk_bounds.append((
+            Vector(tuple(min(vert[axis] for vert in game_vertices) for axis in range(3))),
+            Vector(tuple(max(vert[axis] for vert in game_vertices) for axis in range(3))),
+        ))
+
+    cells = (0, 0, 0)
+    origin = Vector((0.0, 0.0, 0.0))
+    cell_rows = []
+    rows = []
+
+    if chunks:
+        tree, triangle_chunks = build_occluders(chunks)
+        chunk_targets = [sample_surface(vertices, triangles, TARGET_SAMPLES, rng) for name, vertices, triangles in chunks]
+
+        blender_cell_size = cell_size / base_scale
+        origin = Vector(tuple(min(bounds[0][axis] for bounds in chunk_bounds) for axis in range(3)))
+        top = Vector(tuple(max(bounds[1][axis] for bounds in chunk_bounds) for axis in range(3)))
+        top.y += CEILING_CELLS * blender_cell_size
+        cells = tuple(max(1, math.ceil((top[axis] - origin[axis]) / blender_cell_size)) for axis in range(3))
+
+        cell_visible = []
+        # cells are ordered along x, then z, then y
+        for y in range(cells[1]):
+            for z in range(cells[2]):
+                for x in range(cells[0]):
+                    cell_min = origin + Vector((x, y, z)) * blender_cell_size
+                    cell_visible.append(bake_cell(tree, triangle_chunks, chunk_targets, chunk_bounds, cell_min, blender_cell_size))
+
+            print(f"PVS: baked layer {y + 1} of {cells[1]}")
+
+        # the samples can miss chunks seen from between them, the neighbours make the set conservative
+        row_indices = {}
+        for visible in dilate_cells(cell_visible, cells):
+            row = bytearray((len(chunks) + 7) // 8)
+            for chunk_index, is_visible in enumerate(visible):
+                if is_visible:
+                    row[chunk_index >> 3] |= 1 << (chunk_index & 7)
+            row = bytes(row)
+
+            # many cells see the same chunks, identical rows are stored once
+            if row not in row_indices:
+                row_indices[row] = len(rows)
+                rows.append(row)
+            cell_rows.append(row_indices[row])
+
+        average = sum(bin(int.from_bytes(rows[index], 'big')).count('1') for index in cell_rows) / len(cell_rows)
+        print(f"PVS: {len(chunks)} chunks, {cells[0]} x {cells[1]} x {cells[2]} cells of size {cell_size}, {len(rows)} unique rows, {average:.1f} visible chunks per cell")
+    else:
+        print("No visible meshes found, writing an empty PVS.")
+
+    with open(output_path, 'wb') as f:
+        # Write header
+        f.write(b"CPVS")
+
+        f.write(struct.pack('>HHHHH', len(chunks), cells[0], cells[1], cells[2], len(rows)))
+
+        # Write grid placement
+        f.write(struct.pack('>fff', *(value * base_scale for value in origin)))
+        f.write(struct.pack('>f', cell_size))
+
+        # Write chunks, the names match the objects in the gltf export
+        for name in names:
+            encoded = name.encode('utf-8')[:255]
+            f.write(struct.pack('>B', len(encoded)))
+            f.write(encoded)
+
+        # Write the row of every cell, then the rows with one bit per chunk
+        for row_index in cell_rows:
+            f.write(struct.pack('>H', row_index))
+
+        for row in rows:
+            f.write(row)
+
+    print(f"PVS successfully written to {output_path}")
+
+# Entry point for the script
+if __name__ == "__main__":
+    # Retrieve arguments
+    argv = sys.argv
+    if "--" in argv:
+        argv = argv[argv.index("--") + 1:]  # Get all arguments after "--"
+    else:
+        argv = []  # No arguments provided
+
+    if len(argv) < 1:
+        print("Usage: blender -b <source_file> --python <script.py> -- <output_path> [base_scale] [cell_size]")
+        sys.exit(1)
+
+    output_path = argv[0]
+    base_scale = int(argv[1]) if len(argv) > 1 else 1  # Default base_scale to 1 if not provided
+    cell_size = float(argv[2]) if len(argv) > 2 else DEFAULT_CELL_SIZE
+
+    print(f"Source file: {bpy.data.filepath}")
+    print(f"Output path: {output_path}")
+    print(f"Base scale: {base_scale}")
+    print(f"Cell size: {cell_size}")
+
+    write_pvs(output_path, base_scale, cell_size)
@@ -0,0 +1,134 @@
+import bpy
+import math
+import os
+import sys
+import tempfile
+from mathutils import Vector
+
+# The runtime picks the frame from the angle around the up axis and uploads one frame at a time into tmem
+DEFAULT_FRAME_COUNT = 8
+DEFAULT_FRAME_SIZE = 32 # in pixels, a 32x32 RGBA16 frame fills half of tmem
+RENDER_SAMPLES = 16
+
+
+def model_radius():
+    """Radius around the origin containing the bounding box of every mesh, the same radius model_bounding_radius uses"""
+    corner = [0.0, 0.0, 0.0]
+
+    for obj in bpy.data.objects:
+        if obj.type != 'MESH':
+            continue
+
+        for vert in obj.bound_box:
+            world = obj.matrix_world @ Vector(vert)
+            for axis in range(3):
+                corner[axis] = max(corner[axis], abs(world[axis]))
+
+    return Vector(corner).length
+
+
+def setup_scene(frame_size, radius):
+    scene = bpy.context.scene
+
+    scene.render.engine = 'CYCLES'
+    scene.cycles.samples = RENDER_SAMPLES
+    scene.render.film_transparent = True
+    scene.render.resolution_x = frame_size
+    scene.render.resolution_y = frame_size
+    scene.render.resolution_percentage = 100
+    scene.render.image_settings.file_format = 'PNG'
+    scene.render.image_settings.color_mode = 'RGBA'
+    scene.view_settings.view_transform = 'Standard'
+
+    # the sprite stands in for the model at a distance, a light from above is close enough to the game lighting
+    if not any(obj.type == 'LIGHT' for obj in scene.objects):
+        light_data = bpy.data.lights.new(name="impostor_light", type='SUN')
+        light = bpy.data.objects.new(name="impostor_light", object_data=light_data)
+        light.rotation_euler = (math.radians(30.0), 0.0, math.radians(30.0))
+        scene.collection.objects.link(light)
+
+    camera_data = bpy.data.cameras.new(name="impostor_camera")
+    camera_data.type = 'ORTHO'
+    # the bounding radius fills the frame, the runtime draws the billboard with the same radius
+    camera_data.ortho_scale = radius * 2.0
+    camera_data.clip_start = radius * 0.01
+    camera_data.clip_end = radius * 4.0
+
+    camera = bpy.data.objects.new(name="impostor_camera", object_data=camera_data)
+    scene.collection.objects.link(camera)
+    scene.camera = camera
+
+    return camera
+
+
+def render_frame(camera, angle, radius, filepath):
+    # frame 0 looks at the model from game +z, the angle turns towards game +x
+    # blender z up is game y up, game +z is blender -y
+    direction = Vector((math.sin(angle), -math.cos(angle), 0.0))
+
+    camera.location = direction * (radius * 2.0)
+    camera.rotation_euler = direction.to_track_quat('Z', 'Y').to_euler()
+
+    bpy.context.scene.render.filepath = filepath
+    bpy.ops.render.render(write_still=True)
+
+    image = bpy.data.images.load(filepath)
+    pixels = list(image.pixels)
+    bpy.data.images.remove(image)
+    return pixels
+
+
+def write_impostor(output_path, frame_count, frame_size):
+    radius = model_radius()
+
+    if radius <= 0.0:
+        raise Exception("No meshes to bake an impostor from")
+
+    camera = setup_scene(frame_size, radius)
+
+    atlas_width = frame_count * frame_size
+    atlas_pixels = [0.0] * (atlas_width * frame_size * 4)
+
+    with tempfile.TemporaryDirectory() as temp_dir:
+        for frame in range(frame_count):
+            angle = frame * 2.0 * math.pi / frame_count
+            pixels = render_frame(camera, angle, radius, os.path.join(temp_dir, f"frame{frame}.png"))
+
+            # the frames are laid out in a single row
+            for y in range(frame_size):
+                source = y * frame_size * 4
+                target = (y * atlas_width + frame * frame_size) * 4
+                atlas_pixels[target:target + frame_size * 4] = pixels[source:source + frame_size * 4]
+
+            print(f"Impostor: baked frame {frame + 1} of {frame_count}")
+
+    atlas = bpy.data.images.new("impostor_atlas", width=atlas_width, height=frame_size, alpha=True)
+    atlas.pixels = atlas_pixels
+    atlas.filepath_raw = output_path
+    atlas.file_format = 'PNG'
+    atlas.save()
+
+    print(f"Impostor successfully written to {output_path}")
+
+# Entry point for the script
+if __name__ == "__main__":
+    # Retrieve arguments
+    argv = sys.argv
+    if "--" in argv:
+        argv = argv[argv.index("--") + 1:]  # Get all arguments after "--"
+    else:
+        argv = []  # No arguments provided
+
+    if len(argv) < 1:
+        print("Usage: blender -b <source_file> --python <script.py> -- <output_path> [frame_count] [frame_size]")
+        sys.exit(1)
+
+    output_path = os.path.abspath(argv[0])
+    frame_count = int(argv[1]) if len(argv) > 1 else DEFAULT_FRAME_COUNT
+    frame_size = int(argv[2]) if len(argv) > 2 else DEFAULT_FRAME_SIZE
+
+    print(f"Source file: {bpy.data.filepath}")
+    print(f"Output path: {output_path}")
+    print(f"Frames: {frame_count} of {frame_size}x{frame_size}")
+
+    write_impostor(output_path, frame_count, frame_size)
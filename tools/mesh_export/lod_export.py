@@ -0,0 +1,55 @@
+import bpy
+import sys
+
+# Decimation keeps the uv seams and material borders, so the textures and materials match the full detail model
+MIN_TRIANGLES = 4 # meshes with fewer triangles are exported unchanged
+
+
+def decimate_meshes(ratio):
+    """Adds a collapse decimation to every mesh, applied by the export"""
+    for obj in bpy.data.objects:
+        if obj.type != 'MESH':
+            continue
+
+        if sum(len(polygon.vertices) - 2 for polygon in obj.data.polygons) < MIN_TRIANGLES:
+            continue
+
+        modifier = obj.modifiers.new(name="lod_decimate", type='DECIMATE')
+        modifier.decimate_type = 'COLLAPSE'
+        modifier.ratio = ratio
+        modifier.use_collapse_triangulate = True
+
+
+def write_lod(output_path, ratio):
+    decimate_meshes(ratio)
+
+    # the same layout as the glb next to the source file, with the modifiers applied
+    bpy.ops.export_scene.gltf(
+        filepath=output_path,
+        export_format='GLB',
+        export_apply=True,
+    )
+
+    print(f"LOD successfully written to {output_path}")
+
+# Entry point for the script
+if __name__ == "__main__":
+    # Retrieve arguments
+    argv = sys.argv
+    if "--" in argv:
+        argv = argv[argv.index("--") + 1:]  # Get all arguments after "--"
+    else:
+        argv = []  # No arguments provided
+
+    if len(argv) < 2:
+        print("Usage: blender -b <source_file> --python <script.py> -- <output_path> <ratio>")
+        sys.exit(1)
+
+    output_path = argv[0]
+    ratio = float(argv[1])
+
+    print(f"Source file: {bpy.data.filepath}")
+    print(f"Output path: {output_path}")
+    print(f"Ratio: {ratio}")
+
+    write_lod(output_path, ratio)